@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+#include "DSVReader.h"
+#include "DSVWriter.h"
+#include "ParallelDSVReader.h"
+#include "StringDataSource.h"
+#include "CharacterScan.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// stops.csv shaped input, about 20 MB
+static const std::string &StopsCSV(){
+    static std::string Contents = [](){
+        std::string CSV = "stop_id,node_id\n";
+        for(std::size_t Index = 0; Index < 1000000; Index++){
+            CSV += std::to_string(22000 + Index) + "," + std::to_string(2849810514ULL + Index * 7919) + "\n";
+        }
+        return CSV;
+    }();
+    return Contents;
+}
+
+// routes.csv shaped input with quoted route names
+static const std::string &RoutesCSV(){
+    static std::string Contents = [](){
+        std::string CSV = "route,stop_id\n";
+        for(std::size_t Index = 0; Index < 1000000; Index++){
+            CSV += "\"Route " + std::to_string(Index % 40) + ", \"\"Express\"\"\"," + std::to_string(22000 + Index) + "\n";
+        }
+        return CSV;
+    }();
+    return Contents;
+}
+
+static void ReadRows(benchmark::State &state, const std::string &csv){
+    for(auto _ : state){
+        CDSVReader Reader(std::make_shared<CStringDataSource>(csv), ',');
+        std::vector<std::string> Row;
+        while(Reader.ReadRow(Row)){
+            benchmark::DoNotOptimize(Row);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * csv.size());
+}
+
+static void BM_ReadStops(benchmark::State &state){
+    ReadRows(state, StopsCSV());
+}
+BENCHMARK(BM_ReadStops);
+
+static void BM_ReadRoutes(benchmark::State &state){
+    ReadRows(state, RoutesCSV());
+}
+BENCHMARK(BM_ReadRoutes);
+
+static void ReadRowViews(benchmark::State &state, const std::string &csv){
+    for(auto _ : state){
+        CDSVReader Reader(std::make_shared<CStringDataSource>(csv), ',');
+        std::vector<std::string_view> Row;
+        while(Reader.ReadRowView(Row)){
+            benchmark::DoNotOptimize(Row);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * csv.size());
+}
+
+static void BM_ReadStopViews(benchmark::State &state){
+    ReadRowViews(state, StopsCSV());
+}
+BENCHMARK(BM_ReadStopViews);
+
+static void BM_ReadRouteViews(benchmark::State &state){
+    ReadRowViews(state, RoutesCSV());
+}
+BENCHMARK(BM_ReadRouteViews);
+
+// raw scanning speed of the tokenizer's special character search
+static void BM_FindSpecials(benchmark::State &state){
+    const auto &CSV = StopsCSV();
+    const char Specials[] = {'"', ',', '\n', '\r'};
+    for(auto _ : state){
+        const char *Current = CSV.data();
+        const char *End = CSV.data() + CSV.size();
+        while(Current < End){
+            Current = CharacterScan::FindAny(Current, End, Specials, 4) + 1;
+        }
+        benchmark::DoNotOptimize(Current);
+    }
+    state.SetBytesProcessed(state.iterations() * CSV.size());
+}
+BENCHMARK(BM_FindSpecials);
+
+// parallel parsing of a larger input, the argument is the thread count
+static void BM_ParallelReadStops(benchmark::State &state){
+    static std::string CSV = [](){
+        std::string Contents;
+        for(int Index = 0; Index < 4; Index++){
+            Contents += StopsCSV();
+        }
+        return Contents;
+    }();
+    for(auto _ : state){
+        CParallelDSVReader Reader(std::make_shared<CStringDataSource>(CSV), ',', state.range(0), 1 << 20);
+        std::vector<std::vector<std::string>> Rows;
+        Reader.ReadAll(Rows);
+        benchmark::DoNotOptimize(Rows);
+    }
+    state.SetBytesProcessed(state.iterations() * CSV.size());
+}
+BENCHMARK(BM_ParallelReadStops)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->UseRealTime();
+
+// Discards the output, so only the writer itself is measured
+class CNullDataSink : public CDataSink{
+    public:
+        std::size_t Bytes = 0;
+
+        bool Put(const char &ch) noexcept override{
+            Bytes++;
+            return true;
+        }
+
+        bool Write(const std::vector<char> &buf) noexcept override{
+            Bytes += buf.size();
+            return true;
+        }
+};
+
+// routes.csv shaped rows, half of them need quoting
+static const std::vector< std::vector<std::string> > &RouteRows(){
+    static std::vector< std::vector<std::string> > Rows = [](){
+        std::vector< std::vector<std::string> > Rows;
+        for(std::size_t Index = 0; Index < 1000000; Index++){
+            Rows.push_back({Index % 2 ? "Route " + std::to_string(Index % 40) + ", \"Express\"" : "A", std::to_string(22000 + Index)});
+        }
+        return Rows;
+    }();
+    return Rows;
+}
+
+static void BM_WriteRoutes(benchmark::State &state){
+    for(auto _ : state){
+        auto Sink = std::make_shared<CNullDataSink>();
+        CDSVWriter Writer(Sink, ',');
+        for(auto &Row : RouteRows()){
+            Writer.WriteRow(Row);
+        }
+        benchmark::DoNotOptimize(Sink->Bytes);
+    }
+    state.SetItemsProcessed(state.iterations() * RouteRows().size());
+}
+BENCHMARK(BM_WriteRoutes);
+
+static void BM_WriteRoutesBatch(benchmark::State &state){
+    for(auto _ : state){
+        auto Sink = std::make_shared<CNullDataSink>();
+        CDSVWriter Writer(Sink, ',');
+        Writer.WriteRows(RouteRows());
+        benchmark::DoNotOptimize(Sink->Bytes);
+    }
+    state.SetItemsProcessed(state.iterations() * RouteRows().size());
+}
+BENCHMARK(BM_WriteRoutesBatch);
+
+// stops.csv shaped rows from numbers, formatted by the writer
+static void BM_WriteStopFields(benchmark::State &state){
+    for(auto _ : state){
+        auto Sink = std::make_shared<CNullDataSink>();
+        CDSVWriter Writer(Sink, ',');
+        for(std::size_t Index = 0; Index < 1000000; Index++){
+            Writer.WriteField(22000 + Index);
+            Writer.WriteField(38.5 + Index * 1e-7);
+            Writer.EndRow();
+        }
+        benchmark::DoNotOptimize(Sink->Bytes);
+    }
+    state.SetItemsProcessed(state.iterations() * 1000000);
+}
+BENCHMARK(BM_WriteStopFields);
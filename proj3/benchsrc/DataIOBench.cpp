@@ -0,0 +1,254 @@
+#include <benchmark/benchmark.h>
+#include "FileDataSource.h"
+#include "FileDataSink.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include "PrefetchDataSource.h"
+#include "DecompressDataSource.h"
+#include "DSVReader.h"
+#include <cstdio>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+static const std::size_t FileSize = 64 << 20;
+
+// Scratch file in the working directory, written once and removed at exit
+static const std::string &InputFile(){
+    static std::string Filename = [](){
+        std::string Name = "dataiobench.tmp";
+        CFileDataSink Sink(Name);
+        for(std::size_t Index = 0; Index < FileSize; Index++){
+            Sink.Put(static_cast<char>('a' + Index % 26));
+        }
+        std::atexit([](){ std::remove("dataiobench.tmp"); });
+        return Name;
+    }();
+    return Filename;
+}
+
+static const std::string &InputString(){
+    static std::string Contents(FileSize, 'a');
+    return Contents;
+}
+
+// Byte at a time through the base class, the way the older readers consume input
+static void GetAll(benchmark::State &state, const std::function<std::unique_ptr<CDataSource>()> &open){
+    for(auto _ : state){
+        auto Source = open();
+        char Ch;
+        std::size_t Sum = 0;
+        while(Source->Get(Ch)){
+            Sum += Ch;
+        }
+        benchmark::DoNotOptimize(Sum);
+    }
+    state.SetBytesProcessed(state.iterations() * FileSize);
+}
+
+static void BM_StringSourceGet(benchmark::State &state){
+    GetAll(state, [](){ return std::make_unique<CStringDataSource>(InputString()); });
+}
+BENCHMARK(BM_StringSourceGet);
+
+static void BM_FileSourceGet(benchmark::State &state){
+    InputFile();
+    GetAll(state, [](){ return std::make_unique<CFileDataSource>(InputFile()); });
+}
+BENCHMARK(BM_FileSourceGet);
+
+// Calls on the concrete class inline the buffer fast path
+static void BM_FileSourceGetInline(benchmark::State &state){
+    InputFile();
+    for(auto _ : state){
+        CFileDataSource Source(InputFile());
+        char Ch;
+        std::size_t Sum = 0;
+        while(Source.Get(Ch)){
+            Sum += Ch;
+        }
+        benchmark::DoNotOptimize(Sum);
+    }
+    state.SetBytesProcessed(state.iterations() * FileSize);
+}
+BENCHMARK(BM_FileSourceGetInline);
+
+static void BM_FileSourceRead(benchmark::State &state){
+    InputFile();
+    for(auto _ : state){
+        CFileDataSource Source(InputFile(), state.range(0));
+        std::vector<char> Block;
+        std::size_t Total = 0;
+        while(Source.Read(Block, 1 << 16)){
+            Total += Block.size();
+        }
+        benchmark::DoNotOptimize(Total);
+    }
+    state.SetBytesProcessed(state.iterations() * FileSize);
+}
+BENCHMARK(BM_FileSourceRead)->Arg(64 << 10)->Arg(1 << 20)->Arg(8 << 20);
+
+static void BM_StringSinkPut(benchmark::State &state){
+    for(auto _ : state){
+        auto Sink = std::make_unique<CStringDataSink>();
+        CDataSink &Base = *Sink;
+        for(std::size_t Index = 0; Index < FileSize; Index++){
+            Base.Put('a');
+        }
+        benchmark::DoNotOptimize(Sink->Size());
+    }
+    state.SetBytesProcessed(state.iterations() * FileSize);
+}
+BENCHMARK(BM_StringSinkPut);
+
+static void BM_FileSinkPut(benchmark::State &state){
+    for(auto _ : state){
+        auto Sink = std::make_unique<CFileDataSink>("dataiobench.out");
+        CDataSink &Base = *Sink;
+        for(std::size_t Index = 0; Index < FileSize; Index++){
+            Base.Put('a');
+        }
+        Sink->Flush();
+    }
+    std::remove("dataiobench.out");
+    state.SetBytesProcessed(state.iterations() * FileSize);
+}
+BENCHMARK(BM_FileSinkPut);
+
+static void BM_FileSinkWrite(benchmark::State &state){
+    std::vector<char> Block(1 << 16, 'a');
+    for(auto _ : state){
+        CFileDataSink Sink("dataiobench.out", state.range(0));
+        for(std::size_t Index = 0; Index < FileSize; Index += Block.size()){
+            Sink.Write(Block);
+        }
+        Sink.Flush();
+    }
+    std::remove("dataiobench.out");
+    state.SetBytesProcessed(state.iterations() * FileSize);
+}
+BENCHMARK(BM_FileSinkWrite)->Arg(64 << 10)->Arg(1 << 20)->Arg(8 << 20);
+
+// Source with a fixed latency per read, standing in for a disk that delivers
+// about 250 MB/s in 1MB reads
+class CThrottledDataSource : public CDataSource{
+    private:
+        CStringDataSource DSource;
+    public:
+        CThrottledDataSource(const std::string &str) : DSource(str) {}
+
+        bool End() const noexcept override { return DSource.End(); }
+        bool Get(char &ch) noexcept override { return DSource.Get(ch); }
+        bool Peek(char &ch) noexcept override { return DSource.Peek(ch); }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override {
+            std::this_thread::sleep_for(std::chrono::microseconds(4 * ((count + 1023) / 1024)));
+            return DSource.Read(buf, count);
+        }
+};
+
+static const std::string &StopsCSV(){
+    static std::string Contents = [](){
+        std::string CSV = "stop_id,node_id\n";
+        while(CSV.size() < (32 << 20)){
+            CSV += std::to_string(22000 + CSV.size()) + "," + std::to_string(2849810514ULL + CSV.size() * 7919) + "\n";
+        }
+        return CSV;
+    }();
+    return Contents;
+}
+
+static void ParseThrottled(benchmark::State &state, bool prefetch){
+    const auto &CSV = StopsCSV();
+    for(auto _ : state){
+        std::shared_ptr<CDataSource> Source = std::make_shared<CThrottledDataSource>(CSV);
+        if(prefetch){
+            Source = std::make_shared<CPrefetchDataSource>(Source);
+        }
+        CDSVReader Reader(Source, ',', 1 << 20);
+        std::vector<std::string_view> Row;
+        std::size_t Rows = 0;
+        while(Reader.ReadRowView(Row)){
+            Rows++;
+        }
+        benchmark::DoNotOptimize(Rows);
+    }
+    state.SetBytesProcessed(state.iterations() * CSV.size());
+}
+
+static void BM_ParseThrottled(benchmark::State &state){
+    ParseThrottled(state, false);
+}
+BENCHMARK(BM_ParseThrottled)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_ParseThrottledPrefetch(benchmark::State &state){
+    ParseThrottled(state, true);
+}
+BENCHMARK(BM_ParseThrottledPrefetch)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Parsing alone for reference, the prefetched run should approach the slower of the two
+static void BM_ParseResident(benchmark::State &state){
+    const auto &CSV = StopsCSV();
+    for(auto _ : state){
+        CDSVReader Reader(std::make_shared<CStringDataSource>(CSV), ',', 1 << 20);
+        std::vector<std::string_view> Row;
+        std::size_t Rows = 0;
+        while(Reader.ReadRowView(Row)){
+            Rows++;
+        }
+        benchmark::DoNotOptimize(Rows);
+    }
+    state.SetBytesProcessed(state.iterations() * CSV.size());
+}
+BENCHMARK(BM_ParseResident)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static const std::string &StopsCSVGzip(){
+    static std::string Contents = [](){
+        const auto &CSV = StopsCSV();
+        z_stream Stream = z_stream();
+        deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        std::string Compressed(deflateBound(&Stream, CSV.size()), '\0');
+        Stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(CSV.data()));
+        Stream.avail_in = CSV.size();
+        Stream.next_out = reinterpret_cast<Bytef *>(&Compressed[0]);
+        Stream.avail_out = Compressed.size();
+        deflate(&Stream, Z_FINISH);
+        Compressed.resize(Stream.total_out);
+        deflateEnd(&Stream);
+        return Compressed;
+    }();
+    return Contents;
+}
+
+// Inflating and parsing on one thread, and with inflation moved to the prefetch thread
+static void ParseGzip(benchmark::State &state, bool prefetch){
+    const auto &Compressed = StopsCSVGzip();
+    for(auto _ : state){
+        std::shared_ptr<CDataSource> Source = std::make_shared<CDecompressDataSource>(std::make_shared<CStringDataSource>(Compressed));
+        if(prefetch){
+            Source = std::make_shared<CPrefetchDataSource>(Source);
+        }
+        CDSVReader Reader(Source, ',', 1 << 20);
+        std::vector<std::string_view> Row;
+        std::size_t Rows = 0;
+        while(Reader.ReadRowView(Row)){
+            Rows++;
+        }
+        benchmark::DoNotOptimize(Rows);
+    }
+    state.SetBytesProcessed(state.iterations() * StopsCSV().size());
+}
+
+static void BM_ParseGzip(benchmark::State &state){
+    ParseGzip(state, false);
+}
+BENCHMARK(BM_ParseGzip)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_ParseGzipPrefetch(benchmark::State &state){
+    ParseGzip(state, true);
+}
+BENCHMARK(BM_ParseGzipPrefetch)->UseRealTime()->Unit(benchmark::kMillisecond);
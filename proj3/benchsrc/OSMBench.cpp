@@ -0,0 +1,206 @@
+#include <benchmark/benchmark.h>
+#include "OpenStreetMap.h"
+#include "OSMStream.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include "StreetMapIndex.h"
+#include <memory>
+#include <random>
+#include <string>
+
+// Builds the XML for a synthetic map with nodecount nodes and one way per 16 nodes, IDs
+// are spread out so that they do not match the indices
+static std::string BuildOSM(std::size_t nodecount){
+    std::string OSM = "<osm>";
+    for(std::size_t Index = 0; Index < nodecount; Index++){
+        OSM += "<node id=\"" + std::to_string(Index * 7 + 1000) + "\" lat=\"" + std::to_string(38.5 + (Index % 1024) * 1e-4)
+            + "\" lon=\"" + std::to_string(-121.7 + (Index / 1024) * 1e-4) + "\"/>";
+    }
+    for(std::size_t Index = 0; Index + 16 <= nodecount; Index += 16){
+        OSM += "<way id=\"" + std::to_string(Index * 3 + 5) + "\">";
+        for(std::size_t NodeIndex = Index; NodeIndex < Index + 16; NodeIndex++){
+            OSM += "<nd ref=\"" + std::to_string(NodeIndex * 7 + 1000) + "\"/>";
+        }
+        OSM += "</way>";
+    }
+    OSM += "</osm>";
+    return OSM;
+}
+
+static std::shared_ptr<COpenStreetMap> BuildMap(std::size_t nodecount){
+    return std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(BuildOSM(nodecount))));
+}
+
+static void BM_NodeByID(benchmark::State &state){
+    auto Map = BuildMap(state.range(0));
+    std::mt19937_64 Generator(17);
+    std::uniform_int_distribution<std::size_t> Distribution(0, Map->NodeCount() - 1);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(Map->NodeByID(Distribution(Generator) * 7 + 1000));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_NodeByID)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+static void BM_WayByID(benchmark::State &state){
+    auto Map = BuildMap(state.range(0));
+    std::mt19937_64 Generator(17);
+    std::uniform_int_distribution<std::size_t> Distribution(0, Map->WayCount() - 1);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(Map->WayByID(Distribution(Generator) * 48 + 5));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WayByID)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+// Resolves every node reference of every way, quadratic with a linear lookup
+static void BM_ResolveWayNodes(benchmark::State &state){
+    auto Map = BuildMap(state.range(0));
+    for(auto _ : state){
+        for(std::size_t Index = 0; Index < Map->WayCount(); Index++){
+            auto Way = Map->WayByIndex(Index);
+            for(std::size_t NodeIndex = 0; NodeIndex < Way->NodeCount(); NodeIndex++){
+                benchmark::DoNotOptimize(Map->NodeByID(Way->GetNodeID(NodeIndex)));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (Map->WayCount() * 16));
+}
+BENCHMARK(BM_ResolveWayNodes)->RangeMultiplier(8)->Range(1<<10, 1<<17);
+
+// Same walk through the non-owning handles, no proxy allocation or reference counting
+static void BM_ResolveWayNodesHandles(benchmark::State &state){
+    auto Map = BuildMap(state.range(0));
+    for(auto _ : state){
+        for(auto Way : Map->Ways()){
+            for(std::size_t NodeIndex = 0; NodeIndex < Way.NodeCount(); NodeIndex++){
+                benchmark::DoNotOptimize(Map->NodeHandleByID(Way.GetNodeID(NodeIndex)).Location());
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * (Map->WayCount() * 16));
+}
+BENCHMARK(BM_ResolveWayNodesHandles)->RangeMultiplier(8)->Range(1<<10, 1<<17);
+
+static void BM_SumLocations(benchmark::State &state){
+    auto Map = BuildMap(state.range(0));
+    for(auto _ : state){
+        double Sum = 0.0;
+        for(std::size_t Index = 0; Index < Map->NodeCount(); Index++){
+            Sum += Map->NodeByIndex(Index)->Location().first;
+        }
+        benchmark::DoNotOptimize(Sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SumLocations)->Arg(1<<17);
+
+static void BM_SumLocationsHandles(benchmark::State &state){
+    auto Map = BuildMap(state.range(0));
+    for(auto _ : state){
+        double Sum = 0.0;
+        for(auto Node : Map->Nodes()){
+            Sum += Node.Location().first;
+        }
+        benchmark::DoNotOptimize(Sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SumLocationsHandles)->Arg(1<<17);
+
+static void BM_LoadXML(benchmark::State &state){
+    auto OSM = BuildOSM(state.range(0));
+    for(auto _ : state){
+        benchmark::DoNotOptimize(std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(OSM))));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadXML)->RangeMultiplier(8)->Range(1<<10, 1<<17);
+
+// Loads a window of about a tenth of the nodes and only the ways that reach into it
+static void BM_LoadXMLBounds(benchmark::State &state){
+    auto OSM = BuildOSM(state.range(0));
+    COpenStreetMap::SLoadOptions Options;
+    Options.DUseBounds = true;
+    Options.DMinimum = CStreetMap::TLocation(38.5, -121.7);
+    Options.DMaximum = CStreetMap::TLocation(38.6, -121.7 + (state.range(0) / 1024) * 1e-5);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(OSM)), Options));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadXMLBounds)->RangeMultiplier(8)->Range(1<<10, 1<<17);
+
+// Sums the nodes of every way without keeping any element, memory stays constant
+struct SWayLengthVisitor : public COSMStream::SVisitor {
+    std::size_t WayNodes = 0;
+
+    void Way(const COSMStream::SWay &way) override {
+        WayNodes += way.NodeCount();
+    }
+};
+
+static void BM_StreamXML(benchmark::State &state){
+    auto OSM = BuildOSM(state.range(0));
+    for(auto _ : state){
+        COSMStream Stream(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(OSM)));
+        SWayLengthVisitor Visitor;
+        Stream.Visit(Visitor);
+        benchmark::DoNotOptimize(Visitor.WayNodes);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StreamXML)->RangeMultiplier(8)->Range(1<<10, 1<<17);
+
+static void BM_StreamXMLNext(benchmark::State &state){
+    auto OSM = BuildOSM(state.range(0));
+    for(auto _ : state){
+        COSMStream Stream(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(OSM)));
+        std::size_t WayNodes = 0;
+        while(Stream.NextWay()){
+            WayNodes += Stream.Way().NodeCount();
+        }
+        benchmark::DoNotOptimize(WayNodes);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StreamXMLNext)->RangeMultiplier(8)->Range(1<<10, 1<<17);
+
+static void BM_LoadSnapshot(benchmark::State &state){
+    auto Sink = std::make_shared<CStringDataSink>();
+    BuildMap(state.range(0))->WriteSnapshot(Sink);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(Sink->String())));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadSnapshot)->RangeMultiplier(8)->Range(1<<10, 1<<17);
+
+static void BM_Nearest(benchmark::State &state){
+    auto Map = BuildMap(state.range(0));
+    CStreetMapIndex Index(Map);
+    std::mt19937_64 Generator(17);
+    std::uniform_real_distribution<double> Latitude(38.5, 38.6), Longitude(-121.7, -121.6);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(Index.Nearest({Latitude(Generator), Longitude(Generator)}, 4));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Nearest)->RangeMultiplier(8)->Range(1<<10, 1<<20);
+
+static void BM_NearestBatch(benchmark::State &state){
+    auto Map = BuildMap(1<<17);
+    CStreetMapIndex Index(Map);
+    std::mt19937_64 Generator(17);
+    std::uniform_real_distribution<double> Latitude(38.5, 38.6), Longitude(-121.7, -121.6);
+    std::vector<CStreetMap::TLocation> Locations;
+    for(std::size_t QueryIndex = 0; QueryIndex < 4096; QueryIndex++){
+        Locations.emplace_back(Latitude(Generator), Longitude(Generator));
+    }
+    for(auto _ : state){
+        benchmark::DoNotOptimize(Index.NearestBatch(Locations, 4, state.range(0)));
+    }
+    state.SetItemsProcessed(state.iterations() * Locations.size());
+}
+BENCHMARK(BM_NearestBatch)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include "RoutingGraph.h"
+#include "ContractionHierarchy.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+
+static std::shared_ptr<COpenStreetMap> LoadDavis(){
+    std::ifstream Input("data/davis.osm");
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    return std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(Buffer.str())));
+}
+
+// Random source and destination pairs, the same for every benchmark
+static std::vector<std::pair<CStreetMap::TNodeID, CStreetMap::TNodeID>> Queries(const CRoutingGraph &graph){
+    std::mt19937 Generator(17);
+    std::uniform_int_distribution<CRoutingGraph::TVertex> Distribution(0, graph.VertexCount() - 1);
+    std::vector<std::pair<CStreetMap::TNodeID, CStreetMap::TNodeID>> Result;
+    for(int Index = 0; Index < 1024; Index++){
+        Result.emplace_back(graph.NodeIDByVertex(Distribution(Generator)), graph.NodeIDByVertex(Distribution(Generator)));
+    }
+    return Result;
+}
+
+static void BM_BuildGraph(benchmark::State &state){
+    auto Map = LoadDavis();
+    for(auto _ : state){
+        CRoutingGraph Graph(Map);
+        benchmark::DoNotOptimize(Graph.EdgeCount());
+    }
+}
+BENCHMARK(BM_BuildGraph)->Unit(benchmark::kMillisecond);
+
+// items per second is queries per second
+static void BM_Dijkstra(benchmark::State &state){
+    CRoutingGraph Graph(LoadDavis());
+    CRoutingGraph::CWorkspace Workspace;
+    std::vector<CStreetMap::TNodeID> Path;
+    auto Pairs = Queries(Graph);
+    std::size_t Index = 0;
+    for(auto _ : state){
+        auto &Query = Pairs[Index++ % Pairs.size()];
+        benchmark::DoNotOptimize(Graph.FindShortestPath(Query.first, Query.second, Path, Workspace));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Dijkstra);
+
+static void BM_AStar(benchmark::State &state){
+    CRoutingGraph Graph(LoadDavis());
+    CRoutingGraph::CWorkspace Workspace;
+    std::vector<CStreetMap::TNodeID> Path;
+    auto Pairs = Queries(Graph);
+    std::size_t Index = 0;
+    for(auto _ : state){
+        auto &Query = Pairs[Index++ % Pairs.size()];
+        benchmark::DoNotOptimize(Graph.FindShortestPathAStar(Query.first, Query.second, Path, Workspace));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AStar);
+
+static void BM_BuildContractionHierarchy(benchmark::State &state){
+    CRoutingGraph Graph(LoadDavis());
+    for(auto _ : state){
+        CContractionHierarchy Hierarchy(Graph, state.range(0));
+        benchmark::DoNotOptimize(Hierarchy.EdgeCount());
+    }
+}
+BENCHMARK(BM_BuildContractionHierarchy)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_ContractionHierarchy(benchmark::State &state){
+    CRoutingGraph Graph(LoadDavis());
+    CContractionHierarchy Hierarchy(Graph);
+    CContractionHierarchy::CWorkspace Workspace;
+    std::vector<CStreetMap::TNodeID> Path;
+    auto Pairs = Queries(Graph);
+    std::size_t Index = 0;
+    for(auto _ : state){
+        auto &Query = Pairs[Index++ % Pairs.size()];
+        benchmark::DoNotOptimize(Hierarchy.FindShortestPath(Query.first, Query.second, Path, Workspace));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ContractionHierarchy);
+
+static void BM_ContractionHierarchyDistance(benchmark::State &state){
+    CRoutingGraph Graph(LoadDavis());
+    CContractionHierarchy Hierarchy(Graph);
+    CContractionHierarchy::CWorkspace Workspace;
+    auto Pairs = Queries(Graph);
+    std::size_t Index = 0;
+    for(auto _ : state){
+        auto &Query = Pairs[Index++ % Pairs.size()];
+        benchmark::DoNotOptimize(Hierarchy.FindShortestDistance(Query.first, Query.second, Workspace));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ContractionHierarchyDistance);
@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+#include "XMLReader.h"
+#include "XMLAtomTable.h"
+#include "XMLWriter.h"
+#include "StringDataSource.h"
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static const std::string &DavisOSM(){
+    static std::string Contents = [](){
+        std::ifstream Input("data/davis.osm");
+        std::stringstream Buffer;
+        Buffer << Input.rdbuf();
+        return Buffer.str();
+    }();
+    return Contents;
+}
+
+static void BM_ReadDavisEntities(benchmark::State &state){
+    const auto &OSM = DavisOSM();
+    for(auto _ : state){
+        CXMLReader Reader(std::make_shared<CStringDataSource>(OSM), state.range(0));
+        SXMLEntity Entity;
+        while(Reader.ReadEntity(Entity, true)){
+            benchmark::DoNotOptimize(Entity);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * OSM.size());
+}
+BENCHMARK(BM_ReadDavisEntities)->Arg(4096)->Arg(CXMLReader::DefaultChunkSize);
+
+// Same read with names interned, counting nodes by atom instead of by name
+static void BM_ReadDavisAtoms(benchmark::State &state){
+    const auto &OSM = DavisOSM();
+    auto Atoms = std::make_shared<CXMLAtomTable>();
+    auto Node = Atoms->Intern("node");
+    for(auto _ : state){
+        CXMLReader Reader(std::make_shared<CStringDataSource>(OSM), state.range(0));
+        SXMLEntity Entity;
+        std::size_t Nodes = 0;
+        Reader.SetAtomTable(Atoms);
+        while(Reader.ReadEntity(Entity, true)){
+            Nodes += (Entity.DNameAtom == Node) && (Entity.DType == SXMLEntity::EType::StartElement);
+        }
+        benchmark::DoNotOptimize(Nodes);
+    }
+    state.SetBytesProcessed(state.iterations() * OSM.size());
+}
+BENCHMARK(BM_ReadDavisAtoms)->Arg(4096)->Arg(CXMLReader::DefaultChunkSize);
+
+// Node only scan, ways and relations are skipped inside the parser callbacks
+static void BM_ReadDavisNodes(benchmark::State &state){
+    const auto &OSM = DavisOSM();
+    for(auto _ : state){
+        CXMLReader Reader(std::make_shared<CStringDataSource>(OSM), state.range(0));
+        SXMLEntity Entity;
+        Reader.SetElementFilter({"node", "tag"});
+        while(Reader.ReadEntity(Entity, true)){
+            benchmark::DoNotOptimize(Entity);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * OSM.size());
+}
+BENCHMARK(BM_ReadDavisNodes)->Arg(4096)->Arg(CXMLReader::DefaultChunkSize);
+
+// Counts elements so the handler does some work per event
+struct SCountingHandler : public CXMLReader::SHandler{
+    std::size_t Elements = 0;
+
+    void StartElement(const char *name, const char **attributes) override{
+        Elements++;
+    }
+};
+
+static void BM_ParseDavisHandler(benchmark::State &state){
+    const auto &OSM = DavisOSM();
+    for(auto _ : state){
+        CXMLReader Reader(std::make_shared<CStringDataSource>(OSM), state.range(0));
+        SCountingHandler Handler;
+        Reader.Parse(Handler);
+        benchmark::DoNotOptimize(Handler.Elements);
+    }
+    state.SetBytesProcessed(state.iterations() * OSM.size());
+}
+BENCHMARK(BM_ParseDavisHandler)->Arg(4096)->Arg(CXMLReader::DefaultChunkSize);
+
+// Discards the output, so only the writer itself is measured
+class CNullDataSink : public CDataSink{
+    public:
+        std::size_t Bytes = 0;
+
+        bool Put(const char &ch) noexcept override{
+            Bytes++;
+            return true;
+        }
+
+        bool Write(const std::vector<char> &buf) noexcept override{
+            Bytes += buf.size();
+            return true;
+        }
+};
+
+static void BM_WriteDavis(benchmark::State &state){
+    const auto &OSM = DavisOSM();
+    std::vector<SXMLEntity> Entities;
+    CXMLReader Reader(std::make_shared<CStringDataSource>(OSM));
+    SXMLEntity Entity;
+    while(Reader.ReadEntity(Entity)){
+        Entities.push_back(Entity);
+    }
+    for(auto _ : state){
+        auto Sink = std::make_shared<CNullDataSink>();
+        CXMLWriter Writer(Sink);
+        for(auto &Entity : Entities){
+            Writer.WriteEntity(Entity);
+        }
+        Writer.Flush();
+        benchmark::DoNotOptimize(Sink->Bytes);
+    }
+    state.SetBytesProcessed(state.iterations() * OSM.size());
+}
+BENCHMARK(BM_WriteDavis);
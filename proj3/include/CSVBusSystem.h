@@ -10,11 +10,91 @@
 
 class CCSVBusSystem : public CBusSystem{
     private:
-        class SStop; 
-        class SRoute; 
+        // Stored stop and route types, defined here so the ranges can step through the arrays
+        class SStop final : public CBusSystem::SStop{
+            public:
+                TStopID DStopID;
+                CStreetMap::TNodeID NodeIDVal;
+
+                TStopID ID() const noexcept override{
+                    return DStopID;
+                };
+
+                CStreetMap::TNodeID NodeID() const noexcept override{
+                    return NodeIDVal;
+                };
+        };
+
+        class SRoute final : public CBusSystem::SRoute{
+            public:
+                std::string DName;
+                std::vector<TStopID> DStopIDs;
+
+                std::string Name() const noexcept override{
+                    return DName;
+                };
+
+                std::size_t StopCount() const noexcept override{
+                    return DStopIDs.size();
+                };
+
+                TStopID GetStopID(std::size_t index) const noexcept override{
+                    return index < DStopIDs.size() ? DStopIDs[index] : CBusSystem::InvalidStopID;
+                };
+        };
+
         struct SImplementation; 
         std::unique_ptr< SImplementation > DImplementation;
     public:
+        // Iterates stored stops or routes as references to the interface type. The
+        // elements sit in one contiguous array, so no shared_ptr is copied.
+        template <typename TInterface, typename TElement>
+        class CRange{
+            private:
+                const TElement *DBegin;
+                const TElement *DEnd;
+
+            public:
+                class CIterator{
+                    private:
+                        const TElement *DElement;
+
+                    public:
+                        CIterator(const TElement *element) noexcept : DElement(element){};
+
+                        const TInterface &operator*() const noexcept{
+                            return *DElement;
+                        };
+
+                        CIterator &operator++() noexcept{
+                            DElement++;
+                            return *this;
+                        };
+
+                        bool operator==(const CIterator &other) const noexcept{
+                            return DElement == other.DElement;
+                        };
+
+                        bool operator!=(const CIterator &other) const noexcept{
+                            return DElement != other.DElement;
+                        };
+                };
+
+                CRange(const TElement *begin, const TElement *end) noexcept : DBegin(begin), DEnd(end){};
+
+                CIterator begin() const noexcept{
+                    return CIterator(DBegin);
+                };
+
+                CIterator end() const noexcept{
+                    return CIterator(DEnd);
+                };
+
+                std::size_t size() const noexcept{
+                    return DEnd - DBegin;
+                };
+        };
+
         CCSVBusSystem(std::shared_ptr< CDSVReader > stopsrc, std::shared_ptr< CDSVReader > routesrc);
         ~CCSVBusSystem();
 
@@ -24,6 +104,15 @@ class CCSVBusSystem : public CBusSystem{
         std::shared_ptr<CBusSystem::SStop> StopByID(TStopID id) const noexcept override;
         std::shared_ptr<CBusSystem::SRoute> RouteByIndex(std::size_t index) const noexcept override;
         std::shared_ptr<CBusSystem::SRoute> RouteByName(const std::string &name) const noexcept override;
+
+        // Non-owning lookups, the stops and routes live as long as the bus system.
+        // nullptr where the shared_ptr lookups return nullptr.
+        const CBusSystem::SStop *StopHandleByIndex(std::size_t index) const noexcept;
+        const CBusSystem::SStop *StopHandleByID(TStopID id) const noexcept;
+        const CBusSystem::SRoute *RouteHandleByIndex(std::size_t index) const noexcept;
+        const CBusSystem::SRoute *RouteHandleByName(const std::string &name) const noexcept;
+        CRange<CBusSystem::SStop, SStop> Stops() const noexcept;
+        CRange<CBusSystem::SRoute, SRoute> Routes() const noexcept;
 };
 
 std::ostream& operator<<(std::ostream& os, const CCSVBusSystem& busSystem); 
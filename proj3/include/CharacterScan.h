@@ -0,0 +1,26 @@
+#ifndef CHARACTERSCAN_H
+#define CHARACTERSCAN_H
+
+#include <cstddef>
+
+// Vectorized search for the first of a small set of special characters,
+// the readers and writers use it to skip over runs of plain data in bulk
+namespace CharacterScan{
+
+static const std::size_t MaxSetSize = 8;
+
+// Returns a pointer to the first byte in [begin, end) that matches any of
+// the setsize characters in set, or end if there is no match. FindAny
+// dispatches to the widest implementation the CPU supports.
+const char *FindAny(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept;
+
+const char *FindAnyScalar(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept;
+const char *FindAnySSE2(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept;
+const char *FindAnyAVX2(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept;
+
+bool HasSSE2() noexcept;
+bool HasAVX2() noexcept;
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include "RoutingGraph.h"
+#include "DataSink.h"
+#include "DataSource.h"
+#include <memory>
+#include <vector>
+
+// Contraction hierarchy over a routing graph. Preprocessing removes the vertices
+// one at a time, least important first, and adds shortcut edges that keep the
+// shortest distances between the remaining ones. A query then only has to search
+// upwards from both ends, which visits a few hundred vertices instead of the
+// whole graph. The hierarchy does not refer back to the graph once built.
+class CContractionHierarchy{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+        CContractionHierarchy();
+
+    public:
+        using TNodeID = CRoutingGraph::TNodeID;
+        using TVertex = CRoutingGraph::TVertex;
+
+        static constexpr double NoPathExists = CRoutingGraph::NoPathExists;
+
+        // Query state that can be reused between queries so they do not allocate.
+        // Each thread needs its own, it can be shared between hierarchies.
+        class CWorkspace{
+            private:
+                struct SImplementation;
+                std::unique_ptr<SImplementation> DImplementation;
+                friend class CContractionHierarchy;
+
+            public:
+                CWorkspace();
+                ~CWorkspace();
+        };
+
+        // A threadcount of zero uses one thread per core
+        CContractionHierarchy(const CRoutingGraph &graph, std::size_t threadcount = 0);
+        ~CContractionHierarchy();
+
+        std::size_t VertexCount() const noexcept;
+        // Original edges plus shortcuts
+        std::size_t EdgeCount() const noexcept;
+
+        // Same results as CRoutingGraph::FindShortestPath, the overload without a
+        // workspace uses one kept per thread
+        double FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path, CWorkspace &workspace) const;
+        double FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path) const;
+        // Length only, skips unpacking the shortcuts of the path
+        double FindShortestDistance(TNodeID src, TNodeID dest, CWorkspace &workspace) const;
+        double FindShortestDistance(TNodeID src, TNodeID dest) const;
+
+        bool Write(std::shared_ptr<CDataSink> sink) const;
+        // Returns nullptr if the source does not hold a valid hierarchy
+        static std::shared_ptr<CContractionHierarchy> Load(std::shared_ptr<CDataSource> src);
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 #include "DataSource.h"
 
 class CDSVReader{
@@ -11,11 +13,16 @@ class CDSVReader{
         std::unique_ptr<SImplementation> DImplementation;
 
     public:
-        CDSVReader(std::shared_ptr< CDataSource > src, char delimiter);
+        static const std::size_t DefaultChunkSize = 64 * 1024;
+
+        CDSVReader(std::shared_ptr< CDataSource > src, char delimiter, std::size_t chunksize = DefaultChunkSize);
         ~CDSVReader();
 
         bool End() const;
         bool ReadRow(std::vector<std::string> &row);
+        // Same as ReadRow without copying the cells, the views stay valid
+        // until the next call to ReadRow or ReadRowView
+        bool ReadRowView(std::vector<std::string_view> &row);
 };
 
 #endif
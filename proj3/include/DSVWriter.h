@@ -1,8 +1,12 @@
 #ifndef DSVWRITER_H
 #define DSVWRITER_H
 
+#include <charconv>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include "DataSink.h"
 
 class CDSVWriter{
@@ -15,6 +19,19 @@ class CDSVWriter{
         ~CDSVWriter();
 
         bool WriteRow(const std::vector<std::string> &row);
+        // Writes all rows, handing them to the sink in large blocks instead of one call per row
+        bool WriteRows(const std::vector< std::vector<std::string> > &rows);
+
+        // Build a row one field at a time, the row goes to the sink on EndRow
+        bool WriteField(std::string_view field);
+        // Numbers are formatted with std::to_chars, doubles in their shortest round trip form
+        template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+        bool WriteField(T value){
+            char Digits[32];
+            auto Result = std::to_chars(Digits, Digits + sizeof(Digits), value);
+            return WriteField(std::string_view(Digits, Result.ptr - Digits));
+        }
+        bool EndRow();
 };
 
 #endif
@@ -2,6 +2,7 @@
 #define DATASOURCE_H
 
 #include <vector>
+#include <cstddef>
 
 class CDataSource{
     public:
@@ -10,6 +11,22 @@ class CDataSource{
         virtual bool Get(char &ch) noexcept = 0;
         virtual bool Peek(char &ch) noexcept = 0;
         virtual bool Read(std::vector<char> &buf, std::size_t count) noexcept = 0;
+
+        // Contiguous view of all remaining bytes, sources that are not backed
+        // by memory return false and are read through Get/Read instead
+        virtual bool View(const char *&data, std::size_t &size) const noexcept{
+            return false;
+        };
+
+        // Consumes up to count bytes without copying them out
+        virtual std::size_t Skip(std::size_t count) noexcept{
+            std::size_t Skipped = 0;
+            char TempChar;
+            while(Skipped < count && Get(TempChar)){
+                Skipped++;
+            }
+            return Skipped;
+        };
 };
 
 #endif
@@ -0,0 +1,37 @@
+#ifndef DECOMPRESSDATASOURCE_H
+#define DECOMPRESSDATASOURCE_H
+
+#include "DataSource.h"
+#include <memory>
+
+// Decompresses a gzip or bzip2 stream from another source block by block, so
+// compressed files can be parsed directly with bounded memory. Concatenated
+// streams, as written by pigz, bgzip or pbzip2, are decoded back to back. To
+// overlap decompression with parsing wrap it in a CPrefetchDataSource.
+class CDecompressDataSource : public CDataSource{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        // Auto picks the format from the magic bytes and passes anything else through unchanged
+        enum class EFormat{Auto, Gzip, BZip2, None};
+
+        static const std::size_t DefaultBufferSize = 256 * 1024;
+
+        CDecompressDataSource(std::shared_ptr< CDataSource > source, EFormat format = EFormat::Auto, std::size_t buffersize = DefaultBufferSize);
+        ~CDecompressDataSource();
+
+        // The format in use, Auto until the first bytes were looked at
+        EFormat Format() const noexcept;
+        // True once corrupt or truncated compressed data stopped the output
+        bool Failed() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        std::size_t Skip(std::size_t count) noexcept override;
+};
+
+#endif
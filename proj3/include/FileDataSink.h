@@ -0,0 +1,46 @@
+#ifndef FILEDATASINK_H
+#define FILEDATASINK_H
+
+#include "DataSink.h"
+#include <string>
+
+// Writes a file through a page aligned buffer that goes out with one large
+// write call when full, on Flush and on destruction. Put is inline and only
+// leaves the buffer when it is full. Blocks larger than the buffer are
+// written directly.
+class CFileDataSink final : public CDataSink{
+    private:
+        int DFileDescriptor;
+        char *DBuffer;
+        std::size_t DBufferSize;
+        std::size_t DUsed;
+
+        bool WriteOut(const char *data, std::size_t length) noexcept;
+
+    public:
+        static const std::size_t DefaultBufferSize = 1 << 20;
+        static const std::size_t Alignment = 4096;
+
+        // The file is created or truncated, if it cannot be opened every write fails
+        CFileDataSink(const std::string &filename, std::size_t buffersize = DefaultBufferSize);
+        ~CFileDataSink();
+        CFileDataSink(const CFileDataSink &) = delete;
+        CFileDataSink &operator=(const CFileDataSink &) = delete;
+
+        bool Valid() const noexcept;
+        // Writes out everything buffered so far
+        bool Flush() noexcept;
+
+        bool Put(const char &ch) noexcept override{
+            if((DUsed == DBufferSize) && !Flush()){
+                return false;
+            }
+            DBuffer[DUsed++] = ch;
+            return true;
+        }
+
+        bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *data, std::size_t length) noexcept;
+};
+
+#endif
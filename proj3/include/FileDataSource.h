@@ -0,0 +1,58 @@
+#ifndef FILEDATASOURCE_H
+#define FILEDATASOURCE_H
+
+#include "DataSource.h"
+#include <string>
+
+// Reads a file through a page aligned buffer that is refilled with one large
+// read call at a time. Get and Peek are inline and only leave the buffer when
+// it runs dry, so calls on a CFileDataSource itself compile to a few loads.
+class CFileDataSource final : public CDataSource{
+    private:
+        int DFileDescriptor;
+        char *DBuffer;
+        std::size_t DBufferSize;
+        mutable std::size_t DStart;
+        mutable std::size_t DEnd;
+        mutable bool DFileEnd;
+
+        bool Fill() const noexcept;
+
+    public:
+        static const std::size_t DefaultBufferSize = 1 << 20;
+        static const std::size_t Alignment = 4096;
+
+        // Missing or unreadable files behave like an empty source, the buffer
+        // size is rounded up to a multiple of the alignment
+        CFileDataSource(const std::string &filename, std::size_t buffersize = DefaultBufferSize);
+        ~CFileDataSource();
+        CFileDataSource(const CFileDataSource &) = delete;
+        CFileDataSource &operator=(const CFileDataSource &) = delete;
+
+        bool Valid() const noexcept;
+
+        bool End() const noexcept override{
+            return (DStart == DEnd) && !Fill();
+        }
+
+        bool Get(char &ch) noexcept override{
+            if((DStart == DEnd) && !Fill()){
+                return false;
+            }
+            ch = DBuffer[DStart++];
+            return true;
+        }
+
+        bool Peek(char &ch) noexcept override{
+            if((DStart == DEnd) && !Fill()){
+                return false;
+            }
+            ch = DBuffer[DStart];
+            return true;
+        }
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        std::size_t Skip(std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef GEOGRAPHICUTILS_H
+#define GEOGRAPHICUTILS_H
+
+#include "StreetMap.h"
+
+namespace GeographicUtils{
+
+// Mean radius of the earth in meters
+const double EarthRadiusMeters = 6371008.8;
+
+double DegreesToRadians(double degrees) noexcept;
+double RadiansToDegrees(double radians) noexcept;
+// Great circle distance in meters between two latitude/longitude pairs in degrees
+double HaversineDistance(const CStreetMap::TLocation &src, const CStreetMap::TLocation &dest) noexcept;
+// Distance in meters from location to the closest point of the latitude/longitude box, zero if inside.
+// The box may not cross the antimeridian.
+double BoxDistance(const CStreetMap::TLocation &location, const CStreetMap::TLocation &lowerleft, const CStreetMap::TLocation &upperright) noexcept;
+
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MMAPDATASOURCE_H
+#define MMAPDATASOURCE_H
+
+#include "DataSource.h"
+#include <string>
+
+// Read-only memory mapped file, the remaining bytes are available through
+// View so readers can parse straight out of the page cache
+class CMMapDataSource : public CDataSource{
+    private:
+        const char *DData;
+        std::size_t DSize;
+        std::size_t DIndex;
+    public:
+        CMMapDataSource(const std::string &filename);
+        ~CMMapDataSource();
+        CMMapDataSource(const CMMapDataSource &) = delete;
+        CMMapDataSource &operator=(const CMMapDataSource &) = delete;
+
+        bool Valid() const noexcept;
+        std::size_t Size() const noexcept;
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        bool View(const char *&data, std::size_t &size) const noexcept override;
+        std::size_t Skip(std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef OSMSTREAM_H
+#define OSMSTREAM_H
+
+#include "XMLReader.h"
+#include "StreetMap.h"
+#include <string_view>
+
+// Forward only reader over the nodes and ways of an OSM document. Every element is
+// decoded into one scratch node or way that is reused for the next, so filters,
+// statistics and conversions run in constant memory whatever the input size.
+class COSMStream{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        enum class EElement{None, Node, Way};
+
+        // Attributes of the current element in document order. A repeated key keeps
+        // its first position and takes the last value. Strings are reused between
+        // elements, so they only allocate while growing.
+        class CAttributes{
+            private:
+                std::vector< std::pair< std::string, std::string > > DPairs;
+                std::size_t DCount = 0;
+
+            public:
+                std::size_t Count() const noexcept{
+                    return DCount;
+                };
+
+                const std::string &Key(std::size_t index) const noexcept{
+                    return DPairs[index].first;
+                };
+
+                const std::string &Value(std::size_t index) const noexcept{
+                    return DPairs[index].second;
+                };
+
+                // Index of key, or Count() if it is missing
+                std::size_t Find(std::string_view key) const noexcept{
+                    std::size_t Index = 0;
+                    while((Index < DCount) && (DPairs[Index].first != key)){
+                        Index++;
+                    }
+                    return Index;
+                };
+
+                void Clear() noexcept{
+                    DCount = 0;
+                };
+
+                void Set(const char *key, const char *value);
+        };
+
+        // Scratch node, only valid until the next element is read
+        struct SNode : public CStreetMap::SNode{
+            CStreetMap::TNodeID DID = 0;
+            CStreetMap::TLocation DLocation;
+            CAttributes DAttributes;
+
+            CStreetMap::TNodeID ID() const noexcept override;
+            CStreetMap::TLocation Location() const noexcept override;
+            std::size_t AttributeCount() const noexcept override;
+            std::string GetAttributeKey(std::size_t index) const noexcept override;
+            std::string GetAttributeValue(std::size_t index) const noexcept override;
+            bool HasAttribute(const std::string &key) const noexcept override;
+            std::string GetAttribute(const std::string &key) const noexcept override;
+        };
+
+        // Scratch way, only valid until the next element is read
+        struct SWay : public CStreetMap::SWay{
+            CStreetMap::TWayID DID = 0;
+            std::vector< CStreetMap::TNodeID > DNodeIDs;
+            CAttributes DAttributes;
+
+            CStreetMap::TWayID ID() const noexcept override;
+            std::size_t NodeCount() const noexcept override;
+            CStreetMap::TNodeID GetNodeID(std::size_t index) const noexcept override;
+            std::size_t AttributeCount() const noexcept override;
+            std::string GetAttributeKey(std::size_t index) const noexcept override;
+            std::string GetAttributeValue(std::size_t index) const noexcept override;
+            bool HasAttribute(const std::string &key) const noexcept override;
+            std::string GetAttribute(const std::string &key) const noexcept override;
+        };
+
+        // Called once per finished element with the scratch object
+        struct SVisitor{
+            virtual ~SVisitor(){};
+            virtual void Node(const SNode &node){};
+            virtual void Way(const SWay &way){};
+        };
+
+        // Sets an element filter on src so relations and other elements are skipped
+        // inside the parser, so src should not have been read from yet
+        COSMStream(std::shared_ptr< CXMLReader > src);
+        ~COSMStream();
+
+        // Reads up to the end of the next node or way, None once the input is done
+        EElement Next();
+        // Skip ahead to the next element of one kind
+        bool NextNode();
+        bool NextWay();
+        // The element returned by the last Next, NextNode or NextWay
+        const SNode &Node() const noexcept;
+        const SWay &Way() const noexcept;
+        // Pushes the rest of the input through visitor, faster than pulling since no
+        // entities are built. Returns false if the document is malformed.
+        bool Visit(SVisitor &visitor);
+};
+
+#endif
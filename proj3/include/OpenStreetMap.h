@@ -3,14 +3,180 @@
 
 #include "XMLReader.h"
 #include "StreetMap.h"
+#include "DataSink.h"
+#include "DataSource.h"
+#include <functional>
 
 class COpenStreetMap : public CStreetMap{
     private:
         struct SImplementation;
         std::unique_ptr<SImplementation> DImplementation;
 
+        // coordinates are stored as fixed point at OSM's native 1e-7 degree precision
+        static constexpr double CoordinateScale = 1e7;
+
+        // raw columns read by the handles, set once loading is done and fixed afterwards
+        struct SColumns{
+            const TNodeID *DNodeIDs = nullptr;
+            const int32_t *DLatitudes = nullptr;
+            const int32_t *DLongitudes = nullptr;
+            std::size_t DNodeCount = 0;
+            const TWayID *DWayIDs = nullptr;
+            const uint32_t *DWayNodeOffsets = nullptr;
+            const TNodeID *DWayNodeIDs = nullptr;
+            std::size_t DWayCount = 0;
+        };
+        SColumns DColumns;
+
+        COpenStreetMap();
+        void UpdateColumns();
+
     public:
+        // Non-owning, trivially copyable view of a node. Copies cost no reference
+        // counting and it stays valid as long as the map. A default constructed
+        // handle, as returned by a failed lookup, converts to false.
+        class CNodeHandle{
+            private:
+                const COpenStreetMap *DMap = nullptr;
+                std::size_t DIndex = 0;
+
+            public:
+                CNodeHandle() = default;
+                CNodeHandle(const COpenStreetMap *map, std::size_t index) noexcept : DMap(map), DIndex(index){};
+
+                explicit operator bool() const noexcept{
+                    return DMap != nullptr;
+                };
+
+                std::size_t Index() const noexcept{
+                    return DIndex;
+                };
+
+                TNodeID ID() const noexcept{
+                    return DMap->DColumns.DNodeIDs[DIndex];
+                };
+
+                TLocation Location() const noexcept{
+                    return TLocation(DMap->DColumns.DLatitudes[DIndex] / CoordinateScale, DMap->DColumns.DLongitudes[DIndex] / CoordinateScale);
+                };
+
+                std::size_t AttributeCount() const noexcept;
+                std::string GetAttributeKey(std::size_t index) const noexcept;
+                std::string GetAttributeValue(std::size_t index) const noexcept;
+                bool HasAttribute(const std::string &key) const noexcept;
+                std::string GetAttribute(const std::string &key) const noexcept;
+        };
+
+        // Non-owning way view, same rules as CNodeHandle
+        class CWayHandle{
+            private:
+                const COpenStreetMap *DMap = nullptr;
+                std::size_t DIndex = 0;
+
+            public:
+                CWayHandle() = default;
+                CWayHandle(const COpenStreetMap *map, std::size_t index) noexcept : DMap(map), DIndex(index){};
+
+                explicit operator bool() const noexcept{
+                    return DMap != nullptr;
+                };
+
+                std::size_t Index() const noexcept{
+                    return DIndex;
+                };
+
+                TWayID ID() const noexcept{
+                    return DMap->DColumns.DWayIDs[DIndex];
+                };
+
+                std::size_t NodeCount() const noexcept{
+                    return DMap->DColumns.DWayNodeOffsets[DIndex + 1] - DMap->DColumns.DWayNodeOffsets[DIndex];
+                };
+
+                TNodeID GetNodeID(std::size_t index) const noexcept{
+                    return index < NodeCount() ? DMap->DColumns.DWayNodeIDs[DMap->DColumns.DWayNodeOffsets[DIndex] + index] : InvalidNodeID;
+                };
+
+                std::size_t AttributeCount() const noexcept;
+                std::string GetAttributeKey(std::size_t index) const noexcept;
+                std::string GetAttributeValue(std::size_t index) const noexcept;
+                bool HasAttribute(const std::string &key) const noexcept;
+                std::string GetAttribute(const std::string &key) const noexcept;
+        };
+
+        // Every node or way in index order, for range based for loops
+        template <typename THandle>
+        class CRange{
+            private:
+                const COpenStreetMap *DMap;
+                std::size_t DCount;
+
+            public:
+                class CIterator{
+                    private:
+                        const COpenStreetMap *DMap;
+                        std::size_t DIndex;
+
+                    public:
+                        CIterator(const COpenStreetMap *map, std::size_t index) noexcept : DMap(map), DIndex(index){};
+
+                        THandle operator*() const noexcept{
+                            return THandle(DMap, DIndex);
+                        };
+
+                        CIterator &operator++() noexcept{
+                            DIndex++;
+                            return *this;
+                        };
+
+                        bool operator==(const CIterator &other) const noexcept{
+                            return DIndex == other.DIndex;
+                        };
+
+                        bool operator!=(const CIterator &other) const noexcept{
+                            return DIndex != other.DIndex;
+                        };
+                };
+
+                CRange(const COpenStreetMap *map, std::size_t count) noexcept : DMap(map), DCount(count){};
+
+                CIterator begin() const noexcept{
+                    return CIterator(DMap, 0);
+                };
+
+                CIterator end() const noexcept{
+                    return CIterator(DMap, DCount);
+                };
+
+                std::size_t size() const noexcept{
+                    return DCount;
+                };
+        };
+
+        using TNodePredicate = std::function<bool(const CStreetMap::SNode &node)>;
+        using TWayPredicate = std::function<bool(const CStreetMap::SWay &way)>;
+
+        // Partial load. The bounds and filters test each element while streaming, so
+        // the elements they reject are never stored and their tags never interned.
+        struct SLoadOptions{
+            // Nodes outside the box are dropped, and ways are only kept if at least
+            // one of their nodes lies inside. Kept ways keep all of their node IDs.
+            bool DUseBounds = false;
+            TLocation DMinimum = TLocation(-90.0, -180.0);
+            TLocation DMaximum = TLocation(90.0, 180.0);
+            // Elements rejected by a predicate are dropped, empty accepts everything
+            TNodePredicate DNodeFilter;
+            TWayPredicate DWayFilter;
+            // Drops the nodes that no kept way references. This runs after parsing
+            // since ways follow nodes, so every candidate node is stored and its
+            // tags interned first; peak memory follows the candidates, not the result.
+            bool DReferencedNodesOnly = false;
+        };
+
+        // Offsets and indices are 32 bit, an input with more than about 4 billion
+        // tags, way node references or string bytes loads as an empty map
         COpenStreetMap(std::shared_ptr<CXMLReader> src);
+        COpenStreetMap(std::shared_ptr<CXMLReader> src, const SLoadOptions &options);
         ~COpenStreetMap();
 
         std::size_t NodeCount() const noexcept override;
@@ -19,6 +185,19 @@ class COpenStreetMap : public CStreetMap{
         std::shared_ptr<CStreetMap::SNode> NodeByID(TNodeID id) const noexcept override;
         std::shared_ptr<CStreetMap::SWay> WayByIndex(std::size_t index) const noexcept override;
         std::shared_ptr<CStreetMap::SWay> WayByID(TWayID id) const noexcept override;
+
+        // Handle counterparts of the lookups above, empty handles where those return nullptr
+        CNodeHandle NodeHandleByIndex(std::size_t index) const noexcept;
+        CNodeHandle NodeHandleByID(TNodeID id) const noexcept;
+        CWayHandle WayHandleByIndex(std::size_t index) const noexcept;
+        CWayHandle WayHandleByID(TWayID id) const noexcept;
+        CRange<CNodeHandle> Nodes() const noexcept;
+        CRange<CWayHandle> Ways() const noexcept;
+
+        // Writes the map in a binary form that LoadSnapshot can map back in without parsing
+        bool WriteSnapshot(std::shared_ptr<CDataSink> sink) const;
+        // Returns nullptr if the source does not hold a valid snapshot
+        static std::shared_ptr<COpenStreetMap> LoadSnapshot(std::shared_ptr<CDataSource> src);
 };
 
 #endif
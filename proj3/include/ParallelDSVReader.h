@@ -0,0 +1,36 @@
+#ifndef PARALLELDSVREADER_H
+#define PARALLELDSVREADER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataSource.h"
+
+// Parses a whole memory backed or in-memory DSV input on several threads.
+// The input is cut into chunks, the chunk edges are moved to real row
+// boundaries with a quote aware scan, and each chunk is read with CDSVReader
+// so the rows are identical to reading the input sequentially.
+class CParallelDSVReader{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TRows = std::vector< std::vector< std::string > >;
+        // Called from the worker threads, chunkindex is the position of the chunk in the input
+        using TChunkCallback = std::function< void(std::size_t chunkindex, TRows &rows) >;
+
+        static const std::size_t DefaultChunkSize = 4 * 1024 * 1024;
+
+        // A threadcount of zero uses one thread per core
+        CParallelDSVReader(std::shared_ptr< CDataSource > src, char delimiter, std::size_t threadcount = 0, std::size_t chunksize = DefaultChunkSize);
+        ~CParallelDSVReader();
+
+        std::size_t ThreadCount() const;
+        std::size_t ChunkCount() const;
+        bool ReadAll(TRows &rows);
+        bool ForEachChunk(TChunkCallback callback);
+};
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef PREFETCHDATASOURCE_H
+#define PREFETCHDATASOURCE_H
+
+#include "DataSource.h"
+#include <memory>
+
+// Wraps another source and reads it ahead on a background thread into a ring
+// of blocks, so the consumer finds the data already in memory while the next
+// blocks are being read. The blocks are handed over through a lock free
+// single producer/single consumer ring. The wrapped source must not be used
+// by anyone else while the wrapper exists.
+class CPrefetchDataSource : public CDataSource{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        static const std::size_t DefaultBlockSize = 1 << 20;
+        static const std::size_t DefaultBlockCount = 4;
+
+        CPrefetchDataSource(std::shared_ptr< CDataSource > source, std::size_t blocksize = DefaultBlockSize, std::size_t blockcount = DefaultBlockCount);
+        ~CPrefetchDataSource();
+
+        bool End() const noexcept override;
+        bool Get(char &ch) noexcept override;
+        bool Peek(char &ch) noexcept override;
+        // Hands a whole block over without copying when count covers it
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override;
+        std::size_t Skip(std::size_t count) noexcept override;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef ROUTINGGRAPH_H
+#define ROUTINGGRAPH_H
+
+#include "StreetMap.h"
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Directed road graph built from the highway ways of a street map. Vertices are
+// the nodes the ways pass through, edges join consecutive way nodes and weigh
+// their great circle length in meters. Adjacency is kept in compressed sparse
+// row form so a search touches two flat arrays.
+class CRoutingGraph{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TNodeID = CStreetMap::TNodeID;
+        using TVertex = uint32_t;
+
+        static constexpr TVertex InvalidVertex = std::numeric_limits<TVertex>::max();
+        static constexpr double NoPathExists = std::numeric_limits<double>::max();
+
+        // Search state that can be reused between queries so they do not allocate.
+        // Each thread needs its own, it can be shared between graphs.
+        class CWorkspace{
+            private:
+                struct SImplementation;
+                std::unique_ptr<SImplementation> DImplementation;
+                friend class CRoutingGraph;
+
+            public:
+                CWorkspace();
+                ~CWorkspace();
+        };
+
+        CRoutingGraph(std::shared_ptr<CStreetMap> map);
+        ~CRoutingGraph();
+
+        std::size_t VertexCount() const noexcept;
+        std::size_t EdgeCount() const noexcept;
+        // Outgoing edges of a vertex, for algorithms that walk the graph themselves
+        std::size_t EdgeCount(TVertex vertex) const noexcept;
+        TVertex EdgeTarget(TVertex vertex, std::size_t index) const noexcept;
+        double EdgeWeight(TVertex vertex, std::size_t index) const noexcept;
+        // Returns InvalidVertex if no routable way passes through the node
+        TVertex VertexByNodeID(TNodeID id) const noexcept;
+        TNodeID NodeIDByVertex(TVertex vertex) const noexcept;
+
+        // Both return the length of the shortest path in meters and fill path with its
+        // node IDs, or return NoPathExists and leave path empty. The overloads without
+        // a workspace use one kept per thread.
+        double FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path, CWorkspace &workspace) const;
+        double FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path) const;
+        // A* search guided by the straight line distance to dest, finds paths of the same length as FindShortestPath
+        double FindShortestPathAStar(TNodeID src, TNodeID dest, std::vector<TNodeID> &path, CWorkspace &workspace) const;
+        double FindShortestPathAStar(TNodeID src, TNodeID dest, std::vector<TNodeID> &path) const;
+};
+
+#endif
@@ -22,6 +22,11 @@ class CStreetMap{
             virtual TLocation Location() const noexcept = 0;
             virtual std::size_t AttributeCount() const noexcept = 0;
             virtual std::string GetAttributeKey(std::size_t index) const noexcept = 0;
+            // Value of the attribute at index, so every attribute can be visited in one pass.
+            // Implementations with indexed storage override the lookup by key.
+            virtual std::string GetAttributeValue(std::size_t index) const noexcept{
+                return GetAttribute(GetAttributeKey(index));
+            };
             virtual bool HasAttribute(const std::string &key) const noexcept = 0;
             virtual std::string GetAttribute(const std::string &key) const noexcept = 0;
         };
@@ -33,6 +38,11 @@ class CStreetMap{
             virtual TNodeID GetNodeID(std::size_t index) const noexcept = 0;
             virtual std::size_t AttributeCount() const noexcept = 0;
             virtual std::string GetAttributeKey(std::size_t index) const noexcept = 0;
+            // Value of the attribute at index, so every attribute can be visited in one pass.
+            // Implementations with indexed storage override the lookup by key.
+            virtual std::string GetAttributeValue(std::size_t index) const noexcept{
+                return GetAttribute(GetAttributeKey(index));
+            };
             virtual bool HasAttribute(const std::string &key) const noexcept = 0;
             virtual std::string GetAttribute(const std::string &key) const noexcept = 0;
         };
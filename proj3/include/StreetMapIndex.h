@@ -0,0 +1,35 @@
+#ifndef STREETMAPINDEX_H
+#define STREETMAPINDEX_H
+
+#include "StreetMap.h"
+#include <memory>
+#include <vector>
+
+// Static spatial index over the node locations of a street map. The nodes are
+// sorted along a Hilbert curve and packed into an R-tree, so queries only visit
+// the boxes that can hold a result. Results are node indices for NodeByIndex.
+class CStreetMapIndex{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TLocation = CStreetMap::TLocation;
+
+        static const std::size_t DefaultNodeSize = 16;
+
+        CStreetMapIndex(std::shared_ptr<CStreetMap> map, std::size_t nodesize = DefaultNodeSize);
+        ~CStreetMapIndex();
+
+        std::size_t NodeCount() const noexcept;
+        // The count closest nodes ordered by distance, ties go to the lower index
+        std::vector<std::size_t> Nearest(const TLocation &location, std::size_t count = 1) const;
+        // Nodes within meters of location in index order
+        std::vector<std::size_t> WithinRadius(const TLocation &location, double meters) const;
+        // Nodes inside the latitude/longitude box in index order, the box may not cross the antimeridian
+        std::vector<std::size_t> WithinBounds(const TLocation &lowerleft, const TLocation &upperright) const;
+        // Nearest for every location, a threadcount of zero uses one thread per core
+        std::vector< std::vector<std::size_t> > NearestBatch(const std::vector<TLocation> &locations, std::size_t count = 1, std::size_t threadcount = 0) const;
+};
+
+#endif
@@ -3,15 +3,40 @@
 
 #include "DataSink.h"
 #include <string>
+#include <string_view>
+#include <vector>
 
+// Collects everything written in memory. In chunked mode the data goes into a
+// list of fixed size chunks instead of one string, so large outputs never
+// reallocate and copy what was already written. String() then joins the
+// chunks on demand, Chunks() gives the pieces without copying.
 class CStringDataSink : public CDataSink{
+    public:
+        enum class EMode{String, Chunked};
+
+        static const std::size_t DefaultChunkSize = 1 << 20;
+
     private:
-        std::string DString;
+        EMode DMode;
+        std::size_t DChunkSize;
+        std::size_t DSize = 0;
+        std::vector<std::string> DChunks;
+        mutable std::string DString;
+
+        bool Append(const char *data, std::size_t length) noexcept;
+
     public:
+        CStringDataSink(EMode mode = EMode::String, std::size_t chunksize = DefaultChunkSize);
+
         const std::string &String() const;
+        std::vector<std::string_view> Chunks() const;
+        std::size_t Size() const noexcept;
+        // Makes room for capacity bytes in total so that writing up to that much does not reallocate
+        void Reserve(std::size_t capacity);
 
         bool Put(const char &ch) noexcept override;
         bool Write(const std::vector<char> &buf) noexcept override;
+        bool Write(const char *data, std::size_t length) noexcept;
 };
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef XMLATOMTABLE_H
+#define XMLATOMTABLE_H
+
+#include "XMLEntity.h"
+#include <memory>
+#include <string_view>
+
+// Maps element and attribute names to small integer atoms. Atoms start at one
+// and never change once handed out, and the views returned by Name stay valid
+// as long as the table does, so one table can be shared by several readers.
+class CXMLAtomTable{
+    private:
+        struct SImplementation;
+        std::unique_ptr<SImplementation> DImplementation;
+
+    public:
+        using TAtom = SXMLEntity::TAtom;
+
+        CXMLAtomTable();
+        ~CXMLAtomTable();
+
+        // Returns the atom for name, adding it if it is new
+        TAtom Intern(std::string_view name);
+        // Returns the atom for name or SXMLEntity::InvalidAtom if it was never interned
+        TAtom Find(std::string_view name) const noexcept;
+        // Returns the name of atom, empty for atoms not in the table
+        std::string_view Name(TAtom atom) const noexcept;
+        std::size_t AtomCount() const noexcept;
+};
+
+#endif
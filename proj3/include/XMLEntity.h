@@ -1,16 +1,23 @@
 #ifndef XMLENTITY_H
 #define XMLENTITY_H
 
+#include <cstdint>
 #include <utility>
 #include <string>
 #include <vector>
 
 struct SXMLEntity{
     using TAttribute = std::pair< std::string, std::string >;
+    using TAtom = uint32_t;
+    static constexpr TAtom InvalidAtom = 0;
     enum class EType{StartElement, EndElement, CharData, CompleteElement};
     EType DType;
     std::string DNameData;
     std::vector< TAttribute > DAttributes;
+    // Filled by a reader with an atom table, otherwise InvalidAtom and empty.
+    // DAttributeAtoms[i] is the atom of the name in DAttributes[i].
+    TAtom DNameAtom = InvalidAtom;
+    std::vector< TAtom > DAttributeAtoms;
     
     bool AttributeExists(const std::string &name) const{
         for(auto &Attribute : DAttributes){
@@ -21,6 +28,15 @@ struct SXMLEntity{
         return false;
     };
     
+    bool AttributeExists(TAtom name) const{
+        for(auto &Atom : DAttributeAtoms){
+            if(Atom == name){
+                return true;
+            }
+        }
+        return false;
+    };
+
     std::string AttributeValue(const std::string &name) const{
         for(auto &Attribute : DAttributes){
             if(std::get<0>(Attribute) == name){
@@ -30,6 +46,15 @@ struct SXMLEntity{
         return std::string();
     };
     
+    std::string AttributeValue(TAtom name) const{
+        for(std::vector< TAtom >::size_type Index = 0; Index < DAttributeAtoms.size(); Index++){
+            if(DAttributeAtoms[Index] == name){
+                return std::get<1>(DAttributes[Index]);
+            }
+        }
+        return std::string();
+    };
+    
     bool SetAttribute(const std::string &name, const std::string &value){
         if(name.empty()){
             return false;   
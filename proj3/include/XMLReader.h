@@ -2,20 +2,51 @@
 #define XMLREADER_H
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "XMLEntity.h"
 #include "DataSource.h"
 
+class CXMLAtomTable;
+
 class CXMLReader{
     private:
         struct SImplementation;
         std::unique_ptr<SImplementation> DImplementation;
         
     public:
-        CXMLReader(std::shared_ptr< CDataSource > src);
+        // Receives the parser events as expat produces them, without building entities.
+        // Names, attributes and character data point into the parser and are only
+        // valid during the call. attributes is a null terminated array of name, value
+        // pairs. Character data may be split over several calls.
+        struct SHandler{
+            virtual ~SHandler(){};
+            virtual void StartElement(const char *name, const char **attributes){};
+            virtual void EndElement(const char *name){};
+            virtual void CharacterData(const char *data, std::size_t length){};
+        };
+
+        static const std::size_t DefaultChunkSize = 64 * 1024;
+
+        CXMLReader(std::shared_ptr< CDataSource > src, std::size_t chunksize = DefaultChunkSize);
         ~CXMLReader();
         
         bool End() const;
         bool ReadEntity(SXMLEntity &entity, bool skipcdata = false);
+        // Only elements named in names are emitted, any other element is skipped
+        // together with its whole subtree before an entity is built. The root is
+        // never skipped so its children are still seen, but it is only emitted if
+        // listed. An empty list emits everything. Applies to input expat has not
+        // reached yet, so set it before reading.
+        void SetElementFilter(const std::vector<std::string> &names);
+        // With a table set, ReadEntity also fills DNameAtom and DAttributeAtoms by
+        // interning the element and attribute names, nullptr turns it off again.
+        // Like the filter it applies to input expat has not reached yet.
+        void SetAtomTable(std::shared_ptr<CXMLAtomTable> atoms);
+        std::shared_ptr<CXMLAtomTable> AtomTable() const;
+        // Passes the rest of the input to handler, entities already read ahead for
+        // ReadEntity go first. Returns false if the document is malformed.
+        bool Parse(SHandler &handler);
 };
 
 #endif
@@ -11,9 +11,14 @@ class CXMLWriter{
         std::unique_ptr<SImplementation> DImplementation;
         
     public:
-        CXMLWriter(std::shared_ptr< CDataSink > sink);
+        static const std::size_t DefaultBufferSize = 64 * 1024;
+
+        // Output is collected and handed to sink->Write in blocks of about
+        // buffersize bytes, so a failing sink may only be noticed on a later call
+        CXMLWriter(std::shared_ptr< CDataSink > sink, std::size_t buffersize = DefaultBufferSize);
         ~CXMLWriter();
         
+        // Closes the open elements and writes out everything buffered
         bool Flush();
         bool WriteEntity(const SXMLEntity &entity);
 };
@@ -6,106 +6,82 @@
 #include <string> 
 #include <iostream> 
 #include <sstream> 
+#include <string_view> 
+#include <charconv> 
+#include <cctype> 
 
 
 // Private Implementation
-class CCSVBusSystem::SStop : public CBusSystem::SStop {     //Create a bus stop class 
-    public: 
-        TStopID DStopID; 
-        CStreetMap::TNodeID NodeIDVal;                      //Initialized a NodeIDVal to retrieve the value of the Node and of the DStopID 
-
-        TStopID ID() const noexcept override {             //Overriding everything to avoid abstraction from disrupting the virtual functions 
-            return DStopID; 
-        } 
-
-        CStreetMap::TNodeID NodeID() const noexcept override {
-            return NodeIDVal; 
-        }
-    }; 
-
-class CCSVBusSystem::SRoute : public CBusSystem::SRoute {     //Created an SRoute Class to represent the bus route but it is essentially a nested class 
-    public: 
-        std::string DName;                   //This establishes the name of the route essentially 
-        std::vector<TStopID> DStopIDs;       //This lists the Stop IDs that form the route 
-
-        // This returns the name of the route hence why we call on override 
-        std::string Name() const noexcept override{ 
-            return DName; 
-        }
-
-        //This returns the size "aka" number of stopping points int he route 
-        std::size_t StopCount() const noexcept override{ 
-            return DStopIDs.size(); 
-        }
-
-        //This returns the stop ID to the corresponding index 
-        TStopID GetStopID(std::size_t index) const noexcept override{
-            if (index < DStopIDs.size()){
-                return DStopIDs[index]; 
-            }
-            return CBusSystem::InvalidStopID;            //Otherwise it would return an invalid ID 
-        }
-    }; 
-
-   struct CCSVBusSystem::SImplementation{                 //Esetablishes the private implementation; Helper structure to handle data 
-        std::vector<std::shared_ptr<SStop>> DStops;       // DStops and Droutes hold the list of all stops and routes 
-        std::vector<std::shared_ptr<SRoute>> DRoutes; 
-        std::unordered_map<TStopID, std::shared_ptr<SStop>> DStopByIDMap;        //While DStopByIDMap and DRouteByNameMap map stopIDs and route names to their respective objects 
-        std::unordered_map<std::string, std::shared_ptr<SRoute>> DRouteByNameMap;
-
-
-        SImplementation(std::shared_ptr<CDSVReader> stopsrc, std::shared_ptr<CDSVReader>routesrc){ //This works as a CSV reader 
-
-        }
-    }; 
+struct CCSVBusSystem::SImplementation{                 //Esetablishes the private implementation; Helper structure to handle data 
+    // Stops and routes are stored by value in one array each, the shared_ptr lookups hand out
+    // aliasing pointers that keep the whole array alive 
+    std::shared_ptr<std::vector<SStop>> DStops = std::make_shared<std::vector<SStop>>(); 
+    std::shared_ptr<std::vector<SRoute>> DRoutes = std::make_shared<std::vector<SRoute>>(); 
+    std::unordered_map<TStopID, std::size_t> DStopByIDMap;        //While DStopByIDMap and DRouteByNameMap map stopIDs and route names to their indices 
+    std::unordered_map<std::string, std::size_t> DRouteByNameMap;
+}; 
+
+// Converts a cell to an ID the way std::stoul would, without building a string or throwing.
+// Leading spaces, a '+' sign and anything after the digits are accepted, a '-' sign is
+// rejected rather than wrapped to a huge ID.
+static bool ParseID(std::string_view cell, uint64_t &value){
+    std::size_t Start = 0;
+    while (Start < cell.size() && std::isspace(static_cast<unsigned char>(cell[Start]))){
+        Start++;
+    }
+    if (Start < cell.size() && cell[Start] == '+'){
+        Start++;
+    }
+    auto Result = std::from_chars(cell.data() + Start, cell.data() + cell.size(), value);
+    return Result.ec == std::errc();
+}
 
 CCSVBusSystem::CCSVBusSystem(std::shared_ptr<CDSVReader> stopsrc, std::shared_ptr<CDSVReader> routesrc){
-    DImplementation = std::make_unique<SImplementation>(stopsrc, routesrc); 
-    std:: vector<std::string> stopRow; 
+    DImplementation = std::make_unique<SImplementation>(); 
+    auto &Stops = *DImplementation->DStops; 
+    auto &Routes = *DImplementation->DRoutes; 
+    std::vector<std::string_view> stopRow;                      // Views into the reader's buffer so no strings are built per row 
 
     // This works to read the stop data essentially 
     if (stopsrc){        
-        while (stopsrc->ReadRow(stopRow)){                      //While stopsrc is reading the current row and if stoprow is less than or equal to 2 
+        while (stopsrc->ReadRowView(stopRow)){                  //While stopsrc is reading the current row and if stoprow is less than or equal to 2 
             if (stopRow.size() >= 2){
-                try {
-                    auto stop = std::make_shared<SStop>();     // This reads every row of the stopsrc 
-                    stop->DStopID=std::stoul(stopRow[0]); 
-                    stop->NodeIDVal = std::stoul(stopRow[1]);  // This converst the string data to unsigned long aka std::stoul 
-                    DImplementation->DStops.push_back(stop);   // We push back the stop and store it in Dstops and then DStopByIDMap so we can access it for lookups later 
-                    DImplementation->DStopByIDMap[stop->DStopID] = stop;
-                } catch (const std::exception& e){            // Handles error and exceptions 
-                    std::cerr << "Caught an exception" << e.what() << "\n"; 
+                TStopID stopID; 
+                CStreetMap::TNodeID nodeID; 
+                if (ParseID(stopRow[0], stopID) && ParseID(stopRow[1], nodeID)){   // This converts the cells to unsigned values 
+                    DImplementation->DStopByIDMap[stopID] = Stops.size();   // A repeated ID finds the last stop with it 
+                    Stops.emplace_back(); 
+                    Stops.back().DStopID = stopID; 
+                    Stops.back().NodeIDVal = nodeID; 
+                } else {                                       // Handles rows that are not stops such as the header 
+                    std::cerr << "Error processing stop row: invalid ID\n"; 
                 }
             }
         }   
     }
 
-    if (routesrc) {                                             // This functions reads the routes 
-        std::unordered_map<std::string, std::shared_ptr<SRoute>> routeMap;    //This creates a temporary routeMap to store routes
+    if (routesrc) {                                             // This functions reads the routes, in the order they first appear 
+        std::size_t lastRoute = 0;                              //Rows of a route are usually together so the last one is checked before the map 
 
-        while (routesrc->ReadRow(stopRow)) {                    // This reads every line and we set stopRow.size() >= 2 
+        while (routesrc->ReadRowView(stopRow)) {                // This reads every line and we set stopRow.size() >= 2 
             if (stopRow.size() >= 2) {
-                try {
-                    std::string rName = stopRow[0];            //Indexing so routename starts at 0 and stop id starts after. We change Stop ID to unsigned 
-                    TStopID stopID = std::stoul(stopRow[1]);
-                    
-                    auto& route = routeMap[rName];            //We group teh routes together here and 
-                    if (!route) {                            //If a route does not exist then we just push the stopID 
-                        route = std::make_shared<SRoute>();
-                        route->DName = rName;
+                TStopID stopID; 
+                if (!ParseID(stopRow[1], stopID)) {             //This handles the rows with an invalid stop id 
+                    std::cerr << "Error processing route row: invalid stop ID\n";
+                    continue; 
+                }
+                if (Routes.empty() || Routes[lastRoute].DName != stopRow[0]) {   //Indexing so routename starts at 0 and stop id starts after 
+                    std::string rName(stopRow[0]);
+                    auto Result = DImplementation->DRouteByNameMap.emplace(rName, Routes.size()); 
+                    if (Result.second) {                     //If a route does not exist then we add it 
+                        Routes.emplace_back();
+                        Routes.back().DName = rName;
                     }
-                    route->DStopIDs.push_back(stopID);
-                } catch (const std::exception& e) {         //This handles the exceptions 
-                    std::cerr << "Error processing route row: " << e.what() << "\n";
+                    lastRoute = Result.first->second; 
                 }
+                Routes[lastRoute].DStopIDs.push_back(stopID);
             }
         }
-
-        // Transfer routes to implementation
-        for (const auto& pair : routeMap) {    
-            DImplementation->DRouteByNameMap[pair.first] = pair.second;        //We transfer routes from routeMap list to DImplementation so we can actually use it 
-            DImplementation->DRoutes.push_back(pair.second);      
-        }
     }
 }
 
@@ -114,44 +90,62 @@ CCSVBusSystem::~CCSVBusSystem() = default;
 
 //These return the number of stops and routes 
 std::size_t CCSVBusSystem::StopCount() const noexcept { 
-    return DImplementation->DStops.size(); 
+    return DImplementation->DStops->size(); 
 }
 
 std::size_t CCSVBusSystem::RouteCount() const noexcept { 
-    return DImplementation->DRoutes.size(); 
+    return DImplementation->DRoutes->size(); 
 }
 //This retrieves the stops by size and returns a nullptr if else 
 std::shared_ptr<CBusSystem::SStop> CCSVBusSystem::StopByIndex(std::size_t index) const noexcept { 
-    if (index < DImplementation->DStops.size()){
-        return DImplementation->DStops[index]; 
-    }
-    return nullptr; 
+    auto Stop = StopHandleByIndex(index); 
+    return Stop ? std::shared_ptr<CBusSystem::SStop>(DImplementation->DStops, const_cast<CBusSystem::SStop *>(Stop)) : nullptr; 
 }
 
 //THis function returns a stop by id 
 std::shared_ptr<CBusSystem::SStop> CCSVBusSystem::StopByID(TStopID id) const noexcept { 
-    auto it = DImplementation->DStopByIDMap.find(id); 
-    if (it != DImplementation ->DStopByIDMap.end()){
-        return it->second; 
-    }
-    return nullptr; 
+    auto Stop = StopHandleByID(id); 
+    return Stop ? std::shared_ptr<CBusSystem::SStop>(DImplementation->DStops, const_cast<CBusSystem::SStop *>(Stop)) : nullptr; 
 }
 
 //This retrieves routes by index 
 std::shared_ptr<CBusSystem::SRoute> CCSVBusSystem::RouteByIndex(std::size_t index) const noexcept { 
-    if (index < DImplementation->DRoutes.size()){
-        return DImplementation->DRoutes[index];
-    }
-    return nullptr;
+    auto Route = RouteHandleByIndex(index); 
+    return Route ? std::shared_ptr<CBusSystem::SRoute>(DImplementation->DRoutes, const_cast<CBusSystem::SRoute *>(Route)) : nullptr; 
 }
 
 std::shared_ptr<CBusSystem::SRoute> CCSVBusSystem::RouteByName(const std::string &name) const noexcept { 
-    
+    auto Route = RouteHandleByName(name); 
+    return Route ? std::shared_ptr<CBusSystem::SRoute>(DImplementation->DRoutes, const_cast<CBusSystem::SRoute *>(Route)) : nullptr; 
+}
+
+// Non-owning versions of the lookups, these never touch a reference count 
+const CBusSystem::SStop *CCSVBusSystem::StopHandleByIndex(std::size_t index) const noexcept { 
+    return index < DImplementation->DStops->size() ? &(*DImplementation->DStops)[index] : nullptr; 
+}
+
+const CBusSystem::SStop *CCSVBusSystem::StopHandleByID(TStopID id) const noexcept { 
+    auto it = DImplementation->DStopByIDMap.find(id); 
+    return it != DImplementation->DStopByIDMap.end() ? &(*DImplementation->DStops)[it->second] : nullptr; 
+}
+
+const CBusSystem::SRoute *CCSVBusSystem::RouteHandleByIndex(std::size_t index) const noexcept { 
+    return index < DImplementation->DRoutes->size() ? &(*DImplementation->DRoutes)[index] : nullptr; 
+}
+
+const CBusSystem::SRoute *CCSVBusSystem::RouteHandleByName(const std::string &name) const noexcept { 
     auto it = DImplementation->DRouteByNameMap.find(name); 
-    if (it != DImplementation->DRouteByNameMap.end()){
-        return it->second; 
-    }
-    return nullptr; 
+    return it != DImplementation->DRouteByNameMap.end() ? &(*DImplementation->DRoutes)[it->second] : nullptr; 
+}
+
+CCSVBusSystem::CRange<CBusSystem::SStop, CCSVBusSystem::SStop> CCSVBusSystem::Stops() const noexcept { 
+    const auto &Stops = *DImplementation->DStops; 
+    return CRange<CBusSystem::SStop, SStop>(Stops.data(), Stops.data() + Stops.size()); 
+}
+
+CCSVBusSystem::CRange<CBusSystem::SRoute, CCSVBusSystem::SRoute> CCSVBusSystem::Routes() const noexcept { 
+    const auto &Routes = *DImplementation->DRoutes; 
+    return CRange<CBusSystem::SRoute, SRoute>(Routes.data(), Routes.data() + Routes.size()); 
 }
 
 //This handles the operator overloading <<
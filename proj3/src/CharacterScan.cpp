@@ -0,0 +1,122 @@
+#include "CharacterScan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CHARACTERSCAN_X86
+#include <immintrin.h>
+#endif
+
+namespace CharacterScan{
+
+const char *FindAnyScalar(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept{
+    for(const char *Current = begin; Current < end; Current++){
+        for(std::size_t Index = 0; Index < setsize; Index++){
+            if(*Current == set[Index]){
+                return Current;
+            }
+        }
+    }
+    return end;
+}
+
+#ifdef CHARACTERSCAN_X86
+
+__attribute__((target("sse2")))
+const char *FindAnySSE2(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept{
+    if(setsize > MaxSetSize){
+        return FindAnyScalar(begin, end, set, setsize);
+    }
+    __m128i Needles[MaxSetSize];
+    for(std::size_t Index = 0; Index < setsize; Index++){
+        Needles[Index] = _mm_set1_epi8(set[Index]);
+    }
+    const char *Current = begin;
+    while(Current + 16 <= end){
+        __m128i Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Current));
+        __m128i Matches = _mm_setzero_si128();
+        for(std::size_t Index = 0; Index < setsize; Index++){
+            Matches = _mm_or_si128(Matches, _mm_cmpeq_epi8(Block, Needles[Index]));
+        }
+        int Mask = _mm_movemask_epi8(Matches);
+        if(Mask){
+            return Current + __builtin_ctz(Mask);
+        }
+        Current += 16;
+    }
+    return FindAnyScalar(Current, end, set, setsize);
+}
+
+__attribute__((target("avx2")))
+const char *FindAnyAVX2(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept{
+    if(setsize > MaxSetSize){
+        return FindAnyScalar(begin, end, set, setsize);
+    }
+    __m256i Needles[MaxSetSize];
+    for(std::size_t Index = 0; Index < setsize; Index++){
+        Needles[Index] = _mm256_set1_epi8(set[Index]);
+    }
+    const char *Current = begin;
+    while(Current + 32 <= end){
+        __m256i Block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Current));
+        __m256i Matches = _mm256_setzero_si256();
+        for(std::size_t Index = 0; Index < setsize; Index++){
+            Matches = _mm256_or_si256(Matches, _mm256_cmpeq_epi8(Block, Needles[Index]));
+        }
+        unsigned int Mask = static_cast<unsigned int>(_mm256_movemask_epi8(Matches));
+        if(Mask){
+            return Current + __builtin_ctz(Mask);
+        }
+        Current += 32;
+    }
+    // the tail goes to legacy SSE code, clear the upper halves first or every
+    // short call pays the AVX to SSE transition penalty
+    _mm256_zeroupper();
+    return FindAnySSE2(Current, end, set, setsize);
+}
+
+bool HasSSE2() noexcept{
+    return __builtin_cpu_supports("sse2");
+}
+
+bool HasAVX2() noexcept{
+    return __builtin_cpu_supports("avx2");
+}
+
+#else
+
+const char *FindAnySSE2(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept{
+    return FindAnyScalar(begin, end, set, setsize);
+}
+
+const char *FindAnyAVX2(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept{
+    return FindAnyScalar(begin, end, set, setsize);
+}
+
+bool HasSSE2() noexcept{
+    return false;
+}
+
+bool HasAVX2() noexcept{
+    return false;
+}
+
+#endif
+
+using TFindAny = const char *(*)(const char *, const char *, const char *, std::size_t) noexcept;
+
+// chosen once on first use depending on what the CPU supports
+static TFindAny SelectFindAny() noexcept{
+    if(HasAVX2()){
+        return FindAnyAVX2;
+    }
+    if(HasSSE2()){
+        return FindAnySSE2;
+    }
+    return FindAnyScalar;
+}
+
+const char *FindAny(const char *begin, const char *end, const char *set, std::size_t setsize) noexcept{
+    static const TFindAny Implementation = SelectFindAny();
+    return Implementation(begin, end, set, setsize);
+}
+
+}
@@ -0,0 +1,626 @@
+#include "ContractionHierarchy.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <tuple>
+
+namespace{
+
+using TVertex = CRoutingGraph::TVertex;
+const TVertex InvalidVertex = CRoutingGraph::InvalidVertex;
+const double NoPathExists = CRoutingGraph::NoPathExists;
+
+// Dijkstra labels invalidated with a generation stamp so a search does not
+// have to clear them, used by the witness searches and both query directions
+struct SSearchLabels{
+    std::vector<double> Distances;
+    std::vector<TVertex> Parents;
+    std::vector<uint32_t> Stamps;
+    uint32_t Stamp = 0;
+    std::vector<std::pair<double, TVertex>> Heap;  // min heap of (distance, vertex), stale entries are skipped
+
+    void Reset(std::size_t vertexcount){
+        if(Stamps.size() < vertexcount){
+            Distances.resize(vertexcount);
+            Parents.resize(vertexcount);
+            Stamps.resize(vertexcount, 0);
+        }
+        if(++Stamp == 0){
+            std::fill(Stamps.begin(), Stamps.end(), 0);
+            Stamp = 1;
+        }
+        Heap.clear();
+    }
+
+    double Distance(TVertex vertex) const{
+        return Stamps[vertex] == Stamp ? Distances[vertex] : NoPathExists;
+    }
+
+    void Label(TVertex vertex, double distance, TVertex parent){
+        Stamps[vertex] = Stamp;
+        Distances[vertex] = distance;
+        Parents[vertex] = parent;
+    }
+
+    void Push(double distance, TVertex vertex){
+        Heap.emplace_back(distance, vertex);
+        std::push_heap(Heap.begin(), Heap.end(), std::greater<std::pair<double, TVertex>>());
+    }
+
+    std::pair<double, TVertex> Pop(){
+        std::pop_heap(Heap.begin(), Heap.end(), std::greater<std::pair<double, TVertex>>());
+        auto Top = Heap.back();
+        Heap.pop_back();
+        return Top;
+    }
+
+    double TopDistance() const{
+        return Heap.empty() ? NoPathExists : Heap.front().first;
+    }
+};
+
+// runs task(threadindex, index) for every index below count
+template <typename TTask>
+void RunParallel(std::size_t threadcount, std::size_t count, TTask task){
+    std::atomic<std::size_t> NextIndex(0);
+    auto Worker = [&](std::size_t threadindex){
+        for(std::size_t Index = NextIndex++; Index < count; Index = NextIndex++){
+            task(threadindex, Index);
+        }
+    };
+    std::vector<std::thread> Threads;
+    for(std::size_t Index = 1; Index < std::min(threadcount, count); Index++){
+        Threads.emplace_back(Worker, Index);
+    }
+    Worker(0);
+    for(auto &Thread : Threads){
+        Thread.join();
+    }
+}
+
+}
+
+struct CContractionHierarchy::CWorkspace::SImplementation{
+    SSearchLabels Forward;
+    SSearchLabels Backward;
+};
+
+CContractionHierarchy::CWorkspace::CWorkspace() : DImplementation(std::make_unique<SImplementation>()){
+}
+
+CContractionHierarchy::CWorkspace::~CWorkspace() = default;
+
+struct CContractionHierarchy::SImplementation{
+    // file layout: header, then every column as a uint64 element count followed
+    // by the elements, each column starting on an 8 byte boundary
+    static constexpr char FileMagic[8] = {'O', 'S', 'M', 'C', 'H', '\0', '\0', '\0'};
+    static constexpr uint32_t FileVersion = 1;
+    static constexpr uint32_t FileByteOrder = 0x01020304;
+    static constexpr std::size_t FileAlignment = 8;
+
+    // witness searches give up after settling this many vertices and add the shortcut
+    static const std::size_t WitnessSettleLimit = 500;
+
+    // upward edges in CSR form, Middles is the contracted vertex a shortcut skips
+    // or InvalidVertex for an edge of the original graph
+    struct SEdgeTable{
+        std::vector<uint32_t> Offsets;
+        std::vector<TVertex> Targets;
+        std::vector<double> Weights;
+        std::vector<TVertex> Middles;
+    };
+
+    std::vector<TNodeID> NodeIDs;  // node ID of each vertex, sorted
+    std::vector<uint32_t> Ranks;  // contraction order of each vertex
+    SEdgeTable Forward;  // v -> w for higher ranked w
+    SEdgeTable Backward;  // w -> v stored at v for higher ranked w
+
+    // calls visitor on every column in file order
+    template <typename TVisitor>
+    void ForEachColumn(TVisitor &&visitor){
+        visitor(NodeIDs);
+        visitor(Ranks);
+        for(auto *Table : {&Forward, &Backward}){
+            visitor(Table->Offsets);
+            visitor(Table->Targets);
+            visitor(Table->Weights);
+            visitor(Table->Middles);
+        }
+    }
+
+    // edge of the graph while it is being contracted
+    struct SEdge{
+        TVertex Target;
+        double Weight;
+        TVertex Middle;
+    };
+
+    // shortcut found while contracting a vertex
+    struct SShortcut{
+        TVertex Source;
+        TVertex Target;
+        double Weight;
+    };
+
+    // state of the preprocessing, Out[v] and In[v] only hold uncontracted neighbours
+    struct SContraction{
+        std::vector<std::vector<SEdge>> Out;
+        std::vector<std::vector<SEdge>> In;  // Target is the source of the edge
+        std::vector<bool> Contracted;
+        std::vector<uint32_t> DeletedNeighbours;
+        std::vector<int64_t> Priorities;
+        std::vector<uint8_t> InRound;  // set for the vertices contracted in the current round
+    };
+
+    // adds the edge or lowers the weight of an existing edge to the same target
+    static void AddEdge(std::vector<SEdge> &edges, const SEdge &edge){
+        for(auto &Existing : edges){
+            if(Existing.Target == edge.Target){
+                if(edge.Weight < Existing.Weight){
+                    Existing = edge;
+                }
+                return;
+            }
+        }
+        edges.push_back(edge);
+    }
+
+    static void RemoveEdge(std::vector<SEdge> &edges, TVertex target){
+        edges.erase(std::remove_if(edges.begin(), edges.end(), [target](const SEdge &edge){
+            return edge.Target == target;
+        }), edges.end());
+    }
+
+    // finds the shortcuts needed to remove vertex, a shortcut u -> w is needed
+    // unless a path avoiding vertex is no longer than u -> vertex -> w. Witnesses
+    // also avoid the rest of the round, those vertices disappear at the same time.
+    static void FindShortcuts(const SContraction &contraction, TVertex vertex, SSearchLabels &labels, std::vector<SShortcut> &shortcuts){
+        shortcuts.clear();
+        const auto &Out = contraction.Out[vertex];
+        for(const auto &Incoming : contraction.In[vertex]){
+            TVertex Source = Incoming.Target;
+            double Limit = -1.0;
+            for(const auto &Outgoing : Out){
+                if(Outgoing.Target != Source){
+                    Limit = std::max(Limit, Incoming.Weight + Outgoing.Weight);
+                }
+            }
+            if(Limit < 0.0){
+                continue;  // no path goes through the vertex from this source
+            }
+            labels.Reset(contraction.Out.size());
+            labels.Label(Source, 0.0, InvalidVertex);
+            labels.Push(0.0, Source);
+            std::size_t Settled = 0;
+            while(!labels.Heap.empty() && (Settled < WitnessSettleLimit)){
+                auto [Distance, Current] = labels.Pop();
+                if(Distance > labels.Distance(Current)){
+                    continue;
+                }
+                if(Distance > Limit){
+                    break;
+                }
+                Settled++;
+                for(const auto &Edge : contraction.Out[Current]){
+                    double TargetDistance = Distance + Edge.Weight;
+                    if((Edge.Target != vertex) && !contraction.InRound[Edge.Target] && (TargetDistance < labels.Distance(Edge.Target))){
+                        labels.Label(Edge.Target, TargetDistance, Current);
+                        labels.Push(TargetDistance, Edge.Target);
+                    }
+                }
+            }
+            for(const auto &Outgoing : Out){
+                double Weight = Incoming.Weight + Outgoing.Weight;
+                if((Outgoing.Target != Source) && (labels.Distance(Outgoing.Target) > Weight)){
+                    shortcuts.push_back({Source, Outgoing.Target, Weight});
+                }
+            }
+        }
+    }
+
+    // lower is contracted earlier, vertices whose removal adds few edges go first
+    static int64_t Priority(const SContraction &contraction, TVertex vertex, std::size_t shortcutcount){
+        int64_t EdgeDifference = static_cast<int64_t>(shortcutcount) - static_cast<int64_t>(contraction.Out[vertex].size() + contraction.In[vertex].size());
+        return EdgeDifference + contraction.DeletedNeighbours[vertex];
+    }
+
+    // true if vertex comes before every uncontracted neighbour, so no two chosen vertices are adjacent
+    static bool LocalMinimum(const SContraction &contraction, TVertex vertex){
+        auto Before = [&](TVertex other){
+            return std::make_pair(contraction.Priorities[vertex], vertex) < std::make_pair(contraction.Priorities[other], other);
+        };
+        for(const auto &Edge : contraction.Out[vertex]){
+            if(!Before(Edge.Target)){
+                return false;
+            }
+        }
+        for(const auto &Edge : contraction.In[vertex]){
+            if(!Before(Edge.Target)){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    SImplementation() = default;
+
+    // contracts the graph in rounds, each round removes an independent set of
+    // vertices whose shortcuts are found in parallel and then applied in order
+    SImplementation(const CRoutingGraph &graph, std::size_t threadcount){
+        std::size_t VertexCount = graph.VertexCount();
+        SContraction Contraction;
+        Contraction.Out.resize(VertexCount);
+        Contraction.In.resize(VertexCount);
+        Contraction.Contracted.assign(VertexCount, false);
+        Contraction.DeletedNeighbours.assign(VertexCount, 0);
+        Contraction.Priorities.assign(VertexCount, 0);
+        Contraction.InRound.assign(VertexCount, 0);
+        for(TVertex Vertex = 0; Vertex < VertexCount; Vertex++){
+            NodeIDs.push_back(graph.NodeIDByVertex(Vertex));
+            for(std::size_t Index = 0; Index < graph.EdgeCount(Vertex); Index++){
+                TVertex Target = graph.EdgeTarget(Vertex, Index);
+                double Weight = graph.EdgeWeight(Vertex, Index);
+                AddEdge(Contraction.Out[Vertex], {Target, Weight, InvalidVertex});
+                AddEdge(Contraction.In[Target], {Vertex, Weight, InvalidVertex});
+            }
+        }
+
+        std::vector<SSearchLabels> Labels(threadcount);
+        std::vector<std::vector<SShortcut>> ThreadShortcuts(threadcount);
+        auto UpdatePriorities = [&](const std::vector<TVertex> &vertices){
+            RunParallel(threadcount, vertices.size(), [&](std::size_t thread, std::size_t index){
+                FindShortcuts(Contraction, vertices[index], Labels[thread], ThreadShortcuts[thread]);
+                Contraction.Priorities[vertices[index]] = Priority(Contraction, vertices[index], ThreadShortcuts[thread].size());
+            });
+        };
+        std::vector<TVertex> Remaining(VertexCount);
+        for(TVertex Vertex = 0; Vertex < VertexCount; Vertex++){
+            Remaining[Vertex] = Vertex;
+        }
+        UpdatePriorities(Remaining);
+
+        Ranks.assign(VertexCount, 0);
+        std::vector<std::vector<SEdge>> UpOut(VertexCount), UpIn(VertexCount);
+        uint32_t NextRank = 0;
+        std::vector<TVertex> Selected, Neighbours;
+        std::vector<std::vector<SShortcut>> Shortcuts;
+        while(!Remaining.empty()){
+            Selected.clear();
+            for(auto Vertex : Remaining){
+                if(LocalMinimum(Contraction, Vertex)){
+                    Selected.push_back(Vertex);
+                }
+            }
+            Shortcuts.resize(Selected.size());
+            for(auto Vertex : Selected){
+                Contraction.InRound[Vertex] = 1;
+            }
+            RunParallel(threadcount, Selected.size(), [&](std::size_t thread, std::size_t index){
+                FindShortcuts(Contraction, Selected[index], Labels[thread], Shortcuts[index]);
+            });
+            for(auto Vertex : Selected){
+                Contraction.InRound[Vertex] = 0;
+            }
+
+            Neighbours.clear();
+            for(std::size_t Index = 0; Index < Selected.size(); Index++){
+                TVertex Vertex = Selected[Index];
+                Ranks[Vertex] = NextRank++;
+                Contraction.Contracted[Vertex] = true;
+                for(const auto &Shortcut : Shortcuts[Index]){
+                    AddEdge(Contraction.Out[Shortcut.Source], {Shortcut.Target, Shortcut.Weight, Vertex});
+                    AddEdge(Contraction.In[Shortcut.Target], {Shortcut.Source, Shortcut.Weight, Vertex});
+                }
+                // everything still attached to the vertex is contracted later, so its edges point upwards
+                for(const auto &Edge : Contraction.Out[Vertex]){
+                    RemoveEdge(Contraction.In[Edge.Target], Vertex);
+                    Contraction.DeletedNeighbours[Edge.Target]++;
+                    Neighbours.push_back(Edge.Target);
+                }
+                for(const auto &Edge : Contraction.In[Vertex]){
+                    RemoveEdge(Contraction.Out[Edge.Target], Vertex);
+                    Contraction.DeletedNeighbours[Edge.Target]++;
+                    Neighbours.push_back(Edge.Target);
+                }
+                UpOut[Vertex] = std::move(Contraction.Out[Vertex]);
+                UpIn[Vertex] = std::move(Contraction.In[Vertex]);
+                std::vector<SEdge>().swap(Contraction.Out[Vertex]);
+                std::vector<SEdge>().swap(Contraction.In[Vertex]);
+            }
+            Remaining.erase(std::remove_if(Remaining.begin(), Remaining.end(), [&](TVertex vertex){
+                return Contraction.Contracted[vertex];
+            }), Remaining.end());
+            std::sort(Neighbours.begin(), Neighbours.end());
+            Neighbours.erase(std::unique(Neighbours.begin(), Neighbours.end()), Neighbours.end());
+            UpdatePriorities(Neighbours);
+        }
+
+        BuildTable(UpOut, Forward);
+        BuildTable(UpIn, Backward);
+    }
+
+    static void BuildTable(const std::vector<std::vector<SEdge>> &edges, SEdgeTable &table){
+        table.Offsets.push_back(0);
+        for(const auto &VertexEdges : edges){
+            for(const auto &Edge : VertexEdges){
+                table.Targets.push_back(Edge.Target);
+                table.Weights.push_back(Edge.Weight);
+                table.Middles.push_back(Edge.Middle);
+            }
+            table.Offsets.push_back(static_cast<uint32_t>(table.Targets.size()));
+        }
+    }
+
+    TVertex FindVertex(TNodeID id) const{
+        auto It = std::lower_bound(NodeIDs.begin(), NodeIDs.end(), id);
+        if((It != NodeIDs.end()) && (*It == id)){
+            return static_cast<TVertex>(It - NodeIDs.begin());
+        }
+        return InvalidVertex;
+    }
+
+    // position of the upward edge source -> target in one of the tables
+    static uint32_t FindEdge(const SEdgeTable &table, TVertex vertex, TVertex target){
+        for(uint32_t Edge = table.Offsets[vertex]; Edge < table.Offsets[vertex + 1]; Edge++){
+            if(table.Targets[Edge] == target){
+                return Edge;
+            }
+        }
+        return table.Offsets[vertex + 1];
+    }
+
+    // appends the original vertices of the edge source -> target after source
+    void Unpack(TVertex source, TVertex target, std::vector<TNodeID> &path) const{
+        const SEdgeTable &Table = Ranks[source] < Ranks[target] ? Forward : Backward;
+        TVertex Lower = Ranks[source] < Ranks[target] ? source : target;
+        uint32_t Edge = FindEdge(Table, Lower, Lower == source ? target : source);
+        // the edge is only missing from a damaged file, which gets the direct step instead
+        TVertex Middle = Edge < Table.Offsets[Lower + 1] ? Table.Middles[Edge] : InvalidVertex;
+        if(Middle == InvalidVertex){
+            path.push_back(NodeIDs[target]);
+        }
+        else{
+            Unpack(source, Middle, path);
+            Unpack(Middle, target, path);
+        }
+    }
+
+    // settles the next vertex of one direction, skipping vertices that can be
+    // reached shorter through a higher ranked vertex (stall on demand)
+    void Step(SSearchLabels &labels, const SSearchLabels &other, const SEdgeTable &edges, const SEdgeTable &reverse, double &best, TVertex &meeting) const{
+        auto [Distance, Vertex] = labels.Pop();
+        if(Distance > labels.Distance(Vertex)){
+            return;
+        }
+        double OtherDistance = other.Distance(Vertex);
+        if((OtherDistance != NoPathExists) && (Distance + OtherDistance < best)){
+            best = Distance + OtherDistance;
+            meeting = Vertex;
+        }
+        for(uint32_t Edge = reverse.Offsets[Vertex]; Edge < reverse.Offsets[Vertex + 1]; Edge++){
+            double Higher = labels.Distance(reverse.Targets[Edge]);
+            if((Higher != NoPathExists) && (Higher + reverse.Weights[Edge] < Distance)){
+                return;
+            }
+        }
+        for(uint32_t Edge = edges.Offsets[Vertex]; Edge < edges.Offsets[Vertex + 1]; Edge++){
+            TVertex Target = edges.Targets[Edge];
+            double TargetDistance = Distance + edges.Weights[Edge];
+            if(TargetDistance < labels.Distance(Target)){
+                labels.Label(Target, TargetDistance, Vertex);
+                labels.Push(TargetDistance, Target);
+            }
+        }
+    }
+
+    // bidirectional upward search, returns the length and the vertex where the directions meet
+    double Search(TNodeID srcid, TNodeID destid, CWorkspace::SImplementation &workspace, TVertex &meeting) const{
+        meeting = InvalidVertex;
+        TVertex Source = FindVertex(srcid);
+        TVertex Destination = FindVertex(destid);
+        if((Source == InvalidVertex) || (Destination == InvalidVertex)){
+            return NoPathExists;
+        }
+        auto &ForwardLabels = workspace.Forward;
+        auto &BackwardLabels = workspace.Backward;
+        ForwardLabels.Reset(NodeIDs.size());
+        BackwardLabels.Reset(NodeIDs.size());
+        ForwardLabels.Label(Source, 0.0, InvalidVertex);
+        ForwardLabels.Push(0.0, Source);
+        BackwardLabels.Label(Destination, 0.0, InvalidVertex);
+        BackwardLabels.Push(0.0, Destination);
+        double Best = NoPathExists;
+        // both directions only go up, so the search ends once neither can improve on the best meeting
+        while(std::min(ForwardLabels.TopDistance(), BackwardLabels.TopDistance()) < Best){
+            if(ForwardLabels.TopDistance() <= BackwardLabels.TopDistance()){
+                Step(ForwardLabels, BackwardLabels, Forward, Backward, Best, meeting);
+            }
+            else{
+                Step(BackwardLabels, ForwardLabels, Backward, Forward, Best, meeting);
+            }
+        }
+        return Best;
+    }
+
+    double FindShortestPath(TNodeID srcid, TNodeID destid, std::vector<TNodeID> &path, CWorkspace::SImplementation &workspace) const{
+        path.clear();
+        TVertex Meeting;
+        double Best = Search(srcid, destid, workspace, Meeting);
+        if(Meeting == InvalidVertex){
+            return NoPathExists;
+        }
+        auto &ForwardLabels = workspace.Forward;
+        auto &BackwardLabels = workspace.Backward;
+        // walk the forward search back to the source, then unpack every edge to the destination
+        std::vector<TVertex> Vertices;
+        for(TVertex Current = Meeting; Current != InvalidVertex; Current = ForwardLabels.Parents[Current]){
+            Vertices.push_back(Current);
+        }
+        std::reverse(Vertices.begin(), Vertices.end());
+        for(TVertex Current = BackwardLabels.Parents[Meeting]; Current != InvalidVertex; Current = BackwardLabels.Parents[Current]){
+            Vertices.push_back(Current);
+        }
+        path.push_back(NodeIDs[Vertices[0]]);
+        for(std::size_t Index = 1; Index < Vertices.size(); Index++){
+            Unpack(Vertices[Index - 1], Vertices[Index], path);
+        }
+        return Best;
+    }
+
+    static CWorkspace::SImplementation &ThreadWorkspace(){
+        thread_local CWorkspace Workspace;
+        return *Workspace.DImplementation;
+    }
+
+    bool Write(CDataSink &sink){
+        std::vector<char> Buffer;
+        auto Append = [&Buffer](const void *data, std::size_t size){
+            const char *Bytes = static_cast<const char *>(data);
+            Buffer.insert(Buffer.end(), Bytes, Bytes + size);
+        };
+        uint32_t Header[2] = {FileVersion, FileByteOrder};
+        Append(FileMagic, sizeof(FileMagic));
+        Append(Header, sizeof(Header));
+        ForEachColumn([&](auto &column){
+            uint64_t Count = column.size();
+            Append(&Count, sizeof(Count));
+            Append(column.data(), column.size() * sizeof(column[0]));
+            Buffer.resize((Buffer.size() + FileAlignment - 1) / FileAlignment * FileAlignment, 0);
+        });
+        return sink.Write(Buffer);
+    }
+
+    bool Load(const char *data, std::size_t size){
+        uint32_t Header[2];
+        if((size < sizeof(FileMagic) + sizeof(Header)) || std::memcmp(data, FileMagic, sizeof(FileMagic))){
+            return false;
+        }
+        std::memcpy(Header, data + sizeof(FileMagic), sizeof(Header));
+        if((Header[0] != FileVersion) || (Header[1] != FileByteOrder)){
+            return false;
+        }
+        std::size_t Offset = sizeof(FileMagic) + sizeof(Header);
+        bool Valid = true;
+        ForEachColumn([&](auto &column){
+            using TElement = typename std::remove_reference_t<decltype(column)>::value_type;
+            uint64_t Count;
+            if(!Valid || (size - Offset < sizeof(Count))){
+                Valid = false;
+                return;
+            }
+            std::memcpy(&Count, data + Offset, sizeof(Count));
+            Offset += sizeof(Count);
+            if(Count > (size - Offset) / sizeof(TElement)){
+                Valid = false;
+                return;
+            }
+            column.resize(Count);
+            std::memcpy(column.data(), data + Offset, Count * sizeof(TElement));
+            Offset += Count * sizeof(TElement);
+            Offset += std::min((FileAlignment - Offset % FileAlignment) % FileAlignment, size - Offset);
+        });
+        return Valid && Validate();
+    }
+
+    // checks every index so a damaged file can not make a query read out of bounds
+    bool Validate() const{
+        std::size_t VertexCount = NodeIDs.size();
+        if(Ranks.size() != VertexCount){
+            return false;
+        }
+        for(auto *Table : {&Forward, &Backward}){
+            if((Table->Offsets.size() != VertexCount + 1) || (Table->Offsets[0] != 0) || (Table->Offsets[VertexCount] != Table->Targets.size())
+                || (Table->Weights.size() != Table->Targets.size()) || (Table->Middles.size() != Table->Targets.size())){
+                return false;
+            }
+            if(!std::is_sorted(Table->Offsets.begin(), Table->Offsets.end())){
+                return false;
+            }
+            for(std::size_t Index = 0; Index < Table->Targets.size(); Index++){
+                if((Table->Targets[Index] >= VertexCount) || ((Table->Middles[Index] != InvalidVertex) && (Table->Middles[Index] >= VertexCount))){
+                    return false;
+                }
+            }
+        }
+        for(TVertex Vertex = 0; Vertex < VertexCount; Vertex++){
+            for(auto *Table : {&Forward, &Backward}){
+                for(uint32_t Edge = Table->Offsets[Vertex]; Edge < Table->Offsets[Vertex + 1]; Edge++){
+                    // edges only point up and shortcuts skip a lower vertex, which keeps unpacking finite
+                    TVertex Middle = Table->Middles[Edge];
+                    if((Ranks[Table->Targets[Edge]] <= Ranks[Vertex]) || ((Middle != InvalidVertex) && (Ranks[Middle] >= Ranks[Vertex]))){
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
+CContractionHierarchy::CContractionHierarchy() : DImplementation(std::make_unique<SImplementation>()){
+}
+
+CContractionHierarchy::CContractionHierarchy(const CRoutingGraph &graph, std::size_t threadcount){
+    if(threadcount == 0){
+        threadcount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    DImplementation = std::make_unique<SImplementation>(graph, threadcount);
+}
+
+CContractionHierarchy::~CContractionHierarchy() = default;
+
+std::size_t CContractionHierarchy::VertexCount() const noexcept{
+    return DImplementation->NodeIDs.size();
+}
+
+std::size_t CContractionHierarchy::EdgeCount() const noexcept{
+    return DImplementation->Forward.Targets.size() + DImplementation->Backward.Targets.size();
+}
+
+double CContractionHierarchy::FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path, CWorkspace &workspace) const{
+    return DImplementation->FindShortestPath(src, dest, path, *workspace.DImplementation);
+}
+
+double CContractionHierarchy::FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path) const{
+    return DImplementation->FindShortestPath(src, dest, path, SImplementation::ThreadWorkspace());
+}
+
+double CContractionHierarchy::FindShortestDistance(TNodeID src, TNodeID dest, CWorkspace &workspace) const{
+    TVertex Meeting;
+    return DImplementation->Search(src, dest, *workspace.DImplementation, Meeting);
+}
+
+double CContractionHierarchy::FindShortestDistance(TNodeID src, TNodeID dest) const{
+    TVertex Meeting;
+    return DImplementation->Search(src, dest, SImplementation::ThreadWorkspace(), Meeting);
+}
+
+bool CContractionHierarchy::Write(std::shared_ptr<CDataSink> sink) const{
+    if(!sink){
+        return false;
+    }
+    return DImplementation->Write(*sink);
+}
+
+std::shared_ptr<CContractionHierarchy> CContractionHierarchy::Load(std::shared_ptr<CDataSource> src){
+    if(!src){
+        return nullptr;
+    }
+    std::vector<char> Contents, Block;
+    const char *Data;
+    std::size_t Size;
+    if(!src->View(Data, Size)){
+        while(src->Read(Block, 1 << 20)){
+            Contents.insert(Contents.end(), Block.begin(), Block.end());
+        }
+        Data = Contents.data();
+        Size = Contents.size();
+    }
+    std::shared_ptr<CContractionHierarchy> Hierarchy(new CContractionHierarchy());
+    if(!Hierarchy->DImplementation->Load(Data, Size)){
+        return nullptr;
+    }
+    return Hierarchy;
+}
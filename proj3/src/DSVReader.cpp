@@ -1,93 +1,224 @@
 #include "DSVReader.h"
+#include "CharacterScan.h"
+#include <cstring>
 #include <sstream>
 #include <iostream>
 
 struct CDSVReader::SImplementation {
+    // location of a cell, plain cells point into the block and cells that
+    // needed unescaping point into the arena
+    struct SCell {
+        bool Escaped;
+        std::size_t Offset;
+        std::size_t Length;
+    };
+
     std::shared_ptr<CDataSource> InputSource;  // holds the input source for reading data
     char Separator;  // the delimiter used to separate values
+    std::size_t ChunkSize;  // bytes read at a time from sources without a view
+    std::vector<char> ReadBuffer;  // reused block for sources without a view
+    std::vector<char> ChunkBuffer;  // reused chunk when a row straddles two blocks
+    bool UsingView;  // true when Data points into the source's view
+    const char *Data;  // current block, either the source view or ReadBuffer
+    std::size_t Position;  // next unread byte in the block
+    std::size_t Size;  // number of bytes in the block
+    std::size_t RowStart;  // start of the current row in the block
+    char Specials[4];  // chars that end a run of plain data outside of quotes
+    std::vector<SCell> Cells;  // cells of the current row, reused between rows
+    std::string Arena;  // unescaped cell contents of the current row
 
-    SImplementation(std::shared_ptr<CDataSource> src, char separator)
-        : InputSource(std::move(src)), Separator(separator) {}
-    
-    // helper function to handle quoted sections
-    bool handleQuotedSection(char ch, std::string &currentCell, bool &insideQuotes) {
-        if (!InputSource->End()) {
-            char nextChar;
-            if (InputSource->Peek(nextChar) && nextChar == '"') {
-                InputSource->Get(nextChar);  // escaped quote
-                currentCell += '"';  // add  quote to the cell
-            } else {
-                insideQuotes = !insideQuotes;  //   quote state
+    SImplementation(std::shared_ptr<CDataSource> src, char separator, std::size_t chunksize)
+        : InputSource(std::move(src)), Separator(separator), ChunkSize(chunksize ? chunksize : 1), UsingView(false),
+          Data(nullptr), Position(0), Size(0), RowStart(0), Specials{'"', separator, '\n', '\r'} {}
+
+    // makes sure there is at least one unread byte in the block, returns false at the end of
+    // the input. The bytes of the current row are kept so its cells stay contiguous.
+    bool FillBuffer() {
+        if (Position < Size) {
+            return true;
+        }
+        const char *ViewData;
+        std::size_t ViewSize;
+        if (InputSource->View(ViewData, ViewSize)) {
+            // the view stays valid for the life of the source, so take all of it at once
+            if (ViewSize == 0) {
+                return false;
+            }
+            UsingView = true;
+            Data = ViewData;
+            Position = RowStart = 0;
+            Size = InputSource->Skip(ViewSize);
+            return Position < Size;
+        }
+        if (UsingView) {
+            return false;
+        }
+        std::size_t Keep = Size - RowStart;
+        if (Keep == 0) {
+            InputSource->Read(ReadBuffer, ChunkSize);
+        } else {
+            // move the partial row to the front and append the next chunk after it
+            std::memmove(ReadBuffer.data(), ReadBuffer.data() + RowStart, Keep);
+            ReadBuffer.resize(Keep);
+            if (InputSource->Read(ChunkBuffer, ChunkSize)) {
+                ReadBuffer.insert(ReadBuffer.end(), ChunkBuffer.begin(), ChunkBuffer.end());
             }
+        }
+        Data = ReadBuffer.data();
+        Position = Keep;
+        Size = ReadBuffer.size();
+        RowStart = 0;
+        return Position < Size;
+    }
+
+    bool PeekChar(char &ch) {
+        if (!FillBuffer()) {
+            return false;
+        }
+        ch = Data[Position];
+        return true;
+    }
+
+    bool AtEnd() const {
+        return (Position >= Size) && InputSource->End();
+    }
+
+    // moves a plain cell into the arena once it turns out to need unescaping
+    void EscapeCell(SCell &cell) {
+        if (!cell.Escaped) {
+            std::size_t Offset = Arena.size();
+            Arena.append(Data + RowStart + cell.Offset, cell.Length);
+            cell.Escaped = true;
+            cell.Offset = Offset;
+        }
+    }
+
+    // adds a run of plain chars to the cell
+    void AppendRun(SCell &cell, std::size_t begin, std::size_t end) {
+        if (cell.Escaped) {
+            Arena.append(Data + begin, end - begin);
+        }
+        cell.Length += end - begin;
+    }
+
+    void StartCell(SCell &cell) {
+        cell.Escaped = false;
+        cell.Offset = Position - RowStart;
+        cell.Length = 0;
+    }
+
+    // helper function to handle quoted sections
+    bool handleQuotedSection(SCell &currentCell, bool &insideQuotes) {
+        EscapeCell(currentCell);
+        char nextChar;
+        if (PeekChar(nextChar) && nextChar == '"') {
+            Position++;  // escaped quote
+            Arena += '"';  // add  quote to the cell
+            currentCell.Length++;
         } else {
-            insideQuotes = !insideQuotes;  //  quote state at EOF
+            insideQuotes = !insideQuotes;  //   quote state, also at EOF
         }
         return true;
     }
 
     // helper function to handle end of row
-    bool handleEndOfRow(char ch, std::vector<std::string> &row, std::string &currentCell) {
-        if (!currentCell.empty() || !row.empty()) {
-            row.push_back(currentCell);  // add  last cell to the row
+    bool handleEndOfRow(char ch, SCell &currentCell) {
+        if (currentCell.Length || !Cells.empty()) {
+            Cells.push_back(currentCell);  // add  last cell to the row
         }
         // handle  \r\n line endings
-        if (ch == '\r' && !InputSource->End()) {
-            char nextChar;
-            if (InputSource->Peek(nextChar) && nextChar == '\n') {
-                InputSource->Get(nextChar);  // consume the '\n'
-            }
+        char nextChar;
+        if (ch == '\r' && PeekChar(nextChar) && nextChar == '\n') {
+            Position++;  // consume the '\n'
         }
         return true;
     }
 
-    // reads a row from the input source
-    bool fetchRow(std::vector<std::string> &row) {
-        row.clear();  // clear the row to start fresh
-        
-        std::string currentCell;  // holds the curr cell being read
-        char ch;  // current char being processed
+    // reads a row from the input source into Cells, runs of plain chars are
+    // found with a vectorized scan and are only copied if the cell has quotes
+    bool fetchRow() {
+        Cells.clear();  // clear the row to start fresh
+        Arena.clear();
+        RowStart = Position;
+
+        SCell currentCell;  // holds the curr cell being read
+        StartCell(currentCell);
         bool insideQuotes = false;  // tracks if we r inside a quoted section
         bool hasData = false;  // tracks if we read any data
-        
-        while (!InputSource->End()) {
-            if (!InputSource->Get(ch)) return false;  // read the next character
+
+        while (FillBuffer()) {
             hasData = true;  // mark that we've read data
-            
+
+            // inside quotes only another quote is special
+            const char *Special = CharacterScan::FindAny(Data + Position, Data + Size, Specials, insideQuotes ? 1 : 4);
+            std::size_t SpecialPosition = Special - Data;
+            AppendRun(currentCell, Position, SpecialPosition);
+            Position = SpecialPosition;
+            if (Position == Size) {
+                continue;  // block exhausted, read the next one
+            }
+            char ch = Data[Position];  // current char being processed
+            Position++;
+
             if (ch == '"') {
-                if (!handleQuotedSection(ch, currentCell, insideQuotes)) {
+                if (!handleQuotedSection(currentCell, insideQuotes)) {
                     return false;  // handle quoted sections
                 }
-            } else if (ch == Separator && !insideQuotes) {
-                row.push_back(currentCell);  // end of cell, add to row
-                currentCell.clear();  // clear the cell for the next value
-            } else if ((ch == '\n' || ch == '\r') && !insideQuotes) {
-                if (!handleEndOfRow(ch, row, currentCell)) {
-                    return false;  // handle end of row
-                }
-                return true;  // row is complete
+            } else if (ch == Separator) {
+                Cells.push_back(currentCell);  // end of cell, add to row
+                StartCell(currentCell);  // clear the cell for the next value
             } else {
-                currentCell += ch;  // add the char to the curr cell
+                return handleEndOfRow(ch, currentCell);  // row is complete
             }
         }
-        
+
         // add the last cell if there was any data
-        if (!currentCell.empty() || hasData) {
-            row.push_back(currentCell);
+        if (currentCell.Length || hasData) {
+            Cells.push_back(currentCell);
         }
-        
+
         return hasData;  // return true if data was read
     }
+
+    std::string_view CellView(const SCell &cell) const {
+        if (cell.Escaped) {
+            return std::string_view(Arena.data() + cell.Offset, cell.Length);
+        }
+        return std::string_view(Data + RowStart + cell.Offset, cell.Length);
+    }
 };
 
-CDSVReader::CDSVReader(std::shared_ptr<CDataSource> src, char separator)
-    : DImplementation(std::make_unique<SImplementation>(src, separator)) {}
+CDSVReader::CDSVReader(std::shared_ptr<CDataSource> src, char separator, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>(src, separator, chunksize)) {}
 
 CDSVReader::~CDSVReader() = default;
 
 bool CDSVReader::End() const {
-    return DImplementation->InputSource->End();  // check if  at  end of the input
+    return DImplementation->AtEnd();  // check if  at  end of the input
 }
 
 bool CDSVReader::ReadRow(std::vector<std::string> &row) {
-    return DImplementation->fetchRow(row);  // fetch the next row
+    if (!DImplementation->fetchRow()) {  // fetch the next row
+        row.clear();
+        return false;
+    }
+    // assign into the existing strings so their capacity is reused
+    row.resize(DImplementation->Cells.size());
+    for (std::size_t Index = 0; Index < row.size(); Index++) {
+        auto Cell = DImplementation->CellView(DImplementation->Cells[Index]);
+        row[Index].assign(Cell.data(), Cell.size());
+    }
+    return true;
 }
+
+bool CDSVReader::ReadRowView(std::vector<std::string_view> &row) {
+    row.clear();
+    if (!DImplementation->fetchRow()) {  // fetch the next row
+        return false;
+    }
+    for (const auto &Cell : DImplementation->Cells) {
+        row.push_back(DImplementation->CellView(Cell));
+    }
+    return true;
+}
+
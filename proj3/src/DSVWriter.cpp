@@ -1,7 +1,7 @@
 
 #include "DSVWriter.h"
-#include <sstream>
-#include <iostream>
+#include "CharacterScan.h"
+#include <cstring>
 #include <vector>
 
 // internal struct for managing writer state
@@ -9,67 +9,119 @@ struct CDSVWriter::SImplementation {
     std::shared_ptr<CDataSink> sink; // where data will be written
     char delimiter;  // char used to separate values
     bool quoteall;   // whether to always quote values
+    char specials[4]; // characters that force a value to be quoted
+    std::vector<char> buffer; // rows are built here, it keeps its capacity between rows
+    std::size_t fields = 0; // fields in the row being built
+
+    static const std::size_t BlockSize = 64 * 1024; // WriteRows hands rows to the sink in blocks about this big
 
     // constructor initializes the sink, delimiter, and quoting option
     SImplementation(std::shared_ptr<CDataSink> s, char d, bool q)
-        : sink(s), delimiter(d), quoteall(q) {}
-};
-
-
-CDSVWriter::CDSVWriter(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall) // constructor
-    : DImplementation(std::make_unique<SImplementation>(sink, delimiter, quoteall)) {}
-
+        : sink(s), delimiter(d), quoteall(q), specials{d, '"', '\n', '\r'} {}
 
-CDSVWriter::~CDSVWriter() = default; // destructor
-
-// checks if a value needs to be quoted and escapes it if necessary
-std::string EscapeAndQuote(const std::string &value, char delimiter, bool quoteall) {
-    // determine if the value needs to be wrapped in quotes
-    bool needs_quotes = quoteall || value.find(delimiter) != std::string::npos ||
-                        value.find('"') != std::string::npos || value.find('\n') != std::string::npos;
+    // finds the first character that needs quoting, short values are checked
+    // a byte at a time since setting up the vector search would cost more
+    const char *FindSpecial(const char *begin, const char *end) const {
+        if (end - begin >= 32) {
+            return CharacterScan::FindAny(begin, end, specials, sizeof(specials));
+        }
+        while ((begin < end) && (*begin != delimiter) && (*begin != '"') && (*begin != '\n') && (*begin != '\r')) {
+            begin++;
+        }
+        return begin;
+    }
 
-    if (!needs_quotes) {
-        return value; // ret same if no special characters are found
+    // adds a value to the row, quoting it and doubling its quotes if needed
+    void AppendField(std::string_view value) {
+        if (fields++ > 0) {
+            buffer.push_back(delimiter); // add delimiter between values
+        }
+        const char *Current = value.data();
+        const char *End = Current + value.size();
+        if (!quoteall && (FindSpecial(Current, End) == End)) {
+            buffer.insert(buffer.end(), Current, End); // nothing special, copy as is
+            return;
+        }
+        buffer.push_back('"');  // start with an opening quote
+        while (true) {
+            const char *Quote = static_cast<const char *>(std::memchr(Current, '"', End - Current));
+            if (Quote == nullptr) {
+                buffer.insert(buffer.end(), Current, End);
+                break;
+            }
+            buffer.insert(buffer.end(), Current, Quote + 1);
+            buffer.push_back('"');  // escape double quotes by doubling them
+            Current = Quote + 1;
+        }
+        buffer.push_back('"');  // end with closing quote
     }
 
-    std::ostringstream escaped_value;
-    escaped_value << '"';  // start with an opening quote
+    // finishes the row being built
+    void AppendRowEnd() {
+        buffer.push_back('\n'); // add newline at the end of row
+        fields = 0;
+    }
 
-    // go thru each char in the value
-    for (char c : value) {
-        if (c == '"') {
-            escaped_value << "\"\"";  // escape double quotes by doubling them
-        } else {
-            escaped_value << c;  // add normal chars as they are
+    // hands the buffered rows to the sink
+    bool FlushBuffer() {
+        if (buffer.empty()) {
+            return true;
         }
+        bool Success = sink->Write(buffer);
+        buffer.clear();
+        return Success;
     }
+};
 
-    escaped_value << '"';  // end with closing quote
-    return escaped_value.str();
-}
+
+CDSVWriter::CDSVWriter(std::shared_ptr<CDataSink> sink, char delimiter, bool quoteall) // constructor
+    : DImplementation(std::make_unique<SImplementation>(sink, delimiter, quoteall)) {}
+
+
+CDSVWriter::~CDSVWriter() = default; // destructor
 
 // writes a row to the data sink
 bool CDSVWriter::WriteRow(const std::vector<std::string> &row) {
     if (!DImplementation->sink) {
         return false; // cant write if there's no valid sink!!
     }
+    for (auto &Value : row) {
+        DImplementation->AppendField(Value);
+    }
+    return EndRow();
+}
 
-    std::ostringstream row_stream;
-
-    // iterate over each field in the row
-    for (size_t i = 0; i < row.size(); ++i) {
-        if (i > 0) {
-            row_stream << DImplementation->delimiter; // add delimiter between values
+// writes many rows, flushing whenever a block worth of them is buffered
+bool CDSVWriter::WriteRows(const std::vector<std::vector<std::string>> &rows) {
+    if (!DImplementation->sink) {
+        return false;
+    }
+    for (auto &Row : rows) {
+        for (auto &Value : Row) {
+            DImplementation->AppendField(Value);
+        }
+        DImplementation->AppendRowEnd();
+        if ((DImplementation->buffer.size() >= SImplementation::BlockSize) && !DImplementation->FlushBuffer()) {
+            return false;
         }
-        // escape and quote each field as needed before adding it to the stream
-        row_stream << EscapeAndQuote(row[i], DImplementation->delimiter, DImplementation->quoteall);
     }
+    return DImplementation->FlushBuffer();
+}
 
-    row_stream << '\n'; // add newline at the end of row
-
-    
-    std::string row_str = row_stream.str(); // convert the constructed row string to vector<char> before writing
-    std::vector<char> row_data(row_str.begin(), row_str.end());
+// adds one field to the row being built
+bool CDSVWriter::WriteField(std::string_view field) {
+    if (!DImplementation->sink) {
+        return false;
+    }
+    DImplementation->AppendField(field);
+    return true;
+}
 
-    return DImplementation->sink->Write(row_data); // write to the sink ; return success status
-}
\ No newline at end of file
+// ends the row being built and writes it to the sink
+bool CDSVWriter::EndRow() {
+    if (!DImplementation->sink) {
+        return false;
+    }
+    DImplementation->AppendRowEnd();
+    return DImplementation->FlushBuffer(); // write to the sink ; return success status
+}
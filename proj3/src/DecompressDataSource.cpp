@@ -0,0 +1,240 @@
+#include "DecompressDataSource.h"
+#include <zlib.h>
+#include <bzlib.h>
+#include <algorithm>
+#include <climits>
+
+struct CDecompressDataSource::SImplementation{
+    std::shared_ptr<CDataSource> Source;
+    EFormat Format;
+    std::size_t BufferSize;
+    std::vector<char> Input;  // compressed bytes read from the source
+    std::size_t InputOffset = 0;  // first byte of Input not yet given to the decoder
+    bool InputEnd = false;  // the source has no more bytes
+    std::vector<char> Output;  // decoded bytes waiting for the consumer
+    std::size_t OutputStart = 0;
+    std::size_t OutputEnd = 0;
+    bool StreamActive = false;  // a decoder was set up and has not finished its stream
+    bool Finished = false;  // nothing more will be decoded
+    bool Failed = false;
+    z_stream ZStream;
+    bz_stream BZStream;
+
+    SImplementation(std::shared_ptr<CDataSource> source, EFormat format, std::size_t buffersize)
+        : Source(std::move(source)), Format(format), BufferSize(buffersize ? buffersize : 1), Output(BufferSize){
+        if(!Source){
+            Finished = true;
+        }
+    }
+
+    ~SImplementation(){
+        EndStream();
+    }
+
+    // Makes sure there is unused input, returns false at the end of the source
+    bool FillInput(){
+        if(InputOffset < Input.size()){
+            return true;
+        }
+        InputOffset = 0;
+        if(InputEnd || !Source->Read(Input, BufferSize)){
+            Input.clear();
+            InputEnd = true;
+            return false;
+        }
+        return true;
+    }
+
+    // Picks the format from the magic bytes of the first block
+    void DetectFormat(){
+        if(Format != EFormat::Auto){
+            return;
+        }
+        FillInput();
+        std::size_t Available = Input.size() - InputOffset;
+        const char *Data = Input.data() + InputOffset;
+        if((Available >= 2) && (static_cast<unsigned char>(Data[0]) == 0x1f) && (static_cast<unsigned char>(Data[1]) == 0x8b)){
+            Format = EFormat::Gzip;
+        }
+        else if((Available >= 3) && (Data[0] == 'B') && (Data[1] == 'Z') && (Data[2] == 'h')){
+            Format = EFormat::BZip2;
+        }
+        else{
+            Format = EFormat::None;
+        }
+    }
+
+    bool BeginStream(){
+        if(Format == EFormat::Gzip){
+            ZStream = z_stream();
+            // 15 + 32 accepts gzip as well as zlib headers
+            StreamActive = inflateInit2(&ZStream, 15 + 32) == Z_OK;
+        }
+        else{
+            BZStream = bz_stream();
+            StreamActive = BZ2_bzDecompressInit(&BZStream, 0, 0) == BZ_OK;
+        }
+        return StreamActive;
+    }
+
+    void EndStream(){
+        if(StreamActive){
+            if(Format == EFormat::Gzip){
+                inflateEnd(&ZStream);
+            }
+            else{
+                BZ2_bzDecompressEnd(&BZStream);
+            }
+            StreamActive = false;
+        }
+    }
+
+    // Runs the decoder over the pending input into the output buffer. Returns
+    // the number of bytes produced and sets streamend when a stream finished.
+    std::size_t Decode(bool &streamend){
+        // both libraries count in 32 bit unsigned, so one call takes at most UINT_MAX bytes each way
+        std::size_t InputLength = std::min<std::size_t>(Input.size() - InputOffset, UINT_MAX);
+        std::size_t OutputLength = std::min<std::size_t>(Output.size(), UINT_MAX);
+        std::size_t Produced;
+        std::size_t Consumed;
+        if(Format == EFormat::Gzip){
+            ZStream.next_in = reinterpret_cast<Bytef *>(Input.data() + InputOffset);
+            ZStream.avail_in = static_cast<unsigned int>(InputLength);
+            ZStream.next_out = reinterpret_cast<Bytef *>(Output.data());
+            ZStream.avail_out = static_cast<unsigned int>(OutputLength);
+            int Result = inflate(&ZStream, Z_NO_FLUSH);
+            Consumed = InputLength - ZStream.avail_in;
+            Produced = OutputLength - ZStream.avail_out;
+            streamend = Result == Z_STREAM_END;
+            // Z_BUF_ERROR only means no progress was possible, the check below handles that
+            if((Result != Z_OK) && (Result != Z_BUF_ERROR) && !streamend){
+                Failed = true;
+            }
+        }
+        else{
+            BZStream.next_in = Input.data() + InputOffset;
+            BZStream.avail_in = static_cast<unsigned int>(InputLength);
+            BZStream.next_out = Output.data();
+            BZStream.avail_out = static_cast<unsigned int>(OutputLength);
+            int Result = BZ2_bzDecompress(&BZStream);
+            Consumed = InputLength - BZStream.avail_in;
+            Produced = OutputLength - BZStream.avail_out;
+            streamend = Result == BZ_STREAM_END;
+            if((Result != BZ_OK) && !streamend){
+                Failed = true;
+            }
+        }
+        InputOffset += Consumed;
+        if(!Failed && !streamend && !Produced && !Consumed){
+            Failed = true;  // the decoder is stuck, the data cannot be valid
+        }
+        return Produced;
+    }
+
+    // Refills the empty output buffer, returns false once everything was decoded
+    bool FillOutput(){
+        OutputStart = OutputEnd = 0;
+        while(!Finished){
+            DetectFormat();
+            bool HaveInput = FillInput();
+            if(Format == EFormat::None){
+                if(!HaveInput){
+                    Finished = true;
+                    break;
+                }
+                // plain data passes straight through, the two buffers trade places
+                std::swap(Input, Output);
+                OutputStart = InputOffset;
+                OutputEnd = Output.size();
+                InputOffset = Input.size();
+                return true;
+            }
+            if(!StreamActive){
+                // another stream only starts if there are bytes left for it
+                if(!HaveInput){
+                    Finished = true;
+                    break;
+                }
+                if(!BeginStream()){
+                    Failed = Finished = true;
+                    break;
+                }
+            }
+            // without new input the decoder may still hold output, it fails if it is stuck
+            bool StreamEnd = false;
+            OutputEnd = Decode(StreamEnd);
+            if(StreamEnd){
+                EndStream();
+            }
+            if(Failed){
+                Finished = true;
+                return OutputEnd > 0;
+            }
+            if(OutputEnd > 0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Makes sure there are decoded bytes, returns false at the end
+    bool Acquire(){
+        return (OutputStart < OutputEnd) || FillOutput();
+    }
+};
+
+CDecompressDataSource::CDecompressDataSource(std::shared_ptr<CDataSource> source, EFormat format, std::size_t buffersize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(source), format, buffersize)){
+}
+
+CDecompressDataSource::~CDecompressDataSource() = default;
+
+CDecompressDataSource::EFormat CDecompressDataSource::Format() const noexcept{
+    return DImplementation->Format;
+}
+
+bool CDecompressDataSource::Failed() const noexcept{
+    return DImplementation->Failed;
+}
+
+// Decoding ahead changes no visible state, so End stays const
+bool CDecompressDataSource::End() const noexcept{
+    return !DImplementation->Acquire();
+}
+
+bool CDecompressDataSource::Get(char &ch) noexcept{
+    if(!DImplementation->Acquire()){
+        return false;
+    }
+    ch = DImplementation->Output[DImplementation->OutputStart++];
+    return true;
+}
+
+bool CDecompressDataSource::Peek(char &ch) noexcept{
+    if(!DImplementation->Acquire()){
+        return false;
+    }
+    ch = DImplementation->Output[DImplementation->OutputStart];
+    return true;
+}
+
+bool CDecompressDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while((buf.size() < count) && DImplementation->Acquire()){
+        std::size_t Length = std::min(count - buf.size(), DImplementation->OutputEnd - DImplementation->OutputStart);
+        auto Begin = DImplementation->Output.begin() + DImplementation->OutputStart;
+        buf.insert(buf.end(), Begin, Begin + Length);
+        DImplementation->OutputStart += Length;
+    }
+    return !buf.empty();
+}
+
+std::size_t CDecompressDataSource::Skip(std::size_t count) noexcept{
+    std::size_t Skipped = 0;
+    while((Skipped < count) && DImplementation->Acquire()){
+        std::size_t Length = std::min(count - Skipped, DImplementation->OutputEnd - DImplementation->OutputStart);
+        DImplementation->OutputStart += Length;
+        Skipped += Length;
+    }
+    return Skipped;
+}
@@ -0,0 +1,92 @@
+#include "FileDataSink.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+CFileDataSink::CFileDataSink(const std::string &filename, std::size_t buffersize) : DUsed(0){
+    DBufferSize = std::max<std::size_t>(1, (buffersize + Alignment - 1) / Alignment) * Alignment;
+    DBuffer = static_cast<char *>(std::aligned_alloc(Alignment, DBufferSize));
+    DFileDescriptor = DBuffer ? open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644) : -1;
+    if(DFileDescriptor < 0){
+        DUsed = DBufferSize;  // keeps Put on its slow path so it reports the failure
+    }
+}
+
+CFileDataSink::~CFileDataSink(){
+    if(DFileDescriptor >= 0){
+        Flush();
+        close(DFileDescriptor);
+    }
+    std::free(DBuffer);
+}
+
+bool CFileDataSink::Valid() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+// Writes all of data, retrying short writes
+bool CFileDataSink::WriteOut(const char *data, std::size_t length) noexcept{
+    if(DFileDescriptor < 0){
+        return false;
+    }
+    while(length){
+        ssize_t Written = write(DFileDescriptor, data, length);
+        if(Written < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return false;
+        }
+        data += Written;
+        length -= Written;
+    }
+    return true;
+}
+
+bool CFileDataSink::Flush() noexcept{
+    if(DFileDescriptor < 0){
+        return false;
+    }
+    // the buffer is emptied even on failure so a broken file does not wedge the sink
+    bool Success = WriteOut(DBuffer, DUsed);
+    DUsed = 0;
+    return Success;
+}
+
+bool CFileDataSink::Write(const std::vector<char> &buf) noexcept{
+    return Write(buf.data(), buf.size());
+}
+
+bool CFileDataSink::Write(const char *data, std::size_t length) noexcept{
+    if(DFileDescriptor < 0){
+        return false;
+    }
+    if(DUsed + length <= DBufferSize){
+        std::memcpy(DBuffer + DUsed, data, length);
+        DUsed += length;
+        return true;
+    }
+    // top up the buffer so writes stay block sized, then write large blocks directly
+    std::size_t Length = DBufferSize - DUsed;
+    std::memcpy(DBuffer + DUsed, data, Length);
+    DUsed = DBufferSize;
+    if(!Flush()){
+        return false;
+    }
+    data += Length;
+    length -= Length;
+    if(length >= DBufferSize){
+        std::size_t Direct = (length / DBufferSize) * DBufferSize;
+        if(!WriteOut(data, Direct)){
+            return false;
+        }
+        data += Direct;
+        length -= Direct;
+    }
+    std::memcpy(DBuffer, data, length);
+    DUsed = length;
+    return true;
+}
@@ -0,0 +1,87 @@
+#include "FileDataSource.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+CFileDataSource::CFileDataSource(const std::string &filename, std::size_t buffersize) : DStart(0), DEnd(0), DFileEnd(false){
+    DBufferSize = std::max<std::size_t>(1, (buffersize + Alignment - 1) / Alignment) * Alignment;
+    DBuffer = static_cast<char *>(std::aligned_alloc(Alignment, DBufferSize));
+    DFileDescriptor = DBuffer ? open(filename.c_str(), O_RDONLY) : -1;
+    if(DFileDescriptor < 0){
+        DFileEnd = true;
+        return;
+    }
+    // the whole file is read front to back, so the kernel can read ahead aggressively
+    posix_fadvise(DFileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+CFileDataSource::~CFileDataSource(){
+    if(DFileDescriptor >= 0){
+        close(DFileDescriptor);
+    }
+    std::free(DBuffer);
+}
+
+bool CFileDataSource::Valid() const noexcept{
+    return DFileDescriptor >= 0;
+}
+
+// Refills the empty buffer, returns false at the end of the file or on an error
+bool CFileDataSource::Fill() const noexcept{
+    DStart = DEnd = 0;
+    while(!DFileEnd){
+        ssize_t Length = read(DFileDescriptor, DBuffer, DBufferSize);
+        if(Length > 0){
+            DEnd = Length;
+            return true;
+        }
+        if((Length < 0) && (errno == EINTR)){
+            continue;
+        }
+        DFileEnd = true;
+    }
+    return false;
+}
+
+bool CFileDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    try{
+        buf.reserve(count);
+    }
+    catch(...){
+        return false;
+    }
+    while(buf.size() < count){
+        if((DStart == DEnd) && !Fill()){
+            break;
+        }
+        std::size_t Length = std::min(count - buf.size(), DEnd - DStart);
+        buf.insert(buf.end(), DBuffer + DStart, DBuffer + DStart + Length);
+        DStart += Length;
+    }
+    return !buf.empty();
+}
+
+std::size_t CFileDataSource::Skip(std::size_t count) noexcept{
+    std::size_t Skipped = std::min(count, DEnd - DStart);
+    DStart += Skipped;
+    if((Skipped < count) && !DFileEnd){
+        // whole buffers worth are skipped by seeking instead of reading them
+        off_t Current = lseek(DFileDescriptor, 0, SEEK_CUR);
+        off_t Size = lseek(DFileDescriptor, 0, SEEK_END);
+        if((Current >= 0) && (Size >= Current)){
+            std::size_t Seek = std::min<std::size_t>(((count - Skipped) / DBufferSize) * DBufferSize, Size - Current);
+            lseek(DFileDescriptor, Current + Seek, SEEK_SET);
+            Skipped += Seek;
+        }
+        while((Skipped < count) && Fill()){
+            std::size_t Length = std::min(count - Skipped, DEnd);
+            DStart = Length;
+            Skipped += Length;
+        }
+    }
+    return Skipped;
+}
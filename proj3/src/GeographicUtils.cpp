@@ -0,0 +1,49 @@
+#include "GeographicUtils.h"
+#include <algorithm>
+#include <cmath>
+
+namespace GeographicUtils{
+
+double DegreesToRadians(double degrees) noexcept{
+    return degrees * M_PI / 180.0;
+}
+
+double RadiansToDegrees(double radians) noexcept{
+    return radians * 180.0 / M_PI;
+}
+
+double HaversineDistance(const CStreetMap::TLocation &src, const CStreetMap::TLocation &dest) noexcept{
+    double SrcLatitude = DegreesToRadians(src.first);
+    double DestLatitude = DegreesToRadians(dest.first);
+    double LatitudeDelta = DestLatitude - SrcLatitude;
+    double LongitudeDelta = DegreesToRadians(dest.second - src.second);
+    double SinLatitude = std::sin(LatitudeDelta / 2.0);
+    double SinLongitude = std::sin(LongitudeDelta / 2.0);
+    double Haversine = SinLatitude * SinLatitude + std::cos(SrcLatitude) * std::cos(DestLatitude) * SinLongitude * SinLongitude;
+    return 2.0 * EarthRadiusMeters * std::asin(std::sqrt(std::min(1.0, Haversine)));
+}
+
+double BoxDistance(const CStreetMap::TLocation &location, const CStreetMap::TLocation &lowerleft, const CStreetMap::TLocation &upperright) noexcept{
+    double Latitude = std::clamp(location.first, lowerleft.first, upperright.first);
+    // angular distance to the box in longitude, taking the shorter way around
+    auto LongitudeDelta = [&location](double longitude){
+        double Delta = std::fmod(std::fabs(location.second - longitude), 360.0);
+        return Delta > 180.0 ? 360.0 - Delta : Delta;
+    };
+    if((lowerleft.second <= location.second) && (location.second <= upperright.second)){
+        // straight north or south of the box, the closest point is on the same meridian
+        return HaversineDistance(location, CStreetMap::TLocation(Latitude, location.second));
+    }
+    // otherwise the closest point is on the nearer side edge, but not at the same
+    // latitude since great circles bend towards the poles
+    double Longitude = LongitudeDelta(lowerleft.second) <= LongitudeDelta(upperright.second) ? lowerleft.second : upperright.second;
+    double LocationLatitude = DegreesToRadians(location.first);
+    double Closest = RadiansToDegrees(std::atan2(std::sin(LocationLatitude), std::cos(LocationLatitude) * std::cos(DegreesToRadians(LongitudeDelta(Longitude)))));
+    if((lowerleft.first <= Closest) && (Closest <= upperright.first)){
+        return HaversineDistance(location, CStreetMap::TLocation(Closest, Longitude));
+    }
+    return std::min(HaversineDistance(location, CStreetMap::TLocation(lowerleft.first, Longitude)),
+                    HaversineDistance(location, CStreetMap::TLocation(upperright.first, Longitude)));
+}
+
+}
@@ -0,0 +1,79 @@
+#include "MMapDataSource.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+// Invalid or unreadable files behave like an empty source
+CMMapDataSource::CMMapDataSource(const std::string &filename) : DData(nullptr), DSize(0), DIndex(0){
+    int FileDescriptor = open(filename.c_str(), O_RDONLY);
+    if(FileDescriptor < 0){
+        return;
+    }
+    struct stat FileStat;
+    if((fstat(FileDescriptor, &FileStat) == 0) && (FileStat.st_size > 0)){
+        void *Mapping = mmap(nullptr, FileStat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+        if(Mapping != MAP_FAILED){
+            madvise(Mapping, FileStat.st_size, MADV_SEQUENTIAL);
+            DData = static_cast<const char *>(Mapping);
+            DSize = FileStat.st_size;
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(FileDescriptor);
+}
+
+CMMapDataSource::~CMMapDataSource(){
+    if(DData){
+        munmap(const_cast<char *>(DData), DSize);
+    }
+}
+
+bool CMMapDataSource::Valid() const noexcept{
+    return DData != nullptr;
+}
+
+std::size_t CMMapDataSource::Size() const noexcept{
+    return DSize;
+}
+
+bool CMMapDataSource::End() const noexcept{
+    return DIndex >= DSize;
+}
+
+bool CMMapDataSource::Get(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        DIndex++;
+        return true;
+    }
+    return false;
+}
+
+bool CMMapDataSource::Peek(char &ch) noexcept{
+    if(DIndex < DSize){
+        ch = DData[DIndex];
+        return true;
+    }
+    return false;
+}
+
+bool CMMapDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    std::size_t Length = std::min(count, DSize - DIndex);
+    buf.assign(DData + DIndex, DData + DIndex + Length);
+    DIndex += Length;
+    return !buf.empty();
+}
+
+bool CMMapDataSource::View(const char *&data, std::size_t &size) const noexcept{
+    data = DData + DIndex;
+    size = DSize - DIndex;
+    return true;
+}
+
+std::size_t CMMapDataSource::Skip(std::size_t count) noexcept{
+    std::size_t Length = std::min(count, DSize - DIndex);
+    DIndex += Length;
+    return Length;
+}
@@ -0,0 +1,249 @@
+#include "OSMStream.h"
+#include <cstdlib>
+#include <cstring>
+
+struct COSMStream::SImplementation{
+    // Forwards the parser events of Visit to the element decoder
+    struct SVisitHandler : public CXMLReader::SHandler{
+        SImplementation &Implementation;
+        SVisitor &Visitor;
+
+        SVisitHandler(SImplementation &implementation, SVisitor &visitor) : Implementation(implementation), Visitor(visitor){}
+
+        void StartElement(const char *name, const char **attributes) override{
+            Implementation.StartElement(name, attributes);
+        }
+
+        void EndElement(const char *name) override{
+            switch(Implementation.EndElement(name)){
+                case EElement::Node:    Visitor.Node(Implementation.Node);
+                                        break;
+                case EElement::Way:     Visitor.Way(Implementation.Way);
+                                        break;
+                default:                break;
+            }
+        }
+    };
+
+    std::shared_ptr< CXMLReader > Reader;
+    SNode Node;
+    SWay Way;
+    EElement Open = EElement::None;  // element whose end tag has not been seen yet
+    SXMLEntity Entity;  // reused by the pull interface
+    std::vector< const char * > Attributes;  // Entity's attributes in the parser's layout
+
+    SImplementation(std::shared_ptr< CXMLReader > src) : Reader(std::move(src)){
+        Reader->SetElementFilter({"node", "way", "nd", "tag"});
+    }
+
+    void StartElement(const char *name, const char **attributes){
+        if(std::strcmp(name, "node") == 0){
+            Open = EElement::Node;
+            Node.DID = 0;
+            Node.DLocation = CStreetMap::TLocation(0.0, 0.0);
+            Node.DAttributes.Clear();
+            for(int Index = 0; attributes[Index]; Index += 2){
+                if(std::strcmp(attributes[Index], "id") == 0){
+                    Node.DID = std::strtoull(attributes[Index + 1], nullptr, 10);
+                }
+                else if(std::strcmp(attributes[Index], "lat") == 0){
+                    Node.DLocation.first = std::strtod(attributes[Index + 1], nullptr);
+                }
+                else if(std::strcmp(attributes[Index], "lon") == 0){
+                    Node.DLocation.second = std::strtod(attributes[Index + 1], nullptr);
+                }
+                else{
+                    Node.DAttributes.Set(attributes[Index], attributes[Index + 1]);
+                }
+            }
+        }
+        else if(std::strcmp(name, "way") == 0){
+            Open = EElement::Way;
+            Way.DID = 0;
+            Way.DNodeIDs.clear();
+            Way.DAttributes.Clear();
+            for(int Index = 0; attributes[Index]; Index += 2){
+                if(std::strcmp(attributes[Index], "id") == 0){
+                    Way.DID = std::strtoull(attributes[Index + 1], nullptr, 10);
+                }
+                else{
+                    Way.DAttributes.Set(attributes[Index], attributes[Index + 1]);
+                }
+            }
+        }
+        else if((Open == EElement::Way) && (std::strcmp(name, "nd") == 0)){
+            for(int Index = 0; attributes[Index]; Index += 2){
+                if(std::strcmp(attributes[Index], "ref") == 0){
+                    Way.DNodeIDs.push_back(std::strtoull(attributes[Index + 1], nullptr, 10));
+                }
+            }
+        }
+        else if((Open != EElement::None) && (std::strcmp(name, "tag") == 0)){
+            const char *Key = "", *Value = "";
+            for(int Index = 0; attributes[Index]; Index += 2){
+                if(std::strcmp(attributes[Index], "k") == 0){
+                    Key = attributes[Index + 1];
+                }
+                else if(std::strcmp(attributes[Index], "v") == 0){
+                    Value = attributes[Index + 1];
+                }
+            }
+            if(*Key){
+                (Open == EElement::Node ? Node.DAttributes : Way.DAttributes).Set(Key, Value);
+            }
+        }
+    }
+
+    // Returns the element the end tag finishes, if any
+    EElement EndElement(const char *name){
+        EElement Finished = EElement::None;
+        if((Open == EElement::Node) && (std::strcmp(name, "node") == 0)){
+            Finished = EElement::Node;
+        }
+        else if((Open == EElement::Way) && (std::strcmp(name, "way") == 0)){
+            Finished = EElement::Way;
+        }
+        if(Finished != EElement::None){
+            Open = EElement::None;
+        }
+        return Finished;
+    }
+
+    EElement Next(){
+        while(Reader->ReadEntity(Entity, true)){
+            if(Entity.DType == SXMLEntity::EType::StartElement){
+                Attributes.clear();
+                for(auto &Attribute : Entity.DAttributes){
+                    Attributes.push_back(Attribute.first.c_str());
+                    Attributes.push_back(Attribute.second.c_str());
+                }
+                Attributes.push_back(nullptr);
+                StartElement(Entity.DNameData.c_str(), Attributes.data());
+            }
+            else if(Entity.DType == SXMLEntity::EType::EndElement){
+                auto Finished = EndElement(Entity.DNameData.c_str());
+                if(Finished != EElement::None){
+                    return Finished;
+                }
+            }
+        }
+        return EElement::None;
+    }
+};
+
+void COSMStream::CAttributes::Set(const char *key, const char *value){
+    auto Index = Find(key);
+    if(Index < DCount){
+        DPairs[Index].second.assign(value);
+        return;
+    }
+    if(DCount < DPairs.size()){
+        DPairs[DCount].first.assign(key);
+        DPairs[DCount].second.assign(value);
+    }
+    else{
+        DPairs.emplace_back(key, value);
+    }
+    DCount++;
+}
+
+CStreetMap::TNodeID COSMStream::SNode::ID() const noexcept{
+    return DID;
+}
+
+CStreetMap::TLocation COSMStream::SNode::Location() const noexcept{
+    return DLocation;
+}
+
+std::size_t COSMStream::SNode::AttributeCount() const noexcept{
+    return DAttributes.Count();
+}
+
+std::string COSMStream::SNode::GetAttributeKey(std::size_t index) const noexcept{
+    return index < DAttributes.Count() ? DAttributes.Key(index) : std::string();
+}
+
+std::string COSMStream::SNode::GetAttributeValue(std::size_t index) const noexcept{
+    return index < DAttributes.Count() ? DAttributes.Value(index) : std::string();
+}
+
+bool COSMStream::SNode::HasAttribute(const std::string &key) const noexcept{
+    return DAttributes.Find(key) < DAttributes.Count();
+}
+
+std::string COSMStream::SNode::GetAttribute(const std::string &key) const noexcept{
+    auto Index = DAttributes.Find(key);
+    return Index < DAttributes.Count() ? DAttributes.Value(Index) : std::string();
+}
+
+CStreetMap::TWayID COSMStream::SWay::ID() const noexcept{
+    return DID;
+}
+
+std::size_t COSMStream::SWay::NodeCount() const noexcept{
+    return DNodeIDs.size();
+}
+
+CStreetMap::TNodeID COSMStream::SWay::GetNodeID(std::size_t index) const noexcept{
+    return index < DNodeIDs.size() ? DNodeIDs[index] : CStreetMap::InvalidNodeID;
+}
+
+std::size_t COSMStream::SWay::AttributeCount() const noexcept{
+    return DAttributes.Count();
+}
+
+std::string COSMStream::SWay::GetAttributeKey(std::size_t index) const noexcept{
+    return index < DAttributes.Count() ? DAttributes.Key(index) : std::string();
+}
+
+std::string COSMStream::SWay::GetAttributeValue(std::size_t index) const noexcept{
+    return index < DAttributes.Count() ? DAttributes.Value(index) : std::string();
+}
+
+bool COSMStream::SWay::HasAttribute(const std::string &key) const noexcept{
+    return DAttributes.Find(key) < DAttributes.Count();
+}
+
+std::string COSMStream::SWay::GetAttribute(const std::string &key) const noexcept{
+    auto Index = DAttributes.Find(key);
+    return Index < DAttributes.Count() ? DAttributes.Value(Index) : std::string();
+}
+
+COSMStream::COSMStream(std::shared_ptr< CXMLReader > src){
+    DImplementation = std::make_unique< SImplementation >(std::move(src));
+}
+
+COSMStream::~COSMStream(){
+
+}
+
+COSMStream::EElement COSMStream::Next(){
+    return DImplementation->Next();
+}
+
+bool COSMStream::NextNode(){
+    EElement Element;
+    while((Element = DImplementation->Next()) == EElement::Way){
+    }
+    return Element == EElement::Node;
+}
+
+bool COSMStream::NextWay(){
+    EElement Element;
+    while((Element = DImplementation->Next()) == EElement::Node){
+    }
+    return Element == EElement::Way;
+}
+
+const COSMStream::SNode &COSMStream::Node() const noexcept{
+    return DImplementation->Node;
+}
+
+const COSMStream::SWay &COSMStream::Way() const noexcept{
+    return DImplementation->Way;
+}
+
+bool COSMStream::Visit(SVisitor &visitor){
+    SImplementation::SVisitHandler Handler(*DImplementation, visitor);
+    return DImplementation->Reader->Parse(Handler);
+}
@@ -1,256 +1,861 @@
-#include "OpenStreetMap.h" 
-#include "XMLReader.h" 
-#include <memory> 
-#include <vector> 
-#include <string> 
-#include <unordered_map> 
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "OSMStream.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 //  implementation structure first using COpenStreetMap
 struct COpenStreetMap::SImplementation {
     // Forward declarations of implementation classes
-    class MapNode;  // 
-    class MapWay;   // forward declare the way class
+    class MapNode;  // proxy that reads a node out of the node table
+    class MapWay;   // proxy that reads a way out of the way table
+    class SBuilder;  // fills the tables from the XML reader
 
-    // storing ways and nodes here
-    std::vector<std::shared_ptr<MapNode>> Nodes;  // list of all nodes
-    std::vector<std::shared_ptr<MapWay>> Ways;    
+    // coordinates are kept as fixed point at OSM's native 1e-7 degree precision
+    static constexpr double CoordinateScale = COpenStreetMap::CoordinateScale;
 
-    // helper method to handle attributes
-    void ProcessAttributes(const std::vector<std::pair<std::string, std::string>>& attributes, 
-                          std::unordered_map<std::string, std::string>& attributeMap) {
-        for (const auto& attr : attributes) {  // loop through all attributes
-            attributeMap[attr.first] = attr.second;  // add them to the map
+    // snapshot layout: header, then every column as a uint64 element count
+    // followed by the elements, each column starting on an 8 byte boundary
+    static constexpr char SnapshotMagic[8] = {'O', 'S', 'M', 'S', 'N', 'A', 'P', '\0'};
+    static constexpr uint32_t SnapshotVersion = 1;
+    static constexpr uint32_t SnapshotByteOrder = 0x01020304;
+    static constexpr std::size_t SnapshotAlignment = 8;
+
+    // offsets, string IDs and element indices are stored as uint32, the last value
+    // is left free since CompactStrings uses it as its unmapped marker
+    static constexpr std::size_t ColumnLimit = std::numeric_limits<uint32_t>::max() - 1;
+
+    // array that is either filled while loading or points into a snapshot
+    template <typename T>
+    struct SColumn {
+        std::vector<T> Owned;
+        const T *Data = nullptr;
+        std::size_t Size = 0;
+
+        void Seal() {
+            Data = Owned.data();
+            Size = Owned.size();
+        }
+
+        void Attach(const T *data, std::size_t size) {
+            std::vector<T>().swap(Owned);
+            Data = data;
+            Size = size;
+        }
+
+        const T &operator[](std::size_t index) const {
+            return Data[index];
+        }
+
+        std::size_t size() const {
+            return Size;
+        }
+
+        const T *begin() const {
+            return Data;
+        }
+
+        const T *end() const {
+            return Data + Size;
+        }
+    };
+
+    // interned tag keys and values, string i is Data[Offsets[i], Offsets[i + 1])
+    struct SStringTable {
+        SColumn<char> Data;
+        SColumn<uint32_t> Offsets;
+
+        std::string_view Get(uint32_t index) const {
+            return std::string_view(Data.begin() + Offsets[index], Offsets[index + 1] - Offsets[index]);
+        }
+    };
+
+    // CSR tag table, element i has the tags in Keys/Values[Offsets[i], Offsets[i + 1])
+    struct STagTable {
+        SColumn<uint32_t> Offsets;
+        SColumn<uint32_t> Keys;
+        SColumn<uint32_t> Values;
+
+        void Add(const std::vector<std::pair<uint32_t, uint32_t>> &tags) {
+            if (Offsets.Owned.empty()) {
+                Offsets.Owned.push_back(0);
+            }
+            for (const auto &Tag : tags) {
+                Keys.Owned.push_back(Tag.first);
+                Values.Owned.push_back(Tag.second);
+            }
+            Offsets.Owned.push_back(static_cast<uint32_t>(Keys.Owned.size()));
+        }
+    };
+
+    // structure of arrays node storage
+    struct SNodeTable {
+        SColumn<TNodeID> IDs;
+        SColumn<int32_t> Latitudes;
+        SColumn<int32_t> Longitudes;
+        STagTable Tags;
+        SColumn<uint32_t> IDOrder;  // node indices sorted by ID, empty when IDs is already sorted
+    };
+
+    // structure of arrays way storage, way i has the nodes NodeIDs[NodeOffsets[i], NodeOffsets[i + 1])
+    struct SWayTable {
+        SColumn<TWayID> IDs;
+        SColumn<uint32_t> NodeOffsets;
+        SColumn<TNodeID> NodeIDs;
+        STagTable Tags;
+        SColumn<uint32_t> IDOrder;  // way indices sorted by ID, empty when IDs is already sorted
+    };
+
+    // everything the proxies need, shared so a proxy can outlive the map
+    struct SStorage {
+        SStringTable Strings;
+        SNodeTable Nodes;
+        SWayTable Ways;
+        std::shared_ptr<CDataSource> Snapshot;  // keeps a mapped snapshot alive
+        std::vector<uint64_t> SnapshotCopy;  // aligned copy of a snapshot without a view
+
+        // calls visitor on every column in snapshot order
+        template <typename TVisitor>
+        void ForEachColumn(TVisitor &&visitor) {
+            visitor(Strings.Data);
+            visitor(Strings.Offsets);
+            visitor(Nodes.IDs);
+            visitor(Nodes.Latitudes);
+            visitor(Nodes.Longitudes);
+            visitor(Nodes.Tags.Offsets);
+            visitor(Nodes.Tags.Keys);
+            visitor(Nodes.Tags.Values);
+            visitor(Nodes.IDOrder);
+            visitor(Ways.IDs);
+            visitor(Ways.NodeOffsets);
+            visitor(Ways.NodeIDs);
+            visitor(Ways.Tags.Offsets);
+            visitor(Ways.Tags.Keys);
+            visitor(Ways.Tags.Values);
+            visitor(Ways.IDOrder);
+        }
+
+        // number of tags of element index
+        static std::size_t TagCount(const STagTable &tags, std::size_t index) {
+            return tags.Offsets[index + 1] - tags.Offsets[index];
+        }
+
+        std::string TagKey(const STagTable &tags, std::size_t index, std::size_t tagindex) const {
+            if (tagindex < TagCount(tags, index)) {
+                return std::string(Strings.Get(tags.Keys[tags.Offsets[index] + tagindex]));
+            }
+            return "";  // if index is out of bounds, return empty string
+        }
+
+        std::string TagValueAt(const STagTable &tags, std::size_t index, std::size_t tagindex) const {
+            if (tagindex < TagCount(tags, index)) {
+                return std::string(Strings.Get(tags.Values[tags.Offsets[index] + tagindex]));
+            }
+            return "";  // if index is out of bounds, return empty string
+        }
+
+        // position of the key in the tag arrays, or the end of the element's tags if it is missing
+        uint32_t FindTag(const STagTable &tags, std::size_t index, const std::string &key) const {
+            uint32_t Position = tags.Offsets[index];
+            while ((Position < tags.Offsets[index + 1]) && (Strings.Get(tags.Keys[Position]) != key)) {
+                Position++;
+            }
+            return Position;
+        }
+
+        std::string TagValue(const STagTable &tags, std::size_t index, const std::string &key) const {
+            auto Position = FindTag(tags, index, key);
+            if (Position < tags.Offsets[index + 1]) {
+                return std::string(Strings.Get(tags.Values[Position]));
+            }
+            return "";  // if not found, return empty string
+        }
+    };
+
+    std::shared_ptr<SStorage> Storage = std::make_shared<SStorage>();
+    std::unordered_map<std::string, uint32_t> StringIndex;  // only used while loading
+    bool Overflowed = false;  // set once the input outgrows the uint32 columns, the load then fails
+
+    static int32_t ToFixed(double degrees) {
+        return static_cast<int32_t>(std::llround(degrees * CoordinateScale));
+    }
+
+    static double FromFixed(int32_t fixed) {
+        return fixed / CoordinateScale;
+    }
+
+    // true if added entries fit after current ones without passing ColumnLimit
+    static bool Fits(std::size_t current, std::size_t added) {
+        return (current <= ColumnLimit) && (added <= ColumnLimit - current);
+    }
+
+    // returns the ID of the string in the string table, adding it if it is new
+    uint32_t Intern(const std::string &str) {
+        auto Result = StringIndex.emplace(str, static_cast<uint32_t>(StringIndex.size()));
+        if (Result.second) {
+            auto &Strings = Storage->Strings;
+            if (!Fits(StringIndex.size() - 1, 1) || !Fits(Strings.Data.Owned.size(), str.size())) {
+                StringIndex.erase(Result.first);
+                Overflowed = true;
+                return 0;
+            }
+            if (Strings.Offsets.Owned.empty()) {
+                Strings.Offsets.Owned.push_back(0);
+            }
+            Strings.Data.Owned.insert(Strings.Data.Owned.end(), str.begin(), str.end());
+            Strings.Offsets.Owned.push_back(static_cast<uint32_t>(Strings.Data.Owned.size()));
+        }
+        return Result.first->second;
+    }
+
+    // appends a finished node to the node table
+    void AddNode(TNodeID id, TLocation location, const std::vector<std::pair<uint32_t, uint32_t>> &tags) {
+        auto &Nodes = Storage->Nodes;
+        if (!Fits(Nodes.IDs.Owned.size(), 1) || !Fits(Nodes.Tags.Keys.Owned.size(), tags.size())) {
+            Overflowed = true;
+            return;
+        }
+        Nodes.IDs.Owned.push_back(id);
+        Nodes.Latitudes.Owned.push_back(ToFixed(location.first));
+        Nodes.Longitudes.Owned.push_back(ToFixed(location.second));
+        Nodes.Tags.Add(tags);
+    }
+
+    // appends a finished way to the way table
+    void AddWay(TWayID id, const std::vector<TNodeID> &nodeids, const std::vector<std::pair<uint32_t, uint32_t>> &tags) {
+        auto &Ways = Storage->Ways;
+        if (!Fits(Ways.IDs.Owned.size(), 1) || !Fits(Ways.NodeIDs.Owned.size(), nodeids.size()) || !Fits(Ways.Tags.Keys.Owned.size(), tags.size())) {
+            Overflowed = true;
+            return;
+        }
+        Ways.IDs.Owned.push_back(id);
+        if (Ways.NodeOffsets.Owned.empty()) {
+            Ways.NodeOffsets.Owned.push_back(0);
+        }
+        Ways.NodeIDs.Owned.insert(Ways.NodeIDs.Owned.end(), nodeids.begin(), nodeids.end());
+        Ways.NodeOffsets.Owned.push_back(static_cast<uint32_t>(Ways.NodeIDs.Owned.size()));
+        Ways.Tags.Add(tags);
+    }
+
+    // IDs are normally sorted in OSM files, otherwise a sorted order is kept beside them
+    template <typename TID>
+    static void BuildIDOrder(const std::vector<TID> &ids, std::vector<uint32_t> &order) {
+        if (!std::is_sorted(ids.begin(), ids.end())) {
+            order.resize(ids.size());
+            for (std::size_t Index = 0; Index < order.size(); Index++) {
+                order[Index] = static_cast<uint32_t>(Index);
+            }
+            // stable so the first element wins if an ID repeats
+            std::stable_sort(order.begin(), order.end(), [&ids](uint32_t left, uint32_t right) {
+                return ids[left] < ids[right];
+            });
+        }
+    }
+
+    // binary search for the index of the first element with the ID
+    template <typename TID>
+    static bool FindByID(const SColumn<TID> &ids, const SColumn<uint32_t> &order, TID id, std::size_t &index) {
+        if (order.size() == 0) {
+            auto It = std::lower_bound(ids.begin(), ids.end(), id);
+            if ((It != ids.end()) && (*It == id)) {
+                index = It - ids.begin();
+                return true;
+            }
+            return false;
+        }
+        auto It = std::lower_bound(order.begin(), order.end(), id, [&ids](uint32_t element, TID value) {
+            return ids[element] < value;
+        });
+        if ((It != order.end()) && (ids[*It] == id)) {
+            index = *It;
+            return true;
+        }
+        return false;
+    }
+
+    // drops the nodes that no way references, compacting the node columns in place
+    void KeepReferencedNodes() {
+        auto &Nodes = Storage->Nodes;
+        auto &IDs = Nodes.IDs.Owned;
+        SColumn<TNodeID> IDColumn;
+        SColumn<uint32_t> Order;
+        IDColumn.Attach(IDs.data(), IDs.size());
+        BuildIDOrder(IDs, Order.Owned);
+        Order.Seal();
+        std::vector<bool> Referenced(IDs.size(), false);
+        for (auto NodeID : Storage->Ways.NodeIDs.Owned) {
+            std::size_t Index;
+            if (FindByID(IDColumn, Order, NodeID, Index)) {
+                Referenced[Index] = true;
+            }
+        }
+        auto &Tags = Nodes.Tags;
+        std::size_t Kept = 0;
+        uint32_t TagsKept = 0;
+        uint32_t TagBegin = 0;
+        for (std::size_t Index = 0; Index < IDs.size(); Index++) {
+            uint32_t TagEnd = Tags.Offsets.Owned[Index + 1];  // read before the slot can be overwritten
+            if (Referenced[Index]) {
+                IDs[Kept] = IDs[Index];
+                Nodes.Latitudes.Owned[Kept] = Nodes.Latitudes.Owned[Index];
+                Nodes.Longitudes.Owned[Kept] = Nodes.Longitudes.Owned[Index];
+                for (uint32_t Position = TagBegin; Position < TagEnd; Position++) {
+                    Tags.Keys.Owned[TagsKept] = Tags.Keys.Owned[Position];
+                    Tags.Values.Owned[TagsKept] = Tags.Values.Owned[Position];
+                    TagsKept++;
+                }
+                Kept++;
+                Tags.Offsets.Owned[Kept] = TagsKept;
+            }
+            TagBegin = TagEnd;
+        }
+        IDs.resize(Kept);
+        Nodes.Latitudes.Owned.resize(Kept);
+        Nodes.Longitudes.Owned.resize(Kept);
+        Tags.Offsets.Owned.resize(Kept ? Kept + 1 : std::min<std::size_t>(Tags.Offsets.Owned.size(), 1));
+        Tags.Keys.Owned.resize(TagsKept);
+        Tags.Values.Owned.resize(TagsKept);
+        CompactStrings();
+    }
+
+    // rebuilds the string table with only the strings the kept tags use
+    void CompactStrings() {
+        auto &Strings = Storage->Strings;
+        if (Strings.Offsets.Owned.empty()) {
+            return;
         }
+        std::vector<uint32_t> Remap(Strings.Offsets.Owned.size() - 1, std::numeric_limits<uint32_t>::max());
+        std::vector<char> Data;
+        std::vector<uint32_t> Offsets(1, 0);
+        auto Move = [&](std::vector<uint32_t> &ids) {
+            for (auto &ID : ids) {
+                if (Remap[ID] == std::numeric_limits<uint32_t>::max()) {
+                    Remap[ID] = static_cast<uint32_t>(Offsets.size() - 1);
+                    Data.insert(Data.end(), Strings.Data.Owned.begin() + Strings.Offsets.Owned[ID], Strings.Data.Owned.begin() + Strings.Offsets.Owned[ID + 1]);
+                    Offsets.push_back(static_cast<uint32_t>(Data.size()));
+                }
+                ID = Remap[ID];
+            }
+        };
+        Move(Storage->Nodes.Tags.Keys.Owned);
+        Move(Storage->Nodes.Tags.Values.Owned);
+        Move(Storage->Ways.Tags.Keys.Owned);
+        Move(Storage->Ways.Tags.Values.Owned);
+        Strings.Data.Owned.swap(Data);
+        Strings.Offsets.Owned.swap(Offsets);
+        std::unordered_map<std::string, uint32_t>().swap(StringIndex);  // IDs changed, nothing can be interned after this
+    }
+
+    // finishes loading from XML, builds the ID orders and points the columns at the owned data
+    void Seal() {
+        auto &Nodes = Storage->Nodes;
+        auto &Ways = Storage->Ways;
+        if (Storage->Strings.Offsets.Owned.empty()) {
+            Storage->Strings.Offsets.Owned.push_back(0);
+        }
+        for (auto *Offsets : {&Nodes.Tags.Offsets, &Ways.Tags.Offsets, &Ways.NodeOffsets}) {
+            if (Offsets->Owned.empty()) {
+                Offsets->Owned.push_back(0);
+            }
+        }
+        BuildIDOrder(Nodes.IDs.Owned, Nodes.IDOrder.Owned);
+        BuildIDOrder(Ways.IDs.Owned, Ways.IDOrder.Owned);
+        Storage->ForEachColumn([](auto &column) {
+            column.Seal();
+        });
+        std::unordered_map<std::string, uint32_t>().swap(StringIndex);  // no longer needed once loaded
+    }
+
+    // writes the columns in the snapshot layout, returns false if the sink fails
+    bool WriteSnapshot(CDataSink &sink) const {
+        std::vector<char> Buffer;
+        bool Success = true;
+        auto Append = [&](const void *data, std::size_t size) {
+            const char *Bytes = static_cast<const char *>(data);
+            Buffer.insert(Buffer.end(), Bytes, Bytes + size);
+            if (Buffer.size() >= 1 << 20) {
+                Success = Success && sink.Write(Buffer);
+                Buffer.clear();
+            }
+        };
+        uint32_t Header[2] = {SnapshotVersion, SnapshotByteOrder};
+        Append(SnapshotMagic, sizeof(SnapshotMagic));
+        Append(Header, sizeof(Header));
+        std::size_t Written = sizeof(SnapshotMagic) + sizeof(Header);
+        Storage->ForEachColumn([&](auto &column) {
+            uint64_t Count = column.size();
+            Append(&Count, sizeof(Count));
+            // large columns are handed to the sink in pieces so the buffer stays bounded
+            const char *Bytes = reinterpret_cast<const char *>(column.begin());
+            std::size_t Size = column.size() * sizeof(column[0]);
+            for (std::size_t Offset = 0; Offset < Size; Offset += 1 << 20) {
+                Append(Bytes + Offset, std::min<std::size_t>(1 << 20, Size - Offset));
+            }
+            Written += sizeof(Count) + Size;
+            static const char Padding[SnapshotAlignment] = {0};
+            Append(Padding, (SnapshotAlignment - Written % SnapshotAlignment) % SnapshotAlignment);
+            Written += (SnapshotAlignment - Written % SnapshotAlignment) % SnapshotAlignment;
+        });
+        if (!Buffer.empty()) {
+            Success = Success && sink.Write(Buffer);
+        }
+        return Success;
+    }
+
+    // points the columns into a snapshot, data must be 8 byte aligned
+    bool AttachSnapshot(const char *data, std::size_t size) {
+        uint32_t Header[2];
+        if ((size < sizeof(SnapshotMagic) + sizeof(Header)) || std::memcmp(data, SnapshotMagic, sizeof(SnapshotMagic))) {
+            return false;
+        }
+        std::memcpy(Header, data + sizeof(SnapshotMagic), sizeof(Header));
+        if ((Header[0] != SnapshotVersion) || (Header[1] != SnapshotByteOrder)) {
+            return false;
+        }
+        std::size_t Offset = sizeof(SnapshotMagic) + sizeof(Header);
+        bool Valid = true;
+        Storage->ForEachColumn([&](auto &column) {
+            using TElement = std::remove_const_t<std::remove_reference_t<decltype(column[0])>>;
+            uint64_t Count;
+            if (!Valid || (size - Offset < sizeof(Count))) {
+                Valid = false;
+                return;
+            }
+            std::memcpy(&Count, data + Offset, sizeof(Count));
+            Offset += sizeof(Count);
+            if (Count > (size - Offset) / sizeof(TElement)) {
+                Valid = false;
+                return;
+            }
+            column.Attach(reinterpret_cast<const TElement *>(data + Offset), Count);
+            Offset += Count * sizeof(TElement);
+            Offset += std::min((SnapshotAlignment - Offset % SnapshotAlignment) % SnapshotAlignment, size - Offset);
+        });
+        return Valid && ValidateColumns();
+    }
+
+    // checks every size, offset and index so a damaged snapshot can not make an accessor read out of bounds
+    bool ValidateColumns() const {
+        const auto &Strings = Storage->Strings;
+        const auto &Nodes = Storage->Nodes;
+        const auto &Ways = Storage->Ways;
+        // offsets start at 0, never decrease and end at the size of the column they index
+        auto ValidOffsets = [](const SColumn<uint32_t> &offsets, std::size_t count, std::size_t target) {
+            return (offsets.size() == count + 1) && (offsets[0] == 0) && (offsets[count] == target)
+                && std::is_sorted(offsets.begin(), offsets.end());
+        };
+        auto ValidTags = [&](const STagTable &tags, std::size_t count) {
+            if (!ValidOffsets(tags.Offsets, count, tags.Keys.size()) || (tags.Values.size() != tags.Keys.size())) {
+                return false;
+            }
+            std::size_t StringCount = Strings.Offsets.size() - 1;
+            for (std::size_t Index = 0; Index < tags.Keys.size(); Index++) {
+                if ((tags.Keys[Index] >= StringCount) || (tags.Values[Index] >= StringCount)) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        // either the IDs are sorted themselves, or the order lists valid indices sorted by ID
+        auto ValidOrder = [](const auto &ids, const SColumn<uint32_t> &order) {
+            if (order.size() == 0) {
+                return std::is_sorted(ids.begin(), ids.end());
+            }
+            if (order.size() != ids.size()) {
+                return false;
+            }
+            for (std::size_t Index = 0; Index < order.size(); Index++) {
+                if ((order[Index] >= ids.size()) || ((Index > 0) && (ids[order[Index]] < ids[order[Index - 1]]))) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::size_t NodeCount = Nodes.IDs.size();
+        std::size_t WayCount = Ways.IDs.size();
+        return (Strings.Offsets.size() > 0) && ValidOffsets(Strings.Offsets, Strings.Offsets.size() - 1, Strings.Data.size())
+            && (Nodes.Latitudes.size() == NodeCount) && (Nodes.Longitudes.size() == NodeCount)
+            && ValidTags(Nodes.Tags, NodeCount) && ValidOrder(Nodes.IDs, Nodes.IDOrder)
+            && ValidOffsets(Ways.NodeOffsets, WayCount, Ways.NodeIDs.size())
+            && ValidTags(Ways.Tags, WayCount) && ValidOrder(Ways.IDs, Ways.IDOrder);
     }
 };
 
-// implementation classes using CStreetMap::SNode
+// node proxy using CStreetMap::SNode, created on demand by NodeByIndex/NodeByID
 class COpenStreetMap::SImplementation::MapNode : public CStreetMap::SNode {
 public:
-    
-    TNodeID NodeID;  // unique ID for the node
-    
-    TLocation NodeLocation;  // latitude and longitude of the node
-    
-    std::unordered_map<std::string, std::string> Attributes;  // key-value pairs for attributes
-
-   
+    std::shared_ptr<const SStorage> Storage;  // table the node lives in
+    std::size_t Index;  // index of the node in the table
+
+    MapNode(std::shared_ptr<const SStorage> storage, std::size_t index) : Storage(std::move(storage)), Index(index) {}
+
     TNodeID ID() const noexcept override {
-        return NodeID;  // return the node's ID
+        return Storage->Nodes.IDs[Index];  // return the node's ID
     }
 
-    
     TLocation Location() const noexcept override {
-        return NodeLocation;  // return the node's location
+        return TLocation(FromFixed(Storage->Nodes.Latitudes[Index]), FromFixed(Storage->Nodes.Longitudes[Index]));  // return the node's location
     }
 
     // # of attributes node has
     std::size_t AttributeCount() const noexcept override {
-        return Attributes.size();  // return the number of attributes
+        return SStorage::TagCount(Storage->Nodes.Tags, Index);
     }
 
-    // getting key of attribute through index
+    // getting key of attribute through index, attributes keep the order they were read in
     std::string GetAttributeKey(std::size_t index) const noexcept override {
-        if (index < Attributes.size()) {  // check if index is valid
-            auto it = Attributes.begin();  
-            std::advance(it, index);      // move to the right position
-            return it->first;             
-        }
-        return "";  // if index is out of bounds, return empty string
+        return Storage->TagKey(Storage->Nodes.Tags, Index, index);
+    }
+
+    // value of the attribute at index, in the same order as the keys
+    std::string GetAttributeValue(std::size_t index) const noexcept override {
+        return Storage->TagValueAt(Storage->Nodes.Tags, Index, index);
     }
 
     //  see if the node has an attribute using key
     bool HasAttribute(const std::string &key) const noexcept override {
-        return Attributes.find(key) != Attributes.end();  // look for the key
+        return Storage->FindTag(Storage->Nodes.Tags, Index, key) < Storage->Nodes.Tags.Offsets[Index + 1];  // look for the key
     }
 
     // retrieve the value of attribute if the node has an attribute
     std::string GetAttribute(const std::string &key) const noexcept override {
-        auto it = Attributes.find(key);  // find the key
-        if (it != Attributes.end()) {    // if found, return the value
-            return it->second;
-        }
-        return "";  // if not found, return empty string
+        return Storage->TagValue(Storage->Nodes.Tags, Index, key);
     }
 };
 
-// way class
+// way proxy using CStreetMap::SWay, created on demand by WayByIndex/WayByID
 class COpenStreetMap::SImplementation::MapWay : public CStreetMap::SWay {
 public:
-    
-    TWayID WayID;  // unique ID for the way
-    
-    std::vector<TNodeID> NodeIDs;  // list of node IDs in this way
-    
-    std::unordered_map<std::string, std::string> Attributes;  // key-value pairs for attributes
-
-    
+    std::shared_ptr<const SStorage> Storage;  // table the way lives in
+    std::size_t Index;  // index of the way in the table
+
+    MapWay(std::shared_ptr<const SStorage> storage, std::size_t index) : Storage(std::move(storage)), Index(index) {}
+
     TWayID ID() const noexcept override {
-        return WayID;  // return the way's ID
+        return Storage->Ways.IDs[Index];  // return the way's ID
     }
 
-    
     std::size_t NodeCount() const noexcept override {
-        return NodeIDs.size();  // return the number of nodes in the way
+        return Storage->Ways.NodeOffsets[Index + 1] - Storage->Ways.NodeOffsets[Index];  // return the number of nodes in the way
     }
 
     // getting Node ID thru index
     TNodeID GetNodeID(std::size_t index) const noexcept override {
-        if (index < NodeIDs.size()) {  // check if index is valid
-            return NodeIDs[index];     
+        if (index < NodeCount()) {  // check if index is valid
+            return Storage->Ways.NodeIDs[Storage->Ways.NodeOffsets[Index] + index];
         }
         return CStreetMap::InvalidNodeID;  // if index is out of bounds, return invalid ID
     }
 
     // # of attributes way has
     std::size_t AttributeCount() const noexcept override {
-        return Attributes.size();  // return the number of attributes
+        return SStorage::TagCount(Storage->Ways.Tags, Index);
     }
 
-    // getting key of attribute through index
+    // getting key of attribute through index, attributes keep the order they were read in
     std::string GetAttributeKey(std::size_t index) const noexcept override {
-        if (index < Attributes.size()) {  // check if index is valid
-            auto it = Attributes.begin();  
-            std::advance(it, index);      // move to the right position
-            return it->first;        
-        }
-        return "";  // if index is out of bounds, return empty string
+        return Storage->TagKey(Storage->Ways.Tags, Index, index);
+    }
+
+    // value of the attribute at index, in the same order as the keys
+    std::string GetAttributeValue(std::size_t index) const noexcept override {
+        return Storage->TagValueAt(Storage->Ways.Tags, Index, index);
     }
 
     // check to see if the way has an attribute using key
     bool HasAttribute(const std::string &key) const noexcept override {
-        return Attributes.find(key) != Attributes.end();  // look for the key
+        return Storage->FindTag(Storage->Ways.Tags, Index, key) < Storage->Ways.Tags.Offsets[Index + 1];  // look for the key
     }
 
     // get the value of attribute if the way has an attribute
     std::string GetAttribute(const std::string &key) const noexcept override {
-        auto it = Attributes.find(key);  // find the key
-        if (it != Attributes.end()) {    // if found, return the value
-            return it->second;
-        }
-        return "";  // if not found, return empty string
+        return Storage->TagValue(Storage->Ways.Tags, Index, key);
     }
 };
 
-// initialize the implementation
-COpenStreetMap::COpenStreetMap(std::shared_ptr<CXMLReader> src) {
-    DImplementation = std::make_unique<SImplementation>();  // create the implementation
+// builds the tables from the stream's scratch elements, tags are interned as they arrive
+// and only for elements the load options keep
+class COpenStreetMap::SImplementation::SBuilder : public COSMStream::SVisitor {
+public:
+    SImplementation &Implementation;
+    const SLoadOptions &Options;
+    std::vector<std::pair<uint32_t, uint32_t>> tags;  // interned tags of the current node or way, reused between them
+    std::vector<TNodeID> boundedIDs;  // IDs of the nodes inside the bounds, whether or not the node filter kept them
+    bool boundedSorted = true;  // false once a node arrived out of ID order
 
-    SXMLEntity entity;  // temporary storage for XML elements
-    std::shared_ptr<SImplementation::MapNode> currentNode = nullptr;  // current node being processed
-    std::shared_ptr<SImplementation::MapWay> currentWay = nullptr;    // current way being processed
+    SBuilder(SImplementation &implementation, const SLoadOptions &options) : Implementation(implementation), Options(options) {}
 
-    // Parsing the XML file
-    while (src->ReadEntity(entity)) {  // read the XML file line by line
-        if (entity.DType == SXMLEntity::EType::StartElement) {  // if it's a start tag
-            if (entity.DNameData == "node") {  // if it's a node
-                currentNode = std::make_shared<SImplementation::MapNode>();  // create a new node
-                currentWay = nullptr;  // reset the current way
-
-                // Process node attributes
-                for (const auto& attr : entity.DAttributes) {  // loop through attributes
-                    if (attr.first == "id") {  // if it's the ID
-                        currentNode->NodeID = std::stoull(attr.second);  
-                    } else if (attr.first == "lat") {  // if it's latitude
-                        currentNode->NodeLocation.first = std::stod(attr.second);  // store latitude
-                    } else if (attr.first == "lon") {  // if it's longitude
-                        currentNode->NodeLocation.second = std::stod(attr.second);  // store longitude
-                    } else {  // if it's another attribute
-                        currentNode->Attributes[attr.first] = attr.second;  // store it
-                    }
-                }
-            } else if (entity.DNameData == "way") {  // if it's a way
-                currentWay = std::make_shared<SImplementation::MapWay>();  // create a new way
-                currentNode = nullptr;  // reset the current node
-
-                // Process way attributes
-                for (const auto& attr : entity.DAttributes) {  // loop through attributes
-                    if (attr.first == "id") {  // if it's the ID
-                        currentWay->WayID = std::stoull(attr.second);  // store the ID
-                    } else {  // if it's another attribute
-                        currentWay->Attributes[attr.first] = attr.second;  // store it
-                    }
-                }
-            } else if (entity.DNameData == "nd" && currentWay) {  // if it's a node reference in a way
-                for (const auto& attr : entity.DAttributes) {  // process the reference
-                    if (attr.first == "ref") {  // if it's the node ID
-                        currentWay->NodeIDs.push_back(std::stoull(attr.second));  // add it to the way
-                    }
-                }
-            } else if (entity.DNameData == "tag") {  // if it's a tag (attribute)
-                std::string key, value;  // temporary storage for key and value
-                for (const auto& attr : entity.DAttributes) {  // process the tag
-                    if (attr.first == "k") {  // if it's the key
-                        key = attr.second;  // store the key
-                    } else if (attr.first == "v") {  // if it's the value
-                        value = attr.second;  // store the value
-                    }
-                }
-                if (!key.empty()) {  // if the key is not empty
-                    if (currentNode) {  // if we're processing a node
-                        currentNode->Attributes[key] = value;  // add the attribute to the node
-                    } else if (currentWay) {  // if we're processing a way
-                        currentWay->Attributes[key] = value;  // add the attribute to the way
-                    }
-                }
+    // interns the attributes of the current element, the stream already merged repeated keys
+    void InternTags(const COSMStream::CAttributes &attributes) {
+        tags.clear();
+        for (std::size_t Index = 0; Index < attributes.Count(); Index++) {
+            tags.emplace_back(Implementation.Intern(attributes.Key(Index)), Implementation.Intern(attributes.Value(Index)));
+        }
+    }
+
+    bool InBounds(TLocation location) const {
+        return (location.first >= Options.DMinimum.first) && (location.first <= Options.DMaximum.first)
+            && (location.second >= Options.DMinimum.second) && (location.second <= Options.DMaximum.second);
+    }
+
+    // true if any node of the way was inside the bounds, nodes come before ways so this is normally sorted once
+    bool TouchesBounds(const COSMStream::SWay &way) {
+        if (!boundedSorted) {
+            std::sort(boundedIDs.begin(), boundedIDs.end());
+            boundedSorted = true;
+        }
+        for (auto NodeID : way.DNodeIDs) {
+            if (std::binary_search(boundedIDs.begin(), boundedIDs.end(), NodeID)) {
+                return true;
             }
-        } else if (entity.DType == SXMLEntity::EType::EndElement) {  // if it's an end tag
-            if (entity.DNameData == "node" && currentNode) { 
-                DImplementation->Nodes.push_back(currentNode);  // add the node to the list
-                currentNode = nullptr;  // reset the current node
-            } else if (entity.DNameData == "way" && currentWay) {  //end of way
-                DImplementation->Ways.push_back(currentWay);  // add the way to the list
-                currentWay = nullptr;  // reset the current way
+        }
+        return false;
+    }
+
+    void Node(const COSMStream::SNode &node) override {
+        if (Implementation.Overflowed) {
+            return;
+        }
+        if (Options.DUseBounds) {
+            if (!InBounds(node.DLocation)) {
+                return;
             }
+            boundedSorted = boundedSorted && (boundedIDs.empty() || (boundedIDs.back() <= node.DID));
+            boundedIDs.push_back(node.DID);
         }
+        if (Options.DNodeFilter && !Options.DNodeFilter(node)) {
+            return;
+        }
+        InternTags(node.DAttributes);
+        Implementation.AddNode(node.DID, node.DLocation, tags);  // add the node to the table
     }
+
+    void Way(const COSMStream::SWay &way) override {
+        if (Implementation.Overflowed) {
+            return;
+        }
+        if ((Options.DWayFilter && !Options.DWayFilter(way)) || (Options.DUseBounds && !TouchesBounds(way))) {
+            return;
+        }
+        InternTags(way.DAttributes);
+        Implementation.AddWay(way.DID, way.DNodeIDs, tags);  // add the way to the table
+    }
+};
+
+// initialize the implementation
+COpenStreetMap::COpenStreetMap(std::shared_ptr<CXMLReader> src) : COpenStreetMap(src, SLoadOptions()) {
+}
+
+// load only what the options keep
+COpenStreetMap::COpenStreetMap(std::shared_ptr<CXMLReader> src, const SLoadOptions &options) {
+    DImplementation = std::make_unique<SImplementation>();  // create the implementation
+
+    // Parsing the XML file
+    // relations and anything else the tables do not hold are skipped by the reader
+    SImplementation::SBuilder Builder(*DImplementation, options);
+    COSMStream Stream(src);
+    Stream.Visit(Builder);
+    if (DImplementation->Overflowed) {
+        // the map would not fit the uint32 columns, fail to an empty map rather than wrap
+        DImplementation = std::make_unique<SImplementation>();
+    }
+    else if (options.DReferencedNodesOnly) {
+        DImplementation->KeepReferencedNodes();
+    }
+
+    // build the ID indexes, the first element wins if an ID repeats
+    DImplementation->Seal();
+    UpdateColumns();
+}
+
+// used by LoadSnapshot, the columns are attached afterwards
+COpenStreetMap::COpenStreetMap() : DImplementation(std::make_unique<SImplementation>()) {
 }
 
 // destr
 COpenStreetMap::~COpenStreetMap() = default;  // destructor (does nothing special)
 
+bool COpenStreetMap::WriteSnapshot(std::shared_ptr<CDataSink> sink) const {
+    if (!sink) {
+        return false;
+    }
+    return DImplementation->WriteSnapshot(*sink);
+}
+
+std::shared_ptr<COpenStreetMap> COpenStreetMap::LoadSnapshot(std::shared_ptr<CDataSource> src) {
+    if (!src) {
+        return nullptr;
+    }
+    std::shared_ptr<COpenStreetMap> Map(new COpenStreetMap());
+    auto &Storage = *Map->DImplementation->Storage;
+    const char *Data;
+    std::size_t Size;
+    if (src->View(Data, Size) && (reinterpret_cast<std::uintptr_t>(Data) % SImplementation::SnapshotAlignment == 0)) {
+        // mapped or in-memory snapshots are used in place
+        Storage.Snapshot = src;
+    } else {
+        // anything else is copied into an aligned buffer first
+        std::vector<char> Block;
+        std::vector<char> Contents;
+        while (src->Read(Block, 1 << 20)) {
+            Contents.insert(Contents.end(), Block.begin(), Block.end());
+        }
+        Storage.SnapshotCopy.resize((Contents.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        if (!Contents.empty()) {
+            std::memcpy(Storage.SnapshotCopy.data(), Contents.data(), Contents.size());
+        }
+        Data = reinterpret_cast<const char *>(Storage.SnapshotCopy.data());
+        Size = Contents.size();
+    }
+    if (!Map->DImplementation->AttachSnapshot(Data, Size)) {
+        return nullptr;
+    }
+    Map->UpdateColumns();
+    return Map;
+}
+
+// points the handle columns at the sealed or attached storage
+void COpenStreetMap::UpdateColumns() {
+    const auto &Nodes = DImplementation->Storage->Nodes;
+    const auto &Ways = DImplementation->Storage->Ways;
+    DColumns.DNodeIDs = Nodes.IDs.begin();
+    DColumns.DLatitudes = Nodes.Latitudes.begin();
+    DColumns.DLongitudes = Nodes.Longitudes.begin();
+    DColumns.DNodeCount = Nodes.IDs.size();
+    DColumns.DWayIDs = Ways.IDs.begin();
+    DColumns.DWayNodeOffsets = Ways.NodeOffsets.begin();
+    DColumns.DWayNodeIDs = Ways.NodeIDs.begin();
+    DColumns.DWayCount = Ways.IDs.size();
+}
+
 // total count of nodes
 std::size_t COpenStreetMap::NodeCount() const noexcept {
-    return DImplementation->Nodes.size();  // return the number of nodes
+    return DImplementation->Storage->Nodes.IDs.size();  // return the number of nodes
 }
 
 // total count of ways
 std::size_t COpenStreetMap::WayCount() const noexcept {
-    return DImplementation->Ways.size();  // return the number of ways
+    return DImplementation->Storage->Ways.IDs.size();  // return the number of ways
 }
 
 // get node by index
 std::shared_ptr<CStreetMap::SNode> COpenStreetMap::NodeByIndex(std::size_t index) const noexcept {
-    if (index < DImplementation->Nodes.size()) {  // check if index is valid
-        return DImplementation->Nodes[index];  // return the node
+    if (index < NodeCount()) {  // check if index is valid
+        return std::make_shared<SImplementation::MapNode>(DImplementation->Storage, index);  // return a proxy for the node
     }
     return nullptr;  // if index is out of bounds, return null
 }
 
 // get node by ID
 std::shared_ptr<CStreetMap::SNode> COpenStreetMap::NodeByID(TNodeID id) const noexcept {
-    for (auto& node : DImplementation->Nodes) {  // loop through all nodes
-        if (node->ID() == id) {  // if the ID matches
-            return node;  // return the node
-        }
+    const auto &Nodes = DImplementation->Storage->Nodes;
+    std::size_t Index;
+    if (SImplementation::FindByID(Nodes.IDs, Nodes.IDOrder, id, Index)) {  // look up the index of the node
+        return std::make_shared<SImplementation::MapNode>(DImplementation->Storage, Index);  // return a proxy for the node
     }
     return nullptr;  // if no match, return null
 }
 
 // get way by index
 std::shared_ptr<CStreetMap::SWay> COpenStreetMap::WayByIndex(std::size_t index) const noexcept {
-    if (index < DImplementation->Ways.size()) {  // check if index is valid
-        return DImplementation->Ways[index];  // return the way
+    if (index < WayCount()) {  // check if index is valid
+        return std::make_shared<SImplementation::MapWay>(DImplementation->Storage, index);  // return a proxy for the way
     }
     return nullptr;  // if index is out of bounds, return null
 }
 
 // get way by ID
 std::shared_ptr<CStreetMap::SWay> COpenStreetMap::WayByID(TWayID id) const noexcept {
-    for (auto& way : DImplementation->Ways) {  // loop through all ways
-        if (way->ID() == id) {  // if the ID matches
-            return way;  // return the way
-        }
+    const auto &Ways = DImplementation->Storage->Ways;
+    std::size_t Index;
+    if (SImplementation::FindByID(Ways.IDs, Ways.IDOrder, id, Index)) {  // look up the index of the way
+        return std::make_shared<SImplementation::MapWay>(DImplementation->Storage, Index);  // return a proxy for the way
     }
     return nullptr;  // if no match, return null
 }
+
+// handle lookups, same searches as above without allocating a proxy
+COpenStreetMap::CNodeHandle COpenStreetMap::NodeHandleByIndex(std::size_t index) const noexcept {
+    return index < NodeCount() ? CNodeHandle(this, index) : CNodeHandle();
+}
+
+COpenStreetMap::CNodeHandle COpenStreetMap::NodeHandleByID(TNodeID id) const noexcept {
+    const auto &Nodes = DImplementation->Storage->Nodes;
+    std::size_t Index;
+    return SImplementation::FindByID(Nodes.IDs, Nodes.IDOrder, id, Index) ? CNodeHandle(this, Index) : CNodeHandle();
+}
+
+COpenStreetMap::CWayHandle COpenStreetMap::WayHandleByIndex(std::size_t index) const noexcept {
+    return index < WayCount() ? CWayHandle(this, index) : CWayHandle();
+}
+
+COpenStreetMap::CWayHandle COpenStreetMap::WayHandleByID(TWayID id) const noexcept {
+    const auto &Ways = DImplementation->Storage->Ways;
+    std::size_t Index;
+    return SImplementation::FindByID(Ways.IDs, Ways.IDOrder, id, Index) ? CWayHandle(this, Index) : CWayHandle();
+}
+
+COpenStreetMap::CRange<COpenStreetMap::CNodeHandle> COpenStreetMap::Nodes() const noexcept {
+    return CRange<CNodeHandle>(this, NodeCount());
+}
+
+COpenStreetMap::CRange<COpenStreetMap::CWayHandle> COpenStreetMap::Ways() const noexcept {
+    return CRange<CWayHandle>(this, WayCount());
+}
+
+// attribute access through handles goes to the same tag tables as the proxies
+std::size_t COpenStreetMap::CNodeHandle::AttributeCount() const noexcept {
+    return SImplementation::SStorage::TagCount(DMap->DImplementation->Storage->Nodes.Tags, DIndex);
+}
+
+std::string COpenStreetMap::CNodeHandle::GetAttributeKey(std::size_t index) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.TagKey(Storage.Nodes.Tags, DIndex, index);
+}
+
+std::string COpenStreetMap::CNodeHandle::GetAttributeValue(std::size_t index) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.TagValueAt(Storage.Nodes.Tags, DIndex, index);
+}
+
+bool COpenStreetMap::CNodeHandle::HasAttribute(const std::string &key) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.FindTag(Storage.Nodes.Tags, DIndex, key) < Storage.Nodes.Tags.Offsets[DIndex + 1];
+}
+
+std::string COpenStreetMap::CNodeHandle::GetAttribute(const std::string &key) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.TagValue(Storage.Nodes.Tags, DIndex, key);
+}
+
+std::size_t COpenStreetMap::CWayHandle::AttributeCount() const noexcept {
+    return SImplementation::SStorage::TagCount(DMap->DImplementation->Storage->Ways.Tags, DIndex);
+}
+
+std::string COpenStreetMap::CWayHandle::GetAttributeKey(std::size_t index) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.TagKey(Storage.Ways.Tags, DIndex, index);
+}
+
+std::string COpenStreetMap::CWayHandle::GetAttributeValue(std::size_t index) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.TagValueAt(Storage.Ways.Tags, DIndex, index);
+}
+
+bool COpenStreetMap::CWayHandle::HasAttribute(const std::string &key) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.FindTag(Storage.Ways.Tags, DIndex, key) < Storage.Ways.Tags.Offsets[DIndex + 1];
+}
+
+std::string COpenStreetMap::CWayHandle::GetAttribute(const std::string &key) const noexcept {
+    const auto &Storage = *DMap->DImplementation->Storage;
+    return Storage.TagValue(Storage.Ways.Tags, DIndex, key);
+}
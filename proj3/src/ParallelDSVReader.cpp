@@ -0,0 +1,232 @@
+#include "ParallelDSVReader.h"
+#include "DSVReader.h"
+#include "CharacterScan.h"
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <thread>
+
+namespace{
+
+// Non-owning source over one chunk of the input, the view lets CDSVReader parse it in place
+class CSpanDataSource : public CDataSource{
+    private:
+        const char *DData;
+        std::size_t DSize;
+        std::size_t DIndex;
+    public:
+        CSpanDataSource(const char *data, std::size_t size) : DData(data), DSize(size), DIndex(0){}
+
+        bool End() const noexcept override{
+            return DIndex >= DSize;
+        }
+
+        bool Get(char &ch) noexcept override{
+            if(DIndex < DSize){
+                ch = DData[DIndex++];
+                return true;
+            }
+            return false;
+        }
+
+        bool Peek(char &ch) noexcept override{
+            if(DIndex < DSize){
+                ch = DData[DIndex];
+                return true;
+            }
+            return false;
+        }
+
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override{
+            std::size_t Length = std::min(count, DSize - DIndex);
+            buf.assign(DData + DIndex, DData + DIndex + Length);
+            DIndex += Length;
+            return !buf.empty();
+        }
+
+        bool View(const char *&data, std::size_t &size) const noexcept override{
+            data = DData + DIndex;
+            size = DSize - DIndex;
+            return true;
+        }
+
+        std::size_t Skip(std::size_t count) noexcept override{
+            std::size_t Length = std::min(count, DSize - DIndex);
+            DIndex += Length;
+            return Length;
+        }
+};
+
+}
+
+struct CParallelDSVReader::SImplementation{
+    // result of the first pass over a chunk, row ends are found for both
+    // possible quote states at the start of the chunk since it is not known yet
+    struct SChunkScan{
+        bool OddQuotes;
+        std::size_t RowStart[2];
+    };
+
+    std::shared_ptr<CDataSource> InputSource;
+    char Separator;
+    std::size_t ThreadCount;
+    std::size_t ChunkSize;
+    std::vector<char> OwnedData;  // copy of the input for sources without a view
+    const char *Data;
+    std::size_t Size;
+    std::vector<std::size_t> Boundaries;  // row aligned chunk edges, first is 0 and last is Size
+
+    SImplementation(std::shared_ptr<CDataSource> src, char separator, std::size_t threadcount, std::size_t chunksize)
+        : InputSource(std::move(src)), Separator(separator), ThreadCount(threadcount), ChunkSize(chunksize ? chunksize : 1), Data(nullptr), Size(0){
+        if(ThreadCount == 0){
+            ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        if(InputSource && InputSource->View(Data, Size)){
+            InputSource->Skip(Size);
+        }
+        else if(InputSource){
+            std::vector<char> Block;
+            while(InputSource->Read(Block, ChunkSize)){
+                OwnedData.insert(OwnedData.end(), Block.begin(), Block.end());
+            }
+            Data = OwnedData.data();
+            Size = OwnedData.size();
+        }
+        FindBoundaries();
+    }
+
+    // runs task(index) for every index below count on the worker threads
+    template <typename TTask>
+    void RunParallel(std::size_t count, TTask task){
+        std::atomic<std::size_t> NextIndex(0);
+        auto Worker = [&](){
+            for(std::size_t Index = NextIndex++; Index < count; Index = NextIndex++){
+                task(Index);
+            }
+        };
+        std::vector<std::thread> Threads;
+        for(std::size_t Index = 1; Index < std::min(ThreadCount, count); Index++){
+            Threads.emplace_back(Worker);
+        }
+        Worker();
+        for(auto &Thread : Threads){
+            Thread.join();
+        }
+    }
+
+    // position just past the row end at index, a CR LF pair ends the row after the LF
+    std::size_t AfterRowEnd(std::size_t index) const{
+        if((Data[index] == '\r') && (index + 1 < Size) && (Data[index + 1] == '\n')){
+            return index + 2;
+        }
+        return index + 1;
+    }
+
+    // speculative first pass: counts quotes and finds the first row end assuming the
+    // chunk starts outside and inside of quotes
+    SChunkScan ScanChunk(std::size_t begin, std::size_t end) const{
+        SChunkScan Scan{false, {Size, Size}};
+        const char Specials[] = {'"', '\n', '\r'};
+        const char *Current = Data + begin;
+        const char *Last = Data + end;
+        bool Found[2] = {false, false};
+        while(Current < Last){
+            Current = CharacterScan::FindAny(Current, Last, Specials, 3);
+            if(Current == Last){
+                break;
+            }
+            if(*Current == '"'){
+                Scan.OddQuotes = !Scan.OddQuotes;
+            }
+            else if(!Found[Scan.OddQuotes]){
+                // a row ends here if the quotes before it in the row are balanced
+                Found[Scan.OddQuotes] = true;
+                Scan.RowStart[Scan.OddQuotes] = AfterRowEnd(Current - Data);
+                if(Found[!Scan.OddQuotes]){
+                    // both starts resolved, only the quote count is still needed
+                    const char Quote[] = {'"'};
+                    for(Current++; (Current = CharacterScan::FindAny(Current, Last, Quote, 1)) < Last; Current++){
+                        Scan.OddQuotes = !Scan.OddQuotes;
+                    }
+                    break;
+                }
+            }
+            Current++;
+        }
+        return Scan;
+    }
+
+    void FindBoundaries(){
+        std::size_t ChunkCount = std::max<std::size_t>(1, (Size + ChunkSize - 1) / ChunkSize);
+        std::vector<SChunkScan> Scans(ChunkCount);
+        RunParallel(ChunkCount, [&](std::size_t index){
+            Scans[index] = ScanChunk(index * Size / ChunkCount, (index + 1) * Size / ChunkCount);
+        });
+        // resolve the real quote state at each chunk start and keep the row aligned edges
+        Boundaries.push_back(0);
+        bool InsideQuotes = Scans[0].OddQuotes;
+        for(std::size_t Index = 1; Index < ChunkCount; Index++){
+            std::size_t RowStart = Scans[Index].RowStart[InsideQuotes];
+            if((RowStart < Size) && (RowStart > Boundaries.back())){
+                Boundaries.push_back(RowStart);
+            }
+            InsideQuotes ^= Scans[Index].OddQuotes;
+        }
+        if(Size > 0){
+            Boundaries.push_back(Size);
+        }
+    }
+
+    bool ReadChunk(std::size_t index, TRows &rows) const{
+        CDSVReader Reader(std::make_shared<CSpanDataSource>(Data + Boundaries[index], Boundaries[index + 1] - Boundaries[index]), Separator);
+        rows.emplace_back();
+        while(Reader.ReadRow(rows.back())){
+            rows.emplace_back();
+        }
+        rows.pop_back();
+        return true;
+    }
+};
+
+CParallelDSVReader::CParallelDSVReader(std::shared_ptr<CDataSource> src, char delimiter, std::size_t threadcount, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(src), delimiter, threadcount, chunksize)){
+}
+
+CParallelDSVReader::~CParallelDSVReader() = default;
+
+std::size_t CParallelDSVReader::ThreadCount() const{
+    return DImplementation->ThreadCount;
+}
+
+std::size_t CParallelDSVReader::ChunkCount() const{
+    return DImplementation->Boundaries.empty() ? 0 : DImplementation->Boundaries.size() - 1;
+}
+
+bool CParallelDSVReader::ReadAll(TRows &rows){
+    std::vector<TRows> ChunkRows(ChunkCount());
+    DImplementation->RunParallel(ChunkRows.size(), [&](std::size_t index){
+        DImplementation->ReadChunk(index, ChunkRows[index]);
+    });
+    rows.clear();
+    std::size_t RowCount = 0;
+    for(auto &Chunk : ChunkRows){
+        RowCount += Chunk.size();
+    }
+    rows.reserve(RowCount);
+    for(auto &Chunk : ChunkRows){
+        std::move(Chunk.begin(), Chunk.end(), std::back_inserter(rows));
+    }
+    return !rows.empty();
+}
+
+bool CParallelDSVReader::ForEachChunk(TChunkCallback callback){
+    if(!callback){
+        return false;
+    }
+    DImplementation->RunParallel(ChunkCount(), [&](std::size_t index){
+        TRows Rows;
+        DImplementation->ReadChunk(index, Rows);
+        callback(index, Rows);
+    });
+    return ChunkCount() > 0;
+}
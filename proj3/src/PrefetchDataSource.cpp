@@ -0,0 +1,162 @@
+#include "PrefetchDataSource.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+struct CPrefetchDataSource::SImplementation{
+    std::shared_ptr<CDataSource> Source;
+    std::size_t BlockSize;
+    std::vector< std::vector<char> > Blocks;  // the ring, block i lives in Blocks[i % size]
+    std::atomic<std::size_t> Head{0};  // next block the consumer takes, only the consumer writes it
+    std::atomic<std::size_t> Tail{0};  // next block the reader fills, only the reader writes it
+    std::atomic<bool> Done{false};  // the reader hit the end of the source
+    std::atomic<bool> Stop{false};  // the wrapper is going away
+    bool HasBlock = false;  // the consumer is working on block Head
+    std::size_t Offset = 0;  // consumer position in that block
+    std::thread Reader;
+
+    SImplementation(std::shared_ptr<CDataSource> source, std::size_t blocksize, std::size_t blockcount)
+        : Source(std::move(source)), BlockSize(blocksize ? blocksize : 1), Blocks(blockcount ? blockcount : 1){
+        if(!Source){
+            Done = true;
+            return;
+        }
+        Reader = std::thread([this](){
+            Prefetch();
+        });
+    }
+
+    ~SImplementation(){
+        Stop.store(true, std::memory_order_release);
+        if(Reader.joinable()){
+            Reader.join();
+        }
+    }
+
+    // Spins briefly and then backs off, both sides only wait when the other is behind
+    static void Pause(std::size_t &rounds){
+        if(++rounds < 64){
+            std::this_thread::yield();
+        }
+        else{
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    // Reader thread, fills free blocks until the source ends
+    void Prefetch(){
+        std::size_t Next = 0;
+        while(true){
+            std::size_t Rounds = 0;
+            while(Next - Head.load(std::memory_order_acquire) == Blocks.size()){
+                if(Stop.load(std::memory_order_acquire)){
+                    return;
+                }
+                Pause(Rounds);
+            }
+            if(Stop.load(std::memory_order_acquire)){
+                return;
+            }
+            if(!Source->Read(Blocks[Next % Blocks.size()], BlockSize)){
+                Done.store(true, std::memory_order_release);
+                return;
+            }
+            Tail.store(++Next, std::memory_order_release);
+        }
+    }
+
+    // Makes sure the current block has bytes left, waiting for the reader if
+    // needed, returns false once everything was consumed
+    bool Acquire(){
+        while(true){
+            std::size_t Current = Head.load(std::memory_order_relaxed);
+            if(HasBlock){
+                if(Offset < Blocks[Current % Blocks.size()].size()){
+                    return true;
+                }
+                // hand the used block back to the reader
+                HasBlock = false;
+                Offset = 0;
+                Head.store(++Current, std::memory_order_release);
+            }
+            std::size_t Rounds = 0;
+            while(Tail.load(std::memory_order_acquire) == Current){
+                if(Done.load(std::memory_order_acquire)){
+                    // the reader may have published a last block just before finishing
+                    if(Tail.load(std::memory_order_acquire) == Current){
+                        return false;
+                    }
+                    break;
+                }
+                Pause(Rounds);
+            }
+            HasBlock = true;
+        }
+    }
+
+    std::vector<char> &CurrentBlock(){
+        return Blocks[Head.load(std::memory_order_relaxed) % Blocks.size()];
+    }
+
+    // Gives the consumer's position back once a block was taken over whole
+    void ReleaseBlock(){
+        HasBlock = false;
+        Offset = 0;
+        Head.store(Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+};
+
+CPrefetchDataSource::CPrefetchDataSource(std::shared_ptr<CDataSource> source, std::size_t blocksize, std::size_t blockcount)
+    : DImplementation(std::make_unique<SImplementation>(std::move(source), blocksize, blockcount)){
+}
+
+CPrefetchDataSource::~CPrefetchDataSource() = default;
+
+// The wait for the next block changes no visible state, so End stays const
+bool CPrefetchDataSource::End() const noexcept{
+    return !DImplementation->Acquire();
+}
+
+bool CPrefetchDataSource::Get(char &ch) noexcept{
+    if(!DImplementation->Acquire()){
+        return false;
+    }
+    ch = DImplementation->CurrentBlock()[DImplementation->Offset++];
+    return true;
+}
+
+bool CPrefetchDataSource::Peek(char &ch) noexcept{
+    if(!DImplementation->Acquire()){
+        return false;
+    }
+    ch = DImplementation->CurrentBlock()[DImplementation->Offset];
+    return true;
+}
+
+bool CPrefetchDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
+    buf.clear();
+    while((buf.size() < count) && DImplementation->Acquire()){
+        auto &Block = DImplementation->CurrentBlock();
+        if(buf.empty() && (DImplementation->Offset == 0) && (Block.size() <= count)){
+            // take the block as is, the reader refills the caller's old vector instead
+            buf.swap(Block);
+            DImplementation->ReleaseBlock();
+            continue;
+        }
+        std::size_t Length = std::min(count - buf.size(), Block.size() - DImplementation->Offset);
+        buf.insert(buf.end(), Block.begin() + DImplementation->Offset, Block.begin() + DImplementation->Offset + Length);
+        DImplementation->Offset += Length;
+    }
+    return !buf.empty();
+}
+
+std::size_t CPrefetchDataSource::Skip(std::size_t count) noexcept{
+    std::size_t Skipped = 0;
+    while((Skipped < count) && DImplementation->Acquire()){
+        std::size_t Length = std::min(count - Skipped, DImplementation->CurrentBlock().size() - DImplementation->Offset);
+        DImplementation->Offset += Length;
+        Skipped += Length;
+    }
+    return Skipped;
+}
@@ -0,0 +1,281 @@
+#include "RoutingGraph.h"
+#include "GeographicUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <tuple>
+
+struct CRoutingGraph::CWorkspace::SImplementation{
+    // search labels, only valid for vertices whose stamp matches the current search
+    std::vector<double> Distances;
+    std::vector<TVertex> Parents;
+    std::vector<uint32_t> Stamps;
+    uint32_t Stamp = 0;
+    std::vector<std::pair<double, TVertex>> Heap;  // min heap of (key, vertex), stale entries are skipped
+
+    // starts a new search without clearing the labels of the last one
+    void Reset(std::size_t vertexcount){
+        if(Stamps.size() < vertexcount){
+            Distances.resize(vertexcount);
+            Parents.resize(vertexcount);
+            Stamps.resize(vertexcount, 0);
+        }
+        if(++Stamp == 0){
+            // the stamp wrapped, so old labels could look current
+            std::fill(Stamps.begin(), Stamps.end(), 0);
+            Stamp = 1;
+        }
+        Heap.clear();
+    }
+
+    double Distance(TVertex vertex) const{
+        return Stamps[vertex] == Stamp ? Distances[vertex] : NoPathExists;
+    }
+
+    void Label(TVertex vertex, double distance, TVertex parent){
+        Stamps[vertex] = Stamp;
+        Distances[vertex] = distance;
+        Parents[vertex] = parent;
+    }
+
+    void Push(double key, TVertex vertex){
+        Heap.emplace_back(key, vertex);
+        std::push_heap(Heap.begin(), Heap.end(), std::greater<std::pair<double, TVertex>>());
+    }
+
+    std::pair<double, TVertex> Pop(){
+        std::pop_heap(Heap.begin(), Heap.end(), std::greater<std::pair<double, TVertex>>());
+        auto Top = Heap.back();
+        Heap.pop_back();
+        return Top;
+    }
+};
+
+CRoutingGraph::CWorkspace::CWorkspace() : DImplementation(std::make_unique<SImplementation>()){
+}
+
+CRoutingGraph::CWorkspace::~CWorkspace() = default;
+
+struct CRoutingGraph::SImplementation{
+    using TWorkspace = CWorkspace::SImplementation;
+
+    std::vector<TNodeID> NodeIDs;  // node ID of each vertex, sorted
+    std::vector<double> Positions;  // x, y, z of each vertex on the unit sphere
+    std::vector<uint32_t> EdgeOffsets;  // edges of vertex v are [EdgeOffsets[v], EdgeOffsets[v + 1])
+    std::vector<TVertex> EdgeTargets;
+    std::vector<double> EdgeWeights;
+
+    // ways that carry a highway tag but can not be driven, walked or cycled on
+    static bool Routable(const CStreetMap::SWay &way){
+        if(!way.HasAttribute("highway")){
+            return false;
+        }
+        auto Highway = way.GetAttribute("highway");
+        return (Highway != "proposed") && (Highway != "construction") && (Highway != "abandoned") && (Highway != "platform") && (Highway != "raceway");
+    }
+
+    // returns the allowed directions of the way as (forward, backward)
+    static std::pair<bool, bool> Directions(const CStreetMap::SWay &way){
+        auto OneWay = way.GetAttribute("oneway");
+        if((OneWay == "yes") || (OneWay == "true") || (OneWay == "1")){
+            return {true, false};
+        }
+        if((OneWay == "-1") || (OneWay == "reverse")){
+            return {false, true};
+        }
+        if((OneWay != "no") && (way.GetAttribute("junction") == "roundabout")){
+            return {true, false};  // roundabouts are implied one way
+        }
+        return {true, true};
+    }
+
+    SImplementation(std::shared_ptr<CStreetMap> map){
+        // the vertices are every node on a routable way that the map has a location for
+        std::vector<std::shared_ptr<CStreetMap::SWay>> Ways;
+        for(std::size_t Index = 0; Index < map->WayCount(); Index++){
+            auto Way = map->WayByIndex(Index);
+            if(Routable(*Way)){
+                for(std::size_t NodeIndex = 0; NodeIndex < Way->NodeCount(); NodeIndex++){
+                    NodeIDs.push_back(Way->GetNodeID(NodeIndex));
+                }
+                Ways.push_back(Way);
+            }
+        }
+        std::sort(NodeIDs.begin(), NodeIDs.end());
+        NodeIDs.erase(std::unique(NodeIDs.begin(), NodeIDs.end()), NodeIDs.end());
+        std::vector<CStreetMap::TLocation> Locations;
+        std::size_t Kept = 0;
+        for(auto NodeID : NodeIDs){
+            auto Node = map->NodeByID(NodeID);
+            if(Node){
+                NodeIDs[Kept++] = NodeID;
+                Locations.push_back(Node->Location());
+            }
+        }
+        NodeIDs.resize(Kept);
+        for(auto &Location : Locations){
+            double Latitude = GeographicUtils::DegreesToRadians(Location.first);
+            double Longitude = GeographicUtils::DegreesToRadians(Location.second);
+            Positions.push_back(std::cos(Latitude) * std::cos(Longitude));
+            Positions.push_back(std::cos(Latitude) * std::sin(Longitude));
+            Positions.push_back(std::sin(Latitude));
+        }
+
+        // consecutive way nodes become edges, a missing node breaks the way there
+        std::vector<std::tuple<TVertex, TVertex, double>> Edges;
+        for(auto &Way : Ways){
+            auto Direction = Directions(*Way);
+            TVertex Previous = InvalidVertex;
+            for(std::size_t NodeIndex = 0; NodeIndex < Way->NodeCount(); NodeIndex++){
+                TVertex Current = FindVertex(Way->GetNodeID(NodeIndex));
+                if((Previous != InvalidVertex) && (Current != InvalidVertex) && (Previous != Current)){
+                    double Weight = GeographicUtils::HaversineDistance(Locations[Previous], Locations[Current]);
+                    if(Direction.first){
+                        Edges.emplace_back(Previous, Current, Weight);
+                    }
+                    if(Direction.second){
+                        Edges.emplace_back(Current, Previous, Weight);
+                    }
+                }
+                Previous = Current;
+            }
+        }
+
+        // counting sort of the edges by source vertex
+        EdgeOffsets.assign(NodeIDs.size() + 1, 0);
+        for(auto &Edge : Edges){
+            EdgeOffsets[std::get<0>(Edge) + 1]++;
+        }
+        for(std::size_t Index = 1; Index < EdgeOffsets.size(); Index++){
+            EdgeOffsets[Index] += EdgeOffsets[Index - 1];
+        }
+        EdgeTargets.resize(Edges.size());
+        EdgeWeights.resize(Edges.size());
+        std::vector<uint32_t> Next(EdgeOffsets.begin(), EdgeOffsets.end() - 1);
+        for(auto &Edge : Edges){
+            auto Position = Next[std::get<0>(Edge)]++;
+            EdgeTargets[Position] = std::get<1>(Edge);
+            EdgeWeights[Position] = std::get<2>(Edge);
+        }
+    }
+
+    TVertex FindVertex(TNodeID id) const{
+        auto It = std::lower_bound(NodeIDs.begin(), NodeIDs.end(), id);
+        if((It != NodeIDs.end()) && (*It == id)){
+            return static_cast<TVertex>(It - NodeIDs.begin());
+        }
+        return InvalidVertex;
+    }
+
+    // chord length between the vertices, never more than the great circle distance
+    double StraightLineDistance(TVertex src, TVertex dest) const{
+        double X = Positions[src * 3] - Positions[dest * 3];
+        double Y = Positions[src * 3 + 1] - Positions[dest * 3 + 1];
+        double Z = Positions[src * 3 + 2] - Positions[dest * 3 + 2];
+        return GeographicUtils::EarthRadiusMeters * std::sqrt(X * X + Y * Y + Z * Z);
+    }
+
+    // best first search from src, keyed by the distance so far plus the estimate to dest.
+    // With a zero estimate this is Dijkstra's algorithm.
+    template <bool UseEstimate>
+    double Search(TNodeID srcid, TNodeID destid, std::vector<TNodeID> &path, TWorkspace &workspace) const{
+        path.clear();
+        TVertex Source = FindVertex(srcid);
+        TVertex Destination = FindVertex(destid);
+        if((Source == InvalidVertex) || (Destination == InvalidVertex)){
+            return NoPathExists;
+        }
+        workspace.Reset(NodeIDs.size());
+        workspace.Label(Source, 0.0, InvalidVertex);
+        workspace.Push(UseEstimate ? StraightLineDistance(Source, Destination) : 0.0, Source);
+        while(!workspace.Heap.empty()){
+            auto [Key, Vertex] = workspace.Pop();
+            double Distance = workspace.Distances[Vertex];
+            if(Key > Distance + (UseEstimate ? StraightLineDistance(Vertex, Destination) : 0.0)){
+                continue;  // a shorter way to the vertex was found after this entry was pushed
+            }
+            if(Vertex == Destination){
+                for(TVertex Current = Destination; Current != InvalidVertex; Current = workspace.Parents[Current]){
+                    path.push_back(NodeIDs[Current]);
+                }
+                std::reverse(path.begin(), path.end());
+                return Distance;
+            }
+            for(uint32_t Edge = EdgeOffsets[Vertex]; Edge < EdgeOffsets[Vertex + 1]; Edge++){
+                TVertex Target = EdgeTargets[Edge];
+                double TargetDistance = Distance + EdgeWeights[Edge];
+                if(TargetDistance < workspace.Distance(Target)){
+                    workspace.Label(Target, TargetDistance, Vertex);
+                    workspace.Push(TargetDistance + (UseEstimate ? StraightLineDistance(Target, Destination) : 0.0), Target);
+                }
+            }
+        }
+        return NoPathExists;
+    }
+
+    static TWorkspace &ThreadWorkspace(){
+        thread_local CWorkspace Workspace;
+        return *Workspace.DImplementation;
+    }
+};
+
+CRoutingGraph::CRoutingGraph(std::shared_ptr<CStreetMap> map) : DImplementation(std::make_unique<SImplementation>(map)){
+}
+
+CRoutingGraph::~CRoutingGraph() = default;
+
+std::size_t CRoutingGraph::VertexCount() const noexcept{
+    return DImplementation->NodeIDs.size();
+}
+
+std::size_t CRoutingGraph::EdgeCount() const noexcept{
+    return DImplementation->EdgeTargets.size();
+}
+
+std::size_t CRoutingGraph::EdgeCount(TVertex vertex) const noexcept{
+    if(vertex < VertexCount()){
+        return DImplementation->EdgeOffsets[vertex + 1] - DImplementation->EdgeOffsets[vertex];
+    }
+    return 0;
+}
+
+CRoutingGraph::TVertex CRoutingGraph::EdgeTarget(TVertex vertex, std::size_t index) const noexcept{
+    if(index < EdgeCount(vertex)){
+        return DImplementation->EdgeTargets[DImplementation->EdgeOffsets[vertex] + index];
+    }
+    return InvalidVertex;
+}
+
+double CRoutingGraph::EdgeWeight(TVertex vertex, std::size_t index) const noexcept{
+    if(index < EdgeCount(vertex)){
+        return DImplementation->EdgeWeights[DImplementation->EdgeOffsets[vertex] + index];
+    }
+    return NoPathExists;
+}
+
+CRoutingGraph::TVertex CRoutingGraph::VertexByNodeID(TNodeID id) const noexcept{
+    return DImplementation->FindVertex(id);
+}
+
+CRoutingGraph::TNodeID CRoutingGraph::NodeIDByVertex(TVertex vertex) const noexcept{
+    if(vertex < VertexCount()){
+        return DImplementation->NodeIDs[vertex];
+    }
+    return CStreetMap::InvalidNodeID;
+}
+
+double CRoutingGraph::FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path, CWorkspace &workspace) const{
+    return DImplementation->Search<false>(src, dest, path, *workspace.DImplementation);
+}
+
+double CRoutingGraph::FindShortestPath(TNodeID src, TNodeID dest, std::vector<TNodeID> &path) const{
+    return DImplementation->Search<false>(src, dest, path, SImplementation::ThreadWorkspace());
+}
+
+double CRoutingGraph::FindShortestPathAStar(TNodeID src, TNodeID dest, std::vector<TNodeID> &path, CWorkspace &workspace) const{
+    return DImplementation->Search<true>(src, dest, path, *workspace.DImplementation);
+}
+
+double CRoutingGraph::FindShortestPathAStar(TNodeID src, TNodeID dest, std::vector<TNodeID> &path) const{
+    return DImplementation->Search<true>(src, dest, path, SImplementation::ThreadWorkspace());
+}
@@ -0,0 +1,243 @@
+#include "StreetMapIndex.h"
+#include "GeographicUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <thread>
+
+struct CStreetMapIndex::SImplementation{
+    struct SBox{
+        TLocation LowerLeft;
+        TLocation UpperRight;
+    };
+
+    // pending entry of a nearest search, boxes are expanded before items at the same distance
+    struct SCandidate{
+        double Distance;
+        bool IsItem;
+        std::size_t Level;
+        std::size_t Position;
+        std::size_t Index;  // node index for items
+
+        bool operator>(const SCandidate &other) const{
+            if(Distance != other.Distance){
+                return Distance > other.Distance;
+            }
+            if(IsItem != other.IsItem){
+                return IsItem;
+            }
+            return Index > other.Index;
+        }
+    };
+
+    std::size_t NodeSize;
+    std::vector<SBox> Boxes;  // all levels of the tree, leaves first and the root last
+    std::vector<std::size_t> LevelStarts;  // first box of each level, plus the end of the last level
+    std::vector<std::size_t> Indices;  // node index of each leaf
+
+    SImplementation(std::shared_ptr<CStreetMap> map, std::size_t nodesize) : NodeSize(std::max<std::size_t>(nodesize, 2)){
+        std::vector<TLocation> Locations(map->NodeCount());
+        SBox Extent{{std::numeric_limits<double>::max(), std::numeric_limits<double>::max()}, {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()}};
+        for(std::size_t Index = 0; Index < Locations.size(); Index++){
+            Locations[Index] = map->NodeByIndex(Index)->Location();
+            Extend(Extent, {Locations[Index], Locations[Index]});
+        }
+
+        // sort the nodes along the curve so nearby nodes end up in the same leaves
+        std::vector<std::pair<uint32_t, std::size_t>> Order(Locations.size());
+        for(std::size_t Index = 0; Index < Locations.size(); Index++){
+            Order[Index] = {HilbertIndex(Scale(Locations[Index].first, Extent.LowerLeft.first, Extent.UpperRight.first),
+                                         Scale(Locations[Index].second, Extent.LowerLeft.second, Extent.UpperRight.second)), Index};
+        }
+        std::sort(Order.begin(), Order.end());
+        Indices.reserve(Order.size());
+        for(auto &Entry : Order){
+            Indices.push_back(Entry.second);
+            Boxes.push_back({Locations[Entry.second], Locations[Entry.second]});
+        }
+
+        // pack every NodeSize boxes of a level into a box of the next one up
+        LevelStarts.push_back(0);
+        std::size_t LevelEnd = Boxes.size();
+        while(LevelEnd - LevelStarts.back() > 1){
+            std::size_t LevelStart = LevelStarts.back();
+            for(std::size_t Position = LevelStart; Position < LevelEnd; Position += NodeSize){
+                SBox Box = Boxes[Position];
+                for(std::size_t Child = Position + 1; Child < std::min(Position + NodeSize, LevelEnd); Child++){
+                    Extend(Box, Boxes[Child]);
+                }
+                Boxes.push_back(Box);
+            }
+            LevelStarts.push_back(LevelEnd);
+            LevelEnd = Boxes.size();
+        }
+        LevelStarts.push_back(LevelEnd);
+    }
+
+    static void Extend(SBox &box, const SBox &other){
+        box.LowerLeft.first = std::min(box.LowerLeft.first, other.LowerLeft.first);
+        box.LowerLeft.second = std::min(box.LowerLeft.second, other.LowerLeft.second);
+        box.UpperRight.first = std::max(box.UpperRight.first, other.UpperRight.first);
+        box.UpperRight.second = std::max(box.UpperRight.second, other.UpperRight.second);
+    }
+
+    // maps the value onto the 16 bit grid the curve is drawn on
+    static uint32_t Scale(double value, double minimum, double maximum){
+        if(maximum <= minimum){
+            return 0;
+        }
+        return static_cast<uint32_t>(std::lround((value - minimum) / (maximum - minimum) * 0xFFFF));
+    }
+
+    // position of the grid cell along a Hilbert curve covering the grid
+    static uint32_t HilbertIndex(uint32_t x, uint32_t y){
+        uint32_t Index = 0;
+        for(uint32_t Size = 1 << 15; Size > 0; Size >>= 1){
+            uint32_t QuadrantX = (x & Size) ? 1 : 0;
+            uint32_t QuadrantY = (y & Size) ? 1 : 0;
+            Index += Size * Size * ((3 * QuadrantX) ^ QuadrantY);
+            // rotate the quadrant so the curve stays continuous
+            if(QuadrantY == 0){
+                if(QuadrantX == 1){
+                    x = Size - 1 - (x & (Size - 1));
+                    y = Size - 1 - (y & (Size - 1));
+                }
+                std::swap(x, y);
+            }
+        }
+        return Index;
+    }
+
+    std::size_t Root() const{
+        return Boxes.size() - 1;
+    }
+
+    std::size_t RootLevel() const{
+        return LevelStarts.size() - 2;
+    }
+
+    // calls visit(level, position) for each child of the box
+    template <typename TVisitor>
+    void ForEachChild(std::size_t level, std::size_t position, TVisitor &&visit) const{
+        std::size_t First = LevelStarts[level - 1] + (position - LevelStarts[level]) * NodeSize;
+        std::size_t Last = std::min(First + NodeSize, LevelStarts[level]);
+        for(std::size_t Child = First; Child < Last; Child++){
+            visit(level - 1, Child);
+        }
+    }
+
+    // visits every leaf whose parents all pass the box test
+    template <typename TBoxTest, typename TVisitor>
+    void Search(TBoxTest &&boxtest, TVisitor &&visit) const{
+        if(Indices.empty()){
+            return;
+        }
+        std::vector<std::pair<std::size_t, std::size_t>> Stack{{RootLevel(), Root()}};
+        while(!Stack.empty()){
+            auto [Level, Position] = Stack.back();
+            Stack.pop_back();
+            if(!boxtest(Boxes[Position])){
+                continue;
+            }
+            if(Level == 0){
+                visit(Position);
+            }
+            else{
+                ForEachChild(Level, Position, [&Stack](std::size_t level, std::size_t position){
+                    Stack.emplace_back(level, position);
+                });
+            }
+        }
+    }
+
+    std::vector<std::size_t> Nearest(const TLocation &location, std::size_t count) const{
+        std::vector<std::size_t> Result;
+        if(Indices.empty() || (count == 0)){
+            return Result;
+        }
+        std::priority_queue<SCandidate, std::vector<SCandidate>, std::greater<SCandidate>> Queue;
+        auto Push = [&](std::size_t level, std::size_t position){
+            const SBox &Box = Boxes[position];
+            if(level == 0){
+                Queue.push({GeographicUtils::HaversineDistance(location, Box.LowerLeft), true, level, position, Indices[position]});
+            }
+            else{
+                Queue.push({GeographicUtils::BoxDistance(location, Box.LowerLeft, Box.UpperRight), false, level, position, 0});
+            }
+        };
+        Push(RootLevel(), Root());
+        while(!Queue.empty() && (Result.size() < count)){
+            SCandidate Candidate = Queue.top();
+            Queue.pop();
+            if(Candidate.IsItem){
+                Result.push_back(Candidate.Index);
+            }
+            else{
+                ForEachChild(Candidate.Level, Candidate.Position, Push);
+            }
+        }
+        return Result;
+    }
+};
+
+CStreetMapIndex::CStreetMapIndex(std::shared_ptr<CStreetMap> map, std::size_t nodesize)
+    : DImplementation(std::make_unique<SImplementation>(map, nodesize)){
+}
+
+CStreetMapIndex::~CStreetMapIndex() = default;
+
+std::size_t CStreetMapIndex::NodeCount() const noexcept{
+    return DImplementation->Indices.size();
+}
+
+std::vector<std::size_t> CStreetMapIndex::Nearest(const TLocation &location, std::size_t count) const{
+    return DImplementation->Nearest(location, count);
+}
+
+std::vector<std::size_t> CStreetMapIndex::WithinRadius(const TLocation &location, double meters) const{
+    std::vector<std::size_t> Result;
+    DImplementation->Search([&](const SImplementation::SBox &box){
+        return GeographicUtils::BoxDistance(location, box.LowerLeft, box.UpperRight) <= meters;
+    }, [&](std::size_t position){
+        Result.push_back(DImplementation->Indices[position]);
+    });
+    std::sort(Result.begin(), Result.end());
+    return Result;
+}
+
+std::vector<std::size_t> CStreetMapIndex::WithinBounds(const TLocation &lowerleft, const TLocation &upperright) const{
+    std::vector<std::size_t> Result;
+    DImplementation->Search([&](const SImplementation::SBox &box){
+        return (box.LowerLeft.first <= upperright.first) && (lowerleft.first <= box.UpperRight.first)
+            && (box.LowerLeft.second <= upperright.second) && (lowerleft.second <= box.UpperRight.second);
+    }, [&](std::size_t position){
+        Result.push_back(DImplementation->Indices[position]);
+    });
+    std::sort(Result.begin(), Result.end());
+    return Result;
+}
+
+std::vector< std::vector<std::size_t> > CStreetMapIndex::NearestBatch(const std::vector<TLocation> &locations, std::size_t count, std::size_t threadcount) const{
+    std::vector< std::vector<std::size_t> > Results(locations.size());
+    if(threadcount == 0){
+        threadcount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // the tree is read only, so workers just take the next unanswered location
+    std::atomic<std::size_t> NextIndex(0);
+    auto Worker = [&](){
+        for(std::size_t Index = NextIndex++; Index < locations.size(); Index = NextIndex++){
+            Results[Index] = DImplementation->Nearest(locations[Index], count);
+        }
+    };
+    std::vector<std::thread> Threads;
+    for(std::size_t Index = 1; Index < std::min(threadcount, locations.size()); Index++){
+        Threads.emplace_back(Worker);
+    }
+    Worker();
+    for(auto &Thread : Threads){
+        Thread.join();
+    }
+    return Results;
+}
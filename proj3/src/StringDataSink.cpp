@@ -1,15 +1,88 @@
 #include "StringDataSink.h"
+#include <algorithm>
+
+CStringDataSink::CStringDataSink(EMode mode, std::size_t chunksize) : DMode(mode), DChunkSize(chunksize ? chunksize : 1){
+}
 
 const std::string &CStringDataSink::String() const{
+    if((DMode == EMode::Chunked) && (DString.size() != DSize)){
+        // joined lazily, the copy stays until more is written
+        DString.clear();
+        DString.reserve(DSize);
+        for(auto &Chunk : DChunks){
+            DString += Chunk;
+        }
+    }
     return DString;
 }
 
+std::vector<std::string_view> CStringDataSink::Chunks() const{
+    if(DMode == EMode::String){
+        return DString.empty() ? std::vector<std::string_view>() : std::vector<std::string_view>{DString};
+    }
+    return std::vector<std::string_view>(DChunks.begin(), DChunks.end());
+}
+
+std::size_t CStringDataSink::Size() const noexcept{
+    return DSize;
+}
+
+void CStringDataSink::Reserve(std::size_t capacity){
+    if(DMode == EMode::String){
+        DString.reserve(capacity);
+        return;
+    }
+    // the chunk being filled is the only one that can still grow
+    if(!DChunks.empty() && (DChunks.back().size() < DChunkSize)){
+        DChunks.back().reserve(DChunkSize);
+    }
+    DChunks.reserve(DChunks.size() + (capacity > DSize ? (capacity - DSize) / DChunkSize + 1 : 0));
+}
+
+bool CStringDataSink::Append(const char *data, std::size_t length) noexcept{
+    try{
+        if(DMode == EMode::String){
+            DString.append(data, length);
+            DSize += length;
+            return true;
+        }
+        while(length){
+            if(DChunks.empty() || (DChunks.back().size() == DChunkSize)){
+                DChunks.emplace_back();
+                DChunks.back().reserve(DChunkSize);
+            }
+            std::size_t Count = std::min(length, DChunkSize - DChunks.back().size());
+            DChunks.back().append(data, Count);
+            DSize += Count;
+            data += Count;
+            length -= Count;
+        }
+        return true;
+    }
+    catch(...){
+        return false;
+    }
+}
+
 bool CStringDataSink::Put(const char &ch) noexcept{
-    DString += std::string(1,ch);
-    return true;
+    // single characters go straight in while there is room
+    if((DMode == EMode::String) && (DString.size() < DString.capacity())){
+        DString.push_back(ch);
+        DSize++;
+        return true;
+    }
+    if((DMode == EMode::Chunked) && !DChunks.empty() && (DChunks.back().size() < DChunkSize)){
+        DChunks.back().push_back(ch);
+        DSize++;
+        return true;
+    }
+    return Append(&ch, 1);
 }
 
 bool CStringDataSink::Write(const std::vector<char> &buf) noexcept{
-    DString += std::string(buf.data(),buf.size());
-    return true;
+    return Append(buf.data(), buf.size());
+}
+
+bool CStringDataSink::Write(const char *data, std::size_t length) noexcept{
+    return Append(data, length);
 }
@@ -26,15 +26,26 @@ bool CStringDataSource::Peek(char &ch) noexcept{
 }
 
 bool CStringDataSource::Read(std::vector<char> &buf, std::size_t count) noexcept{
-    buf.clear();
-    while(buf.size() < count){
-        char TempChar;
-        if(Get(TempChar)){
-            buf.push_back(TempChar);
-        }
-        else{
-            break;
-        }
+    std::size_t Length = DIndex < DString.length() ? DString.length() - DIndex : 0;
+    if(count < Length){
+        Length = count;
     }
+    buf.assign(DString.data() + DIndex, DString.data() + DIndex + Length);
+    DIndex += Length;
     return !buf.empty();
 }
+
+bool CStringDataSource::View(const char *&data, std::size_t &size) const noexcept{
+    data = DString.data() + DIndex;
+    size = DIndex < DString.length() ? DString.length() - DIndex : 0;
+    return true;
+}
+
+std::size_t CStringDataSource::Skip(std::size_t count) noexcept{
+    std::size_t Length = DIndex < DString.length() ? DString.length() - DIndex : 0;
+    if(count < Length){
+        Length = count;
+    }
+    DIndex += Length;
+    return Length;
+}
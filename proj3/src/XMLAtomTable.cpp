@@ -0,0 +1,41 @@
+#include "XMLAtomTable.h"
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+struct CXMLAtomTable::SImplementation{
+    std::deque<std::string> Names; // atom i names Names[i - 1], a deque so the keys below never move
+    std::unordered_map<std::string_view, TAtom> Atoms;
+};
+
+CXMLAtomTable::CXMLAtomTable() : DImplementation(std::make_unique<SImplementation>()){
+}
+
+CXMLAtomTable::~CXMLAtomTable() = default;
+
+CXMLAtomTable::TAtom CXMLAtomTable::Intern(std::string_view name){
+    auto Search = DImplementation->Atoms.find(name);
+    if(Search != DImplementation->Atoms.end()){
+        return Search->second;
+    }
+    DImplementation->Names.emplace_back(name);
+    TAtom Atom = DImplementation->Names.size();
+    DImplementation->Atoms.emplace(DImplementation->Names.back(), Atom);
+    return Atom;
+}
+
+CXMLAtomTable::TAtom CXMLAtomTable::Find(std::string_view name) const noexcept{
+    auto Search = DImplementation->Atoms.find(name);
+    return Search == DImplementation->Atoms.end() ? SXMLEntity::InvalidAtom : Search->second;
+}
+
+std::string_view CXMLAtomTable::Name(TAtom atom) const noexcept{
+    if((atom == SXMLEntity::InvalidAtom) || (atom > DImplementation->Names.size())){
+        return std::string_view();
+    }
+    return DImplementation->Names[atom - 1];
+}
+
+std::size_t CXMLAtomTable::AtomCount() const noexcept{
+    return DImplementation->Names.size();
+}
@@ -1,55 +1,165 @@
 #include "XMLReader.h"
+#include "XMLAtomTable.h"
 #include <expat.h>
-#include <queue>
 #include <memory>
 #include <vector>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
 
 struct CXMLReader::SImplementation { //implementation for the CXMLReader class 
     std::shared_ptr<CDataSource> InputSource; //this shares the pointer to data source 
     XML_Parser Parser;
-    std::queue<SXMLEntity> EntityBuffer; //a queue to store XML entities 
+    std::vector<SXMLEntity> EntityRing; //a ring of read ahead XML entities, drained slots keep their capacity for reuse
+    std::size_t RingHead = 0; //slot of the oldest entity
+    std::size_t RingCount = 0; //number of entities waiting in the ring
+    std::vector<SXMLEntity::TAttribute> SpareAttributes; //attributes dropped from recycled entities, kept for their string capacity
+    std::size_t MaxAttributes = 0; //most attributes any element had so far
+    static const std::size_t ReadAheadLimit = 256; //expat is paused once this many entities are waiting so the ring stays small
     bool IsDataComplete;
+    bool IsFinishing = false; // the end of the input has been handed to expat
+    bool IsSuspended = false; // expat was paused because enough entities were read ahead
     std::string CharacterBuffer; // a string buffer to accumulate character data 
+    std::size_t ChunkSize; // number of bytes handed to expat at a time
+    std::vector<char> ReadBuffer; // reused block for sources without a contiguous view
+
+    SHandler *Handler = nullptr; // receives the events directly while Parse runs
+    std::shared_ptr<CXMLAtomTable> Atoms; // resolves entity names to atoms when set
+    struct SAtomCacheEntry {
+        std::string Name;
+        SXMLEntity::TAtom Atom = SXMLEntity::InvalidAtom;
+    };
+    std::vector<SAtomCacheEntry> AtomCache; // direct mapped names seen recently, spares hashing the same few names over and over
+
+    //This resolves a name through the cache before going to the table
+    SXMLEntity::TAtom InternName(const char *name) {
+        std::size_t Length = std::strlen(name);
+        std::size_t Slot = Length ? (Length * 31 + static_cast<unsigned char>(name[0]) * 7 + static_cast<unsigned char>(name[Length - 1])) % AtomCache.size() : 0;
+        auto &Entry = AtomCache[Slot];
+        if ((Entry.Atom == SXMLEntity::InvalidAtom) || (Entry.Name.size() != Length) || (std::memcmp(Entry.Name.data(), name, Length) != 0)) {
+            Entry.Name.assign(name, Length);
+            Entry.Atom = Atoms->Intern(Entry.Name);
+        }
+        return Entry.Atom;
+    }
+    std::vector<std::string> ElementFilter; // names of the elements to emit, empty emits everything
+    std::size_t Depth = 0; // number of open elements that were not skipped
+    std::size_t SkipDepth = 0; // number of open elements inside the subtree being skipped
+
+    //This checks an element below the root against the filter
+    bool IsFiltered(const char *ele) const {
+        if (ElementFilter.empty()) {
+            return false;
+        }
+        for (auto &Name : ElementFilter) {
+            if (std::strcmp(Name.c_str(), ele) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //While a subtree is skipped expat only calls these, which just track the depth
+    static void HandleSkippedStartElement(void *data, const char *ele, const char **att) {
+        static_cast<SImplementation *>(data)->SkipDepth++;
+    }
+
+    static void HandleSkippedEndElement(void *data, const char *ele) {
+        auto *instance = static_cast<SImplementation *>(data);
+        if (--instance->SkipDepth == 0) { //The skipped element closed, go back to the normal handlers
+            XML_SetElementHandler(instance->Parser, HandleStartElement, HandleEndElement);
+            XML_SetCharacterDataHandler(instance->Parser, HandleCharacterData);
+        }
+    }
 
     // this function handles start element events from Expat 
     static void HandleStartElement(void *data, const char *ele, const char **att) {
         auto *instance = static_cast<SImplementation *>(data); //This casts user data to SImplementation 
+        bool IsRoot = (instance->Depth == 0);
+        if (!IsRoot && instance->IsFiltered(ele)) { //Unwanted elements below the root are dropped with their whole subtree, text around them runs together
+            instance->SkipDepth = 1;
+            XML_SetElementHandler(instance->Parser, HandleSkippedStartElement, HandleSkippedEndElement);
+            XML_SetCharacterDataHandler(instance->Parser, nullptr);
+            return;
+        }
         instance->ProcessCharacterBuffer();
-        SXMLEntity entity; //Entity created 
-        entity.DType = SXMLEntity::EType::StartElement; //This forms a parsing 
-        entity.DNameData = ele;
+        instance->Depth++;
+        if (IsRoot && instance->IsFiltered(ele)) { //The root still has to be entered to reach its children
+            return;
+        }
+        if (instance->Handler) {
+            instance->Handler->StartElement(ele, att);
+            return;
+        }
+        SXMLEntity &entity = instance->PushEntity(SXMLEntity::EType::StartElement); //Entity reuses a drained slot
+        entity.DNameData.assign(ele);
+        // recycled attribute vectors are sized for the largest element seen so they stop growing quickly
+        if (entity.DAttributes.capacity() < instance->MaxAttributes) {
+            entity.DAttributes.reserve(instance->MaxAttributes);
+        }
 
-        // Parse attributes and pushes onto the the entity 
+        // Parse attributes into the slot, overwriting the strings it already has
+        std::size_t Count = 0;
         if (att != nullptr) {
             for (int i = 0; att[i] != nullptr; i += 2) {
                 if (att[i + 1] != nullptr) {
-                    entity.DAttributes.emplace_back(att[i], att[i + 1]);
+                    if (Count == entity.DAttributes.size()) {
+                        instance->AcquireAttribute(entity);
+                    }
+                    entity.DAttributes[Count].first.assign(att[i]);
+                    entity.DAttributes[Count].second.assign(att[i + 1]);
+                    Count++;
                 }
             }
         }
-
-        instance->EntityBuffer.push(entity);
+        instance->ReleaseAttributes(entity, Count);
+        instance->MaxAttributes = std::max(instance->MaxAttributes, Count);
+        entity.DAttributeAtoms.clear();
+        if (instance->Atoms) { //Intern the names, the attribute atoms line up with the attributes kept above
+            entity.DNameAtom = instance->InternName(ele);
+            for (int i = 0; att != nullptr && att[i] != nullptr; i += 2) {
+                if (att[i + 1] != nullptr) {
+                    entity.DAttributeAtoms.push_back(instance->InternName(att[i]));
+                }
+            }
+        } else {
+            entity.DNameAtom = SXMLEntity::InvalidAtom;
+        }
     }
 
     //This function handles the ending element events from Expat 
     static void HandleEndElement(void *data, const char *ele) {
         auto *instance = static_cast<SImplementation *>(data); //This casts user data to SImplementation pointer 
         instance->ProcessCharacterBuffer();
-        SXMLEntity entity; //We create an entity for the ending element 
-        entity.DType = SXMLEntity::EType::EndElement;
-        entity.DNameData = ele; //This forms the element 
-        instance->EntityBuffer.push(entity); //This pushes the entity 
+        if ((--instance->Depth == 0) && instance->IsFiltered(ele)) {
+            return;
+        }
+        if (instance->Handler) {
+            instance->Handler->EndElement(ele);
+            return;
+        }
+        SXMLEntity &entity = instance->PushEntity(SXMLEntity::EType::EndElement); //We reuse a slot for the ending element 
+        entity.DNameData.assign(ele); //This forms the element 
+        instance->ReleaseAttributes(entity, 0);
+        entity.DAttributeAtoms.clear();
+        entity.DNameAtom = instance->Atoms ? instance->InternName(ele) : SXMLEntity::InvalidAtom;
     }
     //This function works to append the character data to the CharacterData 
     static void HandleCharacterData(void *userData, const char *data, int length) {
         auto *instance = static_cast<SImplementation *>(userData);
         if (data != nullptr && length > 0) { 
+            if (instance->Handler) {
+                instance->ProcessCharacterBuffer();
+                instance->Handler->CharacterData(data, length);
+                return;
+            }
             instance->CharacterBuffer.append(data, length);
         }
     }
 
     //Here, we just initiate the InputSource and set up an Expat parser 
-    SImplementation(std::shared_ptr<CDataSource> source) : InputSource(std::move(source)), IsDataComplete(false) {
+    SImplementation(std::shared_ptr<CDataSource> source, std::size_t chunksize) : InputSource(std::move(source)), IsDataComplete(false), ChunkSize(std::clamp<std::size_t>(chunksize, 1, INT_MAX)) { //expat takes int lengths
         Parser = XML_ParserCreate(nullptr); 
         XML_SetUserData(Parser, this);
         XML_SetElementHandler(Parser, HandleStartElement, HandleEndElement);
@@ -60,70 +170,191 @@ struct CXMLReader::SImplementation { //implementation for the CXMLReader class
         XML_ParserFree(Parser);
     }
 
-    //This accumulates the character data 
+    //This claims the next free slot in the ring, growing it when every slot is in use
+    SXMLEntity &PushEntity(SXMLEntity::EType type) {
+        if (RingCount == EntityRing.size()) {
+            std::rotate(EntityRing.begin(), EntityRing.begin() + RingHead, EntityRing.end());
+            RingHead = 0;
+            EntityRing.resize(std::max<std::size_t>(16, EntityRing.size() * 2));
+        }
+        SXMLEntity &entity = EntityRing[(RingHead + RingCount++) % EntityRing.size()];
+        entity.DType = type;
+        if (RingCount >= ReadAheadLimit) { //One callback can push two entities, so the limit may be stepped over
+            XML_ParsingStatus Status;
+            XML_GetParsingStatus(Parser, &Status);
+            if (Status.parsing == XML_PARSING) {
+                XML_StopParser(Parser, XML_TRUE);
+            }
+        }
+        return entity;
+    }
+
+    //This adds an attribute to the entity, reusing a spare one if there is any
+    void AcquireAttribute(SXMLEntity &entity) {
+        if (SpareAttributes.empty()) {
+            entity.DAttributes.emplace_back();
+        } else {
+            entity.DAttributes.push_back(std::move(SpareAttributes.back()));
+            SpareAttributes.pop_back();
+        }
+    }
+
+    //This trims the entity to count attributes, moving the rest to the spares
+    void ReleaseAttributes(SXMLEntity &entity, std::size_t count) {
+        while (entity.DAttributes.size() > count) {
+            SpareAttributes.push_back(std::move(entity.DAttributes.back()));
+            entity.DAttributes.pop_back();
+        }
+    }
+
+    //This releases the oldest entity, its slot keeps whatever the caller swapped in
+    void PopEntity() {
+        RingHead = (RingHead + 1) % EntityRing.size();
+        RingCount--;
+    }
+
+    //This accumulates the character data, handing it to the handler if Parse switched to one
     void ProcessCharacterBuffer() {
         if (!CharacterBuffer.empty()) {
-            SXMLEntity entity;
-            entity.DType = SXMLEntity::EType::CharData; //Create a CharData entity 
-            entity.DNameData = CharacterBuffer;
-            EntityBuffer.push(entity); //Push the entity and then clear the CharacterBuffer
+            if (Handler) {
+                Handler->CharacterData(CharacterBuffer.data(), CharacterBuffer.size());
+                CharacterBuffer.clear();
+                return;
+            }
+            SXMLEntity &entity = PushEntity(SXMLEntity::EType::CharData); //Create a CharData entity 
+            entity.DNameData.swap(CharacterBuffer); //Swap the text into the entity, the buffer takes over the old string
+            ReleaseAttributes(entity, 0);
+            entity.DAttributeAtoms.clear();
+            entity.DNameAtom = SXMLEntity::InvalidAtom;
             CharacterBuffer.clear();
         }
     }
 
-    //This fetches the SXMLEntity from EntityBuffer and reads more data 
+    //This feeds the next chunk of the input to expat, memory backed sources are
+    //parsed in place and everything else is read in blocks into ReadBuffer, which
+    //is then copied into expat's buffer since CDataSource::Read only fills a vector
+    bool ParseNextChunk() {
+        if (IsSuspended) { //Pick up where expat paused before touching more input
+            return UpdateStatus(XML_ResumeParser(Parser));
+        }
+        const char *Data;
+        std::size_t Size;
+        if (InputSource->View(Data, Size)) {
+            if (Size == 0) {
+                return FinishParsing();
+            }
+            std::size_t Length = std::min(Size, ChunkSize);
+            auto Status = XML_Parse(Parser, Data, static_cast<int>(Length), 0);
+            InputSource->Skip(Length);
+            return UpdateStatus(Status);
+        }
+        if (!InputSource->Read(ReadBuffer, ChunkSize)) { //If we have no bytes to read then end parsing
+            return FinishParsing();
+        }
+        void *ParseBuffer = XML_GetBuffer(Parser, static_cast<int>(ReadBuffer.size()));
+        if (ParseBuffer == nullptr) {
+            return false;
+        }
+        std::memcpy(ParseBuffer, ReadBuffer.data(), ReadBuffer.size());
+        return UpdateStatus(XML_ParseBuffer(Parser, static_cast<int>(ReadBuffer.size()), 0));
+    }
+
+    //No more data to read, this signals the parsing to end 
+    bool FinishParsing() {
+        IsFinishing = true;
+        return UpdateStatus(XML_Parse(Parser, nullptr, 0, 1));
+    }
+
+    //This records whether expat paused, the data is only complete once the final parse ran through
+    bool UpdateStatus(XML_Status status) {
+        IsSuspended = (status == XML_STATUS_SUSPENDED);
+        if (IsFinishing) {
+            IsDataComplete = !IsSuspended;
+            return true;
+        }
+        return status != XML_STATUS_ERROR;
+    }
+
+    //This fetches the SXMLEntity from the EntityRing and reads more data 
     bool FetchEntity(SXMLEntity &entity, bool skipCharacterData) {
-        while (EntityBuffer.empty() && !IsDataComplete) { //While the buffer is empty and data is not complete 
-            std::vector<char> dataChunk(4096); // Use vector for dynamic buffer
-            size_t byteread = 0; 
-            while (byteread < dataChunk.size() && !InputSource->End()) {
-                char byte;
-                if (InputSource->Get(byte)) { //If we get the byte then we increment bytes read more data 
-                    dataChunk[byteread++] = byte; 
-                } else {
-                    break;
+        while (true) {
+            while (RingCount == 0 && !IsDataComplete) { //While the ring is empty and data is not complete 
+                if (!ParseNextChunk()) {
+                    return false;
                 }
             }
 
-            if (byteread == 0) { //If we have no bytes to read then end parsing as 
-                // No more data to read
-                IsDataComplete = true; 
-                XML_Parse(Parser, nullptr, 0, 1); //This signals the parsing to end 
-                break;
+            if (RingCount == 0) {
+                return false; // No more entities to read
             }
+            std::swap(entity, EntityRing[RingHead]); //entity takes the oldest element, the slot recycles the caller's old one 
+            PopEntity(); //This pops the entity from the ring 
 
-            if (XML_Parse(Parser, dataChunk.data(), byteread, 0) == XML_STATUS_ERROR) {
-                // This indicates a status error 
-                return false;
+            // Skip character data if requested
+            if (!skipCharacterData || entity.DType != SXMLEntity::EType::CharData) {
+                return true;
             }
         }
+    }
 
-        if (!EntityBuffer.empty()) { //This checks if the Entity buffer is full 
-            entity = EntityBuffer.front(); //entity is the first element in the front 
-            EntityBuffer.pop(); //This pops the entity buffer 
-
-            // Skip character data if requested
-            if (skipCharacterData && entity.DType == SXMLEntity::EType::CharData) { //This skips 
-                return FetchEntity(entity, skipCharacterData); // Recursively skip character data
+    //This replays entities that were read ahead and then parses the rest straight into the handler
+    bool Parse(SHandler &handler) {
+        std::vector<const char *> Attributes;
+        while (RingCount != 0) {
+            SXMLEntity &entity = EntityRing[RingHead];
+            if (entity.DType == SXMLEntity::EType::StartElement) {
+                Attributes.clear();
+                for (auto &Attribute : entity.DAttributes) {
+                    Attributes.push_back(Attribute.first.c_str());
+                    Attributes.push_back(Attribute.second.c_str());
+                }
+                Attributes.push_back(nullptr);
+                handler.StartElement(entity.DNameData.c_str(), Attributes.data());
+            } else if (entity.DType == SXMLEntity::EType::EndElement) {
+                handler.EndElement(entity.DNameData.c_str());
+            } else {
+                handler.CharacterData(entity.DNameData.data(), entity.DNameData.size());
             }
-
-            return true;
+            PopEntity();
+        }
+        Handler = &handler;
+        bool Success = true;
+        while (Success && !IsDataComplete) {
+            Success = ParseNextChunk();
         }
+        Handler = nullptr;
+        return Success && (XML_GetErrorCode(Parser) == XML_ERROR_NONE); // a truncated document only fails once finished
 
-        return false; // No more entities to read
     }
 };
 
 //This initializes the DImplementation and with a CDataSource 
-CXMLReader::CXMLReader(std::shared_ptr<CDataSource> source)
-    : DImplementation(std::make_unique<SImplementation>(std::move(source))) {} 
+CXMLReader::CXMLReader(std::shared_ptr<CDataSource> source, std::size_t chunksize)
+    : DImplementation(std::make_unique<SImplementation>(std::move(source), chunksize)) {} 
 
 CXMLReader::~CXMLReader() = default; //Destruct defaulter since it does not require special handling 
 
 bool CXMLReader::End() const { //This returns true if data is complete AND buffer is empty 
-    return DImplementation->IsDataComplete && DImplementation->EntityBuffer.empty();
+    return DImplementation->IsDataComplete && DImplementation->RingCount == 0;
 }
 
 bool CXMLReader::ReadEntity(SXMLEntity &entity, bool skipCharacterData) { //Reads an entity by passing to FetchEntity in DImplementation 
     return DImplementation->FetchEntity(entity, skipCharacterData);
-}
\ No newline at end of file
+}
+
+void CXMLReader::SetElementFilter(const std::vector<std::string> &names) { //Replaces the names of the elements to emit
+    DImplementation->ElementFilter = names;
+}
+
+void CXMLReader::SetAtomTable(std::shared_ptr<CXMLAtomTable> atoms) { //Sets the table entity names are interned into
+    DImplementation->Atoms = std::move(atoms);
+    DImplementation->AtomCache.assign(64, SImplementation::SAtomCacheEntry());
+}
+
+std::shared_ptr<CXMLAtomTable> CXMLReader::AtomTable() const {
+    return DImplementation->Atoms;
+}
+
+bool CXMLReader::Parse(SHandler &handler) { //Parses the rest of the input into the handler
+    return DImplementation->Parse(handler);
+}
@@ -1,37 +1,88 @@
 #include "XMLWriter.h"
-#include <stack>
+#include "CharacterScan.h"
+#include <cstring>
 #include <string>
 #include <deque>
+#include <vector>
 
 struct CXMLWriter::SImplementation {
     std::shared_ptr<CDataSink> OutputSink;  // holds the output sink for writing data
     std::deque<std::string> OpenElements;   // keeps track of open elements using a deque instead of a stack
+    std::vector<char> Buffer;               // output collected here and handed to the sink in blocks
+    std::size_t BufferUsed = 0;             // bytes of Buffer holding output
+    std::size_t BufferSize;                 // the buffer is written out once it holds this many bytes
 
-    SImplementation(std::shared_ptr<CDataSink> sink)
-        : OutputSink(sink) {
+    SImplementation(std::shared_ptr<CDataSink> sink, std::size_t buffersize)
+        : OutputSink(sink), BufferSize(buffersize ? buffersize : 1) {
+        Buffer.resize(BufferSize);
+    }
+
+    // hands the buffered output to the sink, returns false if it fails
+    bool FlushBuffer() {
+        if (BufferUsed == 0) {
+            return true;
+        }
+        Buffer.resize(BufferUsed);  // the sink takes the whole vector
+        bool Success = OutputSink->Write(Buffer);
+        Buffer.resize(BufferSize);
+        BufferUsed = 0;
+        return Success;
+    }
+
+    // appends length bytes to the buffer, writing it out when it is full
+    bool WriteToSink(const char *data, std::size_t length) {
+        if (BufferUsed + length > Buffer.size()) {
+            Buffer.resize(BufferUsed + length);  // a single piece larger than the buffer
+        }
+        std::memcpy(Buffer.data() + BufferUsed, data, length);
+        BufferUsed += length;
+        return (BufferUsed < BufferSize) || FlushBuffer();
     }
 
     // str to the output sink, returns false if it fails
     bool WriteToSink(const std::string &content) {
-        for (char ch : content) {
-            if (!OutputSink->Put(ch)) {
-                return false;
-            }
+        return WriteToSink(content.data(), content.size());
+    }
+
+    template <std::size_t N>
+    bool WriteToSink(const char (&literal)[N]) {
+        return WriteToSink(literal, N - 1);
+    }
+
+    // finds the next character that needs escaping, short text is checked a byte
+    // at a time since setting up the vector search would cost more
+    static const char *FindSpecial(const char *begin, const char *end) {
+        static const char Special[] = {'<', '>', '&', '\'', '"'};
+        if (end - begin >= 32) {
+            return CharacterScan::FindAny(begin, end, Special, sizeof(Special));
         }
-        return true;
+        while ((begin < end) && (*begin != '<') && (*begin != '>') && (*begin != '&') && (*begin != '\'') && (*begin != '"')) {
+            begin++;
+        }
+        return begin;
     }
 
-    // escapes special xml characters and writes them to the sink
+    // escapes special xml characters and writes them to the sink, runs of
+    // ordinary characters between them are copied in one go
     bool EscapeAndWrite(const std::string &text) {
-        for (char ch : text) {
-            switch (ch) {
+        const char *Current = text.data();
+        const char *End = Current + text.size();
+        while (Current < End) {
+            const char *Next = FindSpecial(Current, End);
+            if ((Next != Current) && !WriteToSink(Current, Next - Current)) {
+                return false;  // write normal chars
+            }
+            if (Next == End) {
+                break;
+            }
+            switch (*Next) {
                 case '<': if (!WriteToSink("&lt;")) return false; break;  // escape <
                 case '>': if (!WriteToSink("&gt;")) return false; break;  
                 case '&': if (!WriteToSink("&amp;")) return false; break;  
                 case '\'': if (!WriteToSink("&apos;")) return false; break;  // escape '
-                case '"': if (!WriteToSink("&quot;")) return false; break;  // escape "
-                default: if (!WriteToSink(std::string(1, ch))) return false; break;  // write normal chars
+                default: if (!WriteToSink("&quot;")) return false; break;  // escape "
             }
+            Current = Next + 1;
         }
         return true;
     }
@@ -100,14 +151,17 @@ struct CXMLWriter::SImplementation {
     }
 };
 
-CXMLWriter::CXMLWriter(std::shared_ptr<CDataSink> sink)
-    : DImplementation(std::make_unique<SImplementation>(sink)) {
+CXMLWriter::CXMLWriter(std::shared_ptr<CDataSink> sink, std::size_t buffersize)
+    : DImplementation(std::make_unique<SImplementation>(sink, buffersize)) {
 }
 
-CXMLWriter::~CXMLWriter() = default;
+CXMLWriter::~CXMLWriter() {
+    DImplementation->FlushBuffer();  // whatever is still buffered goes out, open elements stay open
+}
 
 bool CXMLWriter::Flush() {
-    return DImplementation->CloseAllElements();  // flush all open elements
+    bool Closed = DImplementation->CloseAllElements();  // flush all open elements
+    return DImplementation->FlushBuffer() && Closed;
 }
 
 bool CXMLWriter::WriteEntity(const SXMLEntity &entity) {
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "CSVBusSystem.h"
+#include "DSVReader.h"
+#include "MMapDataSource.h"
+#include "StringDataSource.h"
+#include <memory>
+
+// Loads the bus system through the real DSV reader rather than a mock
+TEST(CSVBusSystemData, DavisTest){
+    auto StopReader = std::make_shared<CDSVReader>(std::make_shared<CMMapDataSource>("data/stops.csv"), ',');
+    auto RouteReader = std::make_shared<CDSVReader>(std::make_shared<CMMapDataSource>("data/routes.csv"), ',');
+    CCSVBusSystem BusSystem(StopReader, RouteReader);
+
+    EXPECT_EQ(BusSystem.StopCount(), 298);
+    EXPECT_EQ(BusSystem.RouteCount(), 17);
+    auto Stop = BusSystem.StopByID(22043);
+    ASSERT_NE(Stop, nullptr);
+    EXPECT_EQ(Stop->NodeID(), 2849810514);
+    auto Route = BusSystem.RouteByName("A");
+    ASSERT_NE(Route, nullptr);
+    EXPECT_EQ(Route->StopCount(), 22);
+    EXPECT_EQ(Route->GetStopID(0), 22258);
+    EXPECT_EQ(BusSystem.RouteByName("route"), nullptr);
+}
+
+TEST(CSVBusSystemData, InterleavedRoutesTest){
+    auto StopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("1, 1001\n2,1002\nx,1003\n"), ',');
+    auto RouteReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("R1,1\nR2,2\nR1,2\nR1,bad\n"), ',');
+    CCSVBusSystem BusSystem(StopReader, RouteReader);
+
+    EXPECT_EQ(BusSystem.StopCount(), 2);
+    ASSERT_NE(BusSystem.StopByID(1), nullptr);
+    EXPECT_EQ(BusSystem.StopByID(1)->NodeID(), 1001);
+    auto Route = BusSystem.RouteByName("R1");
+    ASSERT_NE(Route, nullptr);
+    ASSERT_EQ(Route->StopCount(), 2);
+    EXPECT_EQ(Route->GetStopID(0), 1);
+    EXPECT_EQ(Route->GetStopID(1), 2);
+    ASSERT_NE(BusSystem.RouteByName("R2"), nullptr);
+    EXPECT_EQ(BusSystem.RouteByName("R2")->StopCount(), 1);
+}
+
+// IDs read like std::stoul read them, apart from negative IDs which are rejected
+TEST(CSVBusSystemData, IDFormsTest){
+    auto StopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("+1, 1001\n 2,+1002 \n-3,1003\n"), ',');
+    auto RouteReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("R1, +1\nR1,2 \nR1,-3\n"), ',');
+    CCSVBusSystem BusSystem(StopReader, RouteReader);
+
+    EXPECT_EQ(BusSystem.StopCount(), 2);
+    ASSERT_NE(BusSystem.StopByID(1), nullptr);
+    EXPECT_EQ(BusSystem.StopByID(1)->NodeID(), 1001);
+    ASSERT_NE(BusSystem.StopByID(2), nullptr);
+    EXPECT_EQ(BusSystem.StopByID(2)->NodeID(), 1002);
+    auto Route = BusSystem.RouteByName("R1");
+    ASSERT_NE(Route, nullptr);
+    ASSERT_EQ(Route->StopCount(), 2);
+    EXPECT_EQ(Route->GetStopID(0), 1);
+    EXPECT_EQ(Route->GetStopID(1), 2);
+}
+
+TEST(CSVBusSystemData, HandleTest){
+    auto StopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("stop_id,node_id\n1,1001\n2,1002\n3,1003\n"), ',');
+    auto RouteReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("route,stop_id\nR2,3\nR1,1\nR1,2\n"), ',');
+    CCSVBusSystem BusSystem(StopReader, RouteReader);
+
+    std::size_t Index = 0;
+    for(const CBusSystem::SStop &Stop : BusSystem.Stops()){
+        EXPECT_EQ(&Stop, BusSystem.StopHandleByIndex(Index));
+        EXPECT_EQ(&Stop, BusSystem.StopByIndex(Index).get());
+        EXPECT_EQ(Stop.ID(), Index + 1);
+        EXPECT_EQ(Stop.NodeID(), Index + 1001);
+        Index++;
+    }
+    EXPECT_EQ(Index, 3);
+    EXPECT_EQ(BusSystem.StopHandleByIndex(3), nullptr);
+    ASSERT_NE(BusSystem.StopHandleByID(2), nullptr);
+    EXPECT_EQ(BusSystem.StopHandleByID(2)->NodeID(), 1002);
+    EXPECT_EQ(BusSystem.StopHandleByID(4), nullptr);
+
+    // routes keep the order they first appear in
+    ASSERT_EQ(BusSystem.Routes().size(), 2);
+    auto Route = BusSystem.Routes().begin();
+    EXPECT_EQ((*Route).Name(), "R2");
+    ++Route;
+    EXPECT_EQ((*Route).Name(), "R1");
+    EXPECT_EQ((*Route).StopCount(), 2);
+    ++Route;
+    EXPECT_TRUE(Route == BusSystem.Routes().end());
+    EXPECT_EQ(BusSystem.RouteHandleByName("R1"), BusSystem.RouteHandleByIndex(1));
+    EXPECT_EQ(BusSystem.RouteHandleByName("R3"), nullptr);
+    EXPECT_EQ(BusSystem.RouteHandleByIndex(2), nullptr);
+}
+
+TEST(CSVBusSystemData, SharedLifetimeTest){
+    std::shared_ptr<CBusSystem::SStop> Stop;
+    std::shared_ptr<CBusSystem::SRoute> Route;
+    {
+        auto StopReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("1,1001\n"), ',');
+        auto RouteReader = std::make_shared<CDSVReader>(std::make_shared<CStringDataSource>("R1,1\n"), ',');
+        CCSVBusSystem BusSystem(StopReader, RouteReader);
+        Stop = BusSystem.StopByID(1);
+        Route = BusSystem.RouteByIndex(0);
+    }
+    // the shared_ptr lookups still own their elements after the bus system is gone
+    ASSERT_NE(Stop, nullptr);
+    EXPECT_EQ(Stop->NodeID(), 1001);
+    ASSERT_NE(Route, nullptr);
+    EXPECT_EQ(Route->Name(), "R1");
+    EXPECT_EQ(Route->GetStopID(0), 1);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+#include "CharacterScan.h"
+#include <random>
+#include <string>
+
+using TFindAny = const char *(*)(const char *, const char *, const char *, std::size_t) noexcept;
+
+static void CheckAgainstScalar(TFindAny findany){
+    std::mt19937 Generator(34);
+    std::uniform_int_distribution<int> Distribution('a','z');
+    const char Set[] = {',', '"', '\n', '\r', '<', '>', '&', '\''};
+    for(std::size_t Length = 0; Length < 200; Length++){
+        std::string Text(Length, 'x');
+        for(auto &Ch : Text){
+            Ch = Distribution(Generator);
+        }
+        for(std::size_t SetSize = 1; SetSize <= CharacterScan::MaxSetSize; SetSize++){
+            // no match at all, then a match at every position
+            EXPECT_EQ(findany(Text.data(), Text.data() + Length, Set, SetSize), Text.data() + Length);
+            for(std::size_t Position = 0; Position < Length; Position++){
+                std::string Probe = Text;
+                Probe[Position] = Set[Position % SetSize];
+                if(Position + 1 < Length){
+                    Probe[Length - 1] = Set[0];
+                }
+                EXPECT_EQ(findany(Probe.data(), Probe.data() + Length, Set, SetSize), Probe.data() + Position);
+            }
+        }
+    }
+}
+
+TEST(CharacterScan, ScalarTest){
+    std::string Text = "22043,2849810514\n";
+    const char Set[] = {',', '\n'};
+
+    EXPECT_EQ(CharacterScan::FindAnyScalar(Text.data(), Text.data() + Text.size(), Set, 2), Text.data() + 5);
+    EXPECT_EQ(CharacterScan::FindAnyScalar(Text.data() + 6, Text.data() + Text.size(), Set, 2), Text.data() + 16);
+    EXPECT_EQ(CharacterScan::FindAnyScalar(Text.data(), Text.data() + 5, Set, 2), Text.data() + 5);
+}
+
+TEST(CharacterScan, DispatchTest){
+    CheckAgainstScalar(CharacterScan::FindAny);
+}
+
+TEST(CharacterScan, SSE2Test){
+    if(!CharacterScan::HasSSE2()){
+        GTEST_SKIP();
+    }
+    CheckAgainstScalar(CharacterScan::FindAnySSE2);
+}
+
+TEST(CharacterScan, AVX2Test){
+    if(!CharacterScan::HasAVX2()){
+        GTEST_SKIP();
+    }
+    CheckAgainstScalar(CharacterScan::FindAnyAVX2);
+}
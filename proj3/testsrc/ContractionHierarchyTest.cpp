@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include "ContractionHierarchy.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+
+static std::shared_ptr<COpenStreetMap> LoadMap(const std::string &osm){
+    return std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(osm)));
+}
+
+static std::shared_ptr<COpenStreetMap> LoadDavis(){
+    std::ifstream Input("data/davis.osm");
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    return LoadMap(Buffer.str());
+}
+
+// Length of the path if every step is an edge of the graph, otherwise NoPathExists
+static double PathLength(const CRoutingGraph &graph, const std::vector<CStreetMap::TNodeID> &path){
+    double Total = 0.0;
+    for(std::size_t Index = 1; Index < path.size(); Index++){
+        auto Source = graph.VertexByNodeID(path[Index - 1]);
+        auto Target = graph.VertexByNodeID(path[Index]);
+        double Weight = CRoutingGraph::NoPathExists;
+        for(std::size_t Edge = 0; Edge < graph.EdgeCount(Source); Edge++){
+            if(graph.EdgeTarget(Source, Edge) == Target){
+                Weight = std::min(Weight, graph.EdgeWeight(Source, Edge));
+            }
+        }
+        if(Weight == CRoutingGraph::NoPathExists){
+            return Weight;
+        }
+        Total += Weight;
+    }
+    return Total;
+}
+
+// Compares the hierarchy against Dijkstra on random vertex pairs
+static void ExpectSameRoutes(const CRoutingGraph &graph, const CContractionHierarchy &hierarchy, int querycount){
+    std::mt19937 Generator(34);
+    std::uniform_int_distribution<CRoutingGraph::TVertex> Distribution(0, graph.VertexCount() - 1);
+    CContractionHierarchy::CWorkspace Workspace;
+    std::vector<CStreetMap::TNodeID> Path, HierarchyPath;
+    for(int Query = 0; Query < querycount; Query++){
+        auto Source = graph.NodeIDByVertex(Distribution(Generator));
+        auto Destination = graph.NodeIDByVertex(Distribution(Generator));
+        double Expected = graph.FindShortestPath(Source, Destination, Path);
+        double Distance = hierarchy.FindShortestPath(Source, Destination, HierarchyPath, Workspace);
+        EXPECT_EQ(hierarchy.FindShortestDistance(Source, Destination, Workspace), Distance);
+        if(Expected == CRoutingGraph::NoPathExists){
+            EXPECT_EQ(Distance, CContractionHierarchy::NoPathExists);
+            EXPECT_TRUE(HierarchyPath.empty());
+            continue;
+        }
+        EXPECT_NEAR(Distance, Expected, 1e-6);
+        ASSERT_FALSE(HierarchyPath.empty());
+        EXPECT_EQ(HierarchyPath.front(), Source);
+        EXPECT_EQ(HierarchyPath.back(), Destination);
+        EXPECT_NEAR(PathLength(graph, HierarchyPath), Expected, 1e-6);
+    }
+}
+
+TEST(ContractionHierarchy, SmallMapTest){
+    auto Map = LoadMap("<osm>"
+                       "<node id=\"1\" lat=\"38.000\" lon=\"-121.000\"/><node id=\"2\" lat=\"38.000\" lon=\"-120.999\"/>"
+                       "<node id=\"3\" lat=\"38.001\" lon=\"-120.999\"/><node id=\"4\" lat=\"38.001\" lon=\"-121.000\"/>"
+                       "<node id=\"5\" lat=\"38.002\" lon=\"-121.000\"/><node id=\"6\" lat=\"38.002\" lon=\"-121.000\"/>"
+                       "<way id=\"10\"><nd ref=\"1\"/><nd ref=\"2\"/><nd ref=\"3\"/><nd ref=\"4\"/><nd ref=\"1\"/><tag k=\"highway\" v=\"residential\"/><tag k=\"oneway\" v=\"yes\"/></way>"
+                       "<way id=\"11\"><nd ref=\"4\"/><nd ref=\"5\"/><nd ref=\"6\"/><tag k=\"highway\" v=\"residential\"/></way>"
+                       "</osm>");
+    CRoutingGraph Graph(Map);
+    CContractionHierarchy Hierarchy(Graph, 2);
+    std::vector<CStreetMap::TNodeID> Path;
+
+    EXPECT_EQ(Hierarchy.VertexCount(), 6);
+    for(CStreetMap::TNodeID Source = 1; Source <= 7; Source++){
+        for(CStreetMap::TNodeID Destination = 1; Destination <= 7; Destination++){
+            std::vector<CStreetMap::TNodeID> Expected;
+            double Distance = Graph.FindShortestPath(Source, Destination, Expected);
+            EXPECT_NEAR(Hierarchy.FindShortestPath(Source, Destination, Path), Distance, 1e-9);
+            EXPECT_EQ(Path, Expected);
+        }
+    }
+}
+
+// Two routes of equal length between 1 and 4, with spurs 5 - 1 and 4 - 6 so that
+// 2 and 3 can be contracted in the same round and each looks like the other's witness
+TEST(ContractionHierarchy, EqualAlternativesTest){
+    auto Map = LoadMap("<osm>"
+                       "<node id=\"1\" lat=\"38.000\" lon=\"-121.000\"/><node id=\"2\" lat=\"38.001\" lon=\"-120.999\"/>"
+                       "<node id=\"3\" lat=\"38.001\" lon=\"-121.001\"/><node id=\"4\" lat=\"38.002\" lon=\"-121.000\"/>"
+                       "<node id=\"5\" lat=\"37.998\" lon=\"-121.000\"/><node id=\"6\" lat=\"38.004\" lon=\"-121.000\"/>"
+                       "<way id=\"10\"><nd ref=\"1\"/><nd ref=\"2\"/><nd ref=\"4\"/><tag k=\"highway\" v=\"residential\"/></way>"
+                       "<way id=\"11\"><nd ref=\"1\"/><nd ref=\"3\"/><nd ref=\"4\"/><tag k=\"highway\" v=\"residential\"/></way>"
+                       "<way id=\"12\"><nd ref=\"5\"/><nd ref=\"1\"/><tag k=\"highway\" v=\"residential\"/></way>"
+                       "<way id=\"13\"><nd ref=\"4\"/><nd ref=\"6\"/><tag k=\"highway\" v=\"residential\"/></way>"
+                       "</osm>");
+    CRoutingGraph Graph(Map);
+    std::vector<CStreetMap::TNodeID> Path, HierarchyPath;
+    for(std::size_t ThreadCount : {1, 2}){
+        CContractionHierarchy Hierarchy(Graph, ThreadCount);
+        for(CStreetMap::TNodeID Source = 1; Source <= 6; Source++){
+            for(CStreetMap::TNodeID Destination = 1; Destination <= 6; Destination++){
+                double Expected = Graph.FindShortestPath(Source, Destination, Path);
+                ASSERT_NE(Expected, CRoutingGraph::NoPathExists);
+                EXPECT_NEAR(Hierarchy.FindShortestPath(Source, Destination, HierarchyPath), Expected, 1e-6) << Source << " -> " << Destination;
+                EXPECT_NEAR(PathLength(Graph, HierarchyPath), Expected, 1e-6) << Source << " -> " << Destination;
+            }
+        }
+    }
+}
+
+TEST(ContractionHierarchy, DavisTest){
+    CRoutingGraph Graph(LoadDavis());
+    CContractionHierarchy Hierarchy(Graph);
+
+    EXPECT_EQ(Hierarchy.VertexCount(), Graph.VertexCount());
+    EXPECT_GE(Hierarchy.EdgeCount(), Graph.EdgeCount() / 2);
+    ExpectSameRoutes(Graph, Hierarchy, 300);
+}
+
+TEST(ContractionHierarchy, ThreadCountTest){
+    CRoutingGraph Graph(LoadDavis());
+    for(std::size_t ThreadCount : {1, 3}){
+        CContractionHierarchy Hierarchy(Graph, ThreadCount);
+        ExpectSameRoutes(Graph, Hierarchy, 50);
+    }
+}
+
+TEST(ContractionHierarchy, WriteLoadTest){
+    CRoutingGraph Graph(LoadDavis());
+    CContractionHierarchy Hierarchy(Graph);
+    auto Sink = std::make_shared<CStringDataSink>();
+    ASSERT_TRUE(Hierarchy.Write(Sink));
+
+    auto Loaded = CContractionHierarchy::Load(std::make_shared<CStringDataSource>(Sink->String()));
+    ASSERT_NE(Loaded, nullptr);
+    EXPECT_EQ(Loaded->VertexCount(), Hierarchy.VertexCount());
+    EXPECT_EQ(Loaded->EdgeCount(), Hierarchy.EdgeCount());
+    ExpectSameRoutes(Graph, *Loaded, 50);
+    auto Rewritten = std::make_shared<CStringDataSink>();
+    ASSERT_TRUE(Loaded->Write(Rewritten));
+    EXPECT_EQ(Rewritten->String(), Sink->String());
+
+    EXPECT_EQ(CContractionHierarchy::Load(std::make_shared<CStringDataSource>("")), nullptr);
+    EXPECT_EQ(CContractionHierarchy::Load(std::make_shared<CStringDataSource>(Sink->String().substr(0, Sink->String().length() / 2))), nullptr);
+    auto Corrupt = Sink->String();
+    Corrupt[8]++;  // unknown version
+    EXPECT_EQ(CContractionHierarchy::Load(std::make_shared<CStringDataSource>(Corrupt)), nullptr);
+    // damaged indices are rejected, anything that loads has to be safe to query
+    std::vector<CStreetMap::TNodeID> Path;
+    for(std::size_t Position = 16; Position < Sink->String().length(); Position += 997){
+        Corrupt = Sink->String();
+        Corrupt[Position] = 0x7F;
+        auto Damaged = CContractionHierarchy::Load(std::make_shared<CStringDataSource>(Corrupt));
+        if(Damaged){
+            for(CRoutingGraph::TVertex Vertex = 0; Vertex + 1 < Graph.VertexCount(); Vertex += 500){
+                Damaged->FindShortestPath(Graph.NodeIDByVertex(Vertex), Graph.NodeIDByVertex(Vertex + 1), Path);
+            }
+        }
+    }
+}
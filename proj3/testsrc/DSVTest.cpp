@@ -4,6 +4,7 @@
 #include <string>
 #include "DSVWriter.h"
 #include "DSVReader.h"
+#include "ParallelDSVReader.h"
 #include "StringDataSink.h"
 #include "StringDataSource.h"
 
@@ -57,6 +58,77 @@ TEST_F(DSVTest, WriteRowWithQuotes) {
     EXPECT_EQ(Sink->String(), "\"Cat, Woman\",30,New York\n");  // Quoted correctly
 }
 
+// Test that embedded quotes are doubled and quoteall quotes every field
+TEST_F(DSVTest, WriteRowEscaping) {
+    Writer->WriteRow({"say \"hi\"", "", "line\nbreak", "cr\rhere"});
+    EXPECT_EQ(Sink->String(), "\"say \"\"hi\"\"\",,\"line\nbreak\",\"cr\rhere\"\n");
+
+    auto QuotedSink = std::make_shared<CStringDataSink>();
+    CDSVWriter QuoteAll(QuotedSink, '\t', true);
+    QuoteAll.WriteRow({"a", "b,c"});
+    QuoteAll.WriteRow({});
+    EXPECT_EQ(QuotedSink->String(), "\"a\"\t\"b,c\"\n\n");
+}
+
+// Test building rows from typed fields
+TEST_F(DSVTest, WriteFields) {
+    EXPECT_TRUE(Writer->WriteField("id"));
+    EXPECT_TRUE(Writer->WriteField(std::string("lat, lon")));
+    EXPECT_TRUE(Writer->EndRow());
+    EXPECT_EQ(Sink->String(), "id,\"lat, lon\"\n");
+
+    EXPECT_TRUE(Writer->WriteField(42));
+    EXPECT_TRUE(Writer->WriteField(-7LL));
+    EXPECT_TRUE(Writer->WriteField(18446744073709551615ULL));
+    EXPECT_TRUE(Writer->WriteField(0.1));
+    EXPECT_TRUE(Writer->WriteField(-121.7549));
+    EXPECT_TRUE(Writer->WriteField(2.0));
+    EXPECT_TRUE(Writer->EndRow());
+    EXPECT_EQ(Sink->String(), "id,\"lat, lon\"\n42,-7,18446744073709551615,0.1,-121.7549,2\n");
+
+    // the shortest form still reads back as the same double
+    InitializeReader();
+    std::vector<std::string> row;
+    EXPECT_TRUE(Reader->ReadRow(row));
+    EXPECT_TRUE(Reader->ReadRow(row));
+    EXPECT_EQ(std::stod(row[3]), 0.1);
+    EXPECT_EQ(std::stod(row[4]), -121.7549);
+}
+
+// Sink that counts how often it is written to
+class CCountingDataSink : public CStringDataSink {
+    public:
+        std::size_t Writes = 0;
+
+        bool Write(const std::vector<char> &buf) noexcept override {
+            Writes++;
+            return CStringDataSink::Write(buf);
+        }
+};
+
+// Test that a batch matches row by row output with far fewer sink writes
+TEST_F(DSVTest, WriteRows) {
+    std::vector<std::vector<std::string>> Rows;
+    for (int Index = 0; Index < 20000; Index++) {
+        Rows.push_back({std::to_string(Index), Index % 3 ? "plain" : "needs \"quotes\", here"});
+    }
+    for (auto &Row : Rows) {
+        Writer->WriteRow(Row);
+    }
+    auto BatchSink = std::make_shared<CCountingDataSink>();
+    CDSVWriter BatchWriter(BatchSink, ',');
+    EXPECT_TRUE(BatchWriter.WriteRows(Rows));
+    EXPECT_EQ(BatchSink->String(), Sink->String());
+    EXPECT_LT(BatchSink->Writes, 20);
+
+    InitializeReader();
+    std::vector<std::string> row;
+    for (auto &Row : Rows) {
+        ASSERT_TRUE(Reader->ReadRow(row));
+        EXPECT_EQ(row, Row);
+    }
+}
+
 // **CDSVReader Tests**
 
 // Test reading an empty source
@@ -97,3 +169,170 @@ TEST_F(DSVTest, EndFunction) {
     InitializeReader();
     EXPECT_TRUE(Reader->End());  // No data, should be at end
 }
+
+// Source without a contiguous view so the reader has to go through Read
+class CBlockOnlyDataSource : public CDataSource {
+    private:
+        CStringDataSource DSource;
+    public:
+        CBlockOnlyDataSource(const std::string &str) : DSource(str) {}
+
+        bool End() const noexcept override { return DSource.End(); }
+        bool Get(char &ch) noexcept override { return DSource.Get(ch); }
+        bool Peek(char &ch) noexcept override { return DSource.Peek(ch); }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override { return DSource.Read(buf, count); }
+};
+
+static std::vector<std::vector<std::string>> ReadAllRows(CDSVReader &reader) {
+    std::vector<std::vector<std::string>> Rows;
+    std::vector<std::string> Row;
+    while (reader.ReadRow(Row)) {
+        Rows.push_back(Row);
+    }
+    return Rows;
+}
+
+// Test doubled quotes, embedded delimiters and newlines inside quotes
+TEST_F(DSVTest, ReadEscapedQuotes) {
+    CDSVReader Reader(std::make_shared<CStringDataSource>("\"say \"\"hi\"\"\",\"a\nb\",c\"\"d\n"), ',');
+    std::vector<std::string> row;
+
+    EXPECT_TRUE(Reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"say \"hi\"", "a\nb", "c\"d"}));
+    EXPECT_FALSE(Reader.ReadRow(row));
+    EXPECT_TRUE(Reader.End());
+}
+
+// Test CR, LF and CRLF line endings, blank lines and a missing final newline
+TEST_F(DSVTest, ReadLineEndings) {
+    CDSVReader Reader(std::make_shared<CStringDataSource>("a,b\r\nc,\rd\n\ne"), ',');
+
+    auto Rows = ReadAllRows(Reader);
+    ASSERT_EQ(Rows.size(), 5);
+    EXPECT_EQ(Rows[0], std::vector<std::string>({"a", "b"}));
+    EXPECT_EQ(Rows[1], std::vector<std::string>({"c", ""}));
+    EXPECT_EQ(Rows[2], std::vector<std::string>({"d"}));
+    EXPECT_EQ(Rows[3], std::vector<std::string>({}));
+    EXPECT_EQ(Rows[4], std::vector<std::string>({"e"}));
+    EXPECT_TRUE(Reader.End());
+}
+
+// Test that block boundaries anywhere in the input do not change the rows
+TEST_F(DSVTest, ReadAcrossBlocks) {
+    std::string Input = "stop_id,node_id\r\n22043,2849810514\r\n\"x,\"\"y\"\"\",\"\"\n";
+    for (int Index = 0; Index < 20; Index++) {
+        Input += "a much longer plain field that spans many vector widths," + std::to_string(Index) + "\n";
+    }
+    CDSVReader Reference(std::make_shared<CStringDataSource>(Input), ',');
+    auto Expected = ReadAllRows(Reference);
+    ASSERT_EQ(Expected.size(), 23);
+    EXPECT_EQ(Expected[2], std::vector<std::string>({"x,\"y\"", "\""}));
+
+    for (std::size_t ChunkSize : {1, 2, 3, 5, 16, 33}) {
+        CDSVReader Reader(std::make_shared<CBlockOnlyDataSource>(Input), ',', ChunkSize);
+        EXPECT_EQ(ReadAllRows(Reader), Expected);
+        EXPECT_TRUE(Reader.End());
+    }
+}
+
+// Test a delimiter other than comma
+TEST_F(DSVTest, ReadTabDelimited) {
+    CDSVReader Reader(std::make_shared<CStringDataSource>("a,b\tc\n"), '\t');
+    std::vector<std::string> row;
+
+    EXPECT_TRUE(Reader.ReadRow(row));
+    EXPECT_EQ(row, std::vector<std::string>({"a,b", "c"}));
+}
+
+// Test that the view API returns the same cells as ReadRow
+TEST_F(DSVTest, ReadRowView) {
+    std::string Input = "route,stop_id\nA,22258\n\"B \"\"Express\"\"\",22169\n\n";
+    for (std::size_t ChunkSize : {1, 4, 1024}) {
+        CDSVReader Reader(std::make_shared<CBlockOnlyDataSource>(Input), ',', ChunkSize);
+        std::vector<std::string_view> row;
+
+        EXPECT_TRUE(Reader.ReadRowView(row));
+        EXPECT_EQ(row, std::vector<std::string_view>({"route", "stop_id"}));
+        EXPECT_TRUE(Reader.ReadRowView(row));
+        EXPECT_EQ(row, std::vector<std::string_view>({"A", "22258"}));
+        EXPECT_TRUE(Reader.ReadRowView(row));
+        EXPECT_EQ(row, std::vector<std::string_view>({"B \"Express\"", "22169"}));
+        EXPECT_TRUE(Reader.ReadRowView(row));
+        EXPECT_TRUE(row.empty());
+        EXPECT_FALSE(Reader.ReadRowView(row));
+        EXPECT_TRUE(Reader.End());
+    }
+}
+
+// Test that plain cells point straight into a memory backed source
+TEST_F(DSVTest, ReadRowViewZeroCopy) {
+    auto Source = std::make_shared<CStringDataSource>("22043,2849810514\n");
+    const char *Data;
+    std::size_t Size;
+    ASSERT_TRUE(Source->View(Data, Size));
+    CDSVReader Reader(Source, ',');
+    std::vector<std::string_view> row;
+
+    EXPECT_TRUE(Reader.ReadRowView(row));
+    ASSERT_EQ(row.size(), 2);
+    EXPECT_EQ(row[0].data(), Data);
+    EXPECT_EQ(row[1].data(), Data + 6);
+}
+
+// Test that parallel parsing gives the same rows as the sequential reader
+// no matter where the chunk edges fall
+TEST_F(DSVTest, ParallelMatchesSequential) {
+    std::string Input = "route,stop_id\r\n";
+    for (int Index = 0; Index < 200; Index++) {
+        Input += std::to_string(Index % 7) + ",\"multi\nline, \"\"quoted\"\"\r\n cell\"," + std::to_string(Index) + "\n";
+        Input += (Index % 5) ? "plain,row\r" : "\n";
+    }
+    Input += "\"unterminated\nlast";
+    CDSVReader Reference(std::make_shared<CStringDataSource>(Input), ',');
+    auto Expected = ReadAllRows(Reference);
+
+    for (std::size_t ChunkSize : {1, 2, 3, 7, 64, 1000, 1 << 20}) {
+        for (std::size_t Threads : {1, 3}) {
+            CParallelDSVReader Reader(std::make_shared<CStringDataSource>(Input), ',', Threads, ChunkSize);
+            std::vector<std::vector<std::string>> Rows;
+            EXPECT_TRUE(Reader.ReadAll(Rows));
+            EXPECT_EQ(Rows, Expected);
+        }
+    }
+    CParallelDSVReader BlockReader(std::make_shared<CBlockOnlyDataSource>(Input), ',', 2, 100);
+    std::vector<std::vector<std::string>> Rows;
+    EXPECT_TRUE(BlockReader.ReadAll(Rows));
+    EXPECT_EQ(Rows, Expected);
+}
+
+// Test the per chunk callbacks cover every row once
+TEST_F(DSVTest, ParallelChunkCallbacks) {
+    std::string Input;
+    for (int Index = 0; Index < 1000; Index++) {
+        Input += std::to_string(Index) + ",x\n";
+    }
+    CParallelDSVReader Reader(std::make_shared<CStringDataSource>(Input), ',', 4, 256);
+    ASSERT_GT(Reader.ChunkCount(), 1);
+    std::vector<std::vector<std::vector<std::string>>> Chunks(Reader.ChunkCount());
+    EXPECT_TRUE(Reader.ForEachChunk([&](std::size_t chunkindex, std::vector<std::vector<std::string>> &rows) {
+        Chunks[chunkindex] = std::move(rows);
+    }));
+    int Expected = 0;
+    for (auto &Chunk : Chunks) {
+        for (auto &Row : Chunk) {
+            EXPECT_EQ(Row, std::vector<std::string>({std::to_string(Expected), "x"}));
+            Expected++;
+        }
+    }
+    EXPECT_EQ(Expected, 1000);
+}
+
+// Test an empty input
+TEST_F(DSVTest, ParallelEmptyInput) {
+    CParallelDSVReader Reader(std::make_shared<CStringDataSource>(""), ',');
+    std::vector<std::vector<std::string>> Rows;
+
+    EXPECT_EQ(Reader.ChunkCount(), 0);
+    EXPECT_FALSE(Reader.ReadAll(Rows));
+    EXPECT_TRUE(Rows.empty());
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "DecompressDataSource.h"
+#include "PrefetchDataSource.h"
+#include "StringDataSource.h"
+#include "DSVReader.h"
+#include "XMLReader.h"
+#include <zlib.h>
+#include <bzlib.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+static std::string Gzip(const std::string &data){
+    z_stream Stream = z_stream();
+    // 15 + 16 writes a gzip header instead of a zlib one
+    deflateInit2(&Stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string Compressed(deflateBound(&Stream, data.size()) + 32, '\0');
+    Stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    Stream.avail_in = data.size();
+    Stream.next_out = reinterpret_cast<Bytef *>(&Compressed[0]);
+    Stream.avail_out = Compressed.size();
+    deflate(&Stream, Z_FINISH);
+    Compressed.resize(Stream.total_out);
+    deflateEnd(&Stream);
+    return Compressed;
+}
+
+static std::string BZip2(const std::string &data){
+    unsigned int Length = data.size() + data.size() / 100 + 600;
+    std::string Compressed(Length, '\0');
+    BZ2_bzBuffToBuffCompress(&Compressed[0], &Length, const_cast<char *>(data.data()), data.size(), 9, 0, 0);
+    Compressed.resize(Length);
+    return Compressed;
+}
+
+static std::string Decompress(CDataSource &source){
+    std::string Result;
+    std::vector<char> Block;
+    while(source.Read(Block, 1000)){
+        Result.append(Block.begin(), Block.end());
+    }
+    return Result;
+}
+
+static std::string Text(std::size_t size){
+    std::string Contents;
+    for(std::size_t Index = 0; Contents.size() < size; Index++){
+        Contents += std::to_string(Index * 7919 % 100003) + ",name " + std::to_string(Index % 97) + "\n";
+    }
+    return Contents;
+}
+
+TEST(DecompressDataSourceTest, Gzip){
+    auto Contents = Text(1 << 20);
+    CDecompressDataSource Source(std::make_shared<CStringDataSource>(Gzip(Contents)), CDecompressDataSource::EFormat::Auto, 4096);
+    EXPECT_EQ(Decompress(Source), Contents);
+    EXPECT_EQ(Source.Format(), CDecompressDataSource::EFormat::Gzip);
+    EXPECT_FALSE(Source.Failed());
+    EXPECT_TRUE(Source.End());
+}
+
+TEST(DecompressDataSourceTest, BZip2){
+    auto Contents = Text(1 << 20);
+    CDecompressDataSource Source(std::make_shared<CStringDataSource>(BZip2(Contents)), CDecompressDataSource::EFormat::Auto, 4096);
+    EXPECT_EQ(Decompress(Source), Contents);
+    EXPECT_EQ(Source.Format(), CDecompressDataSource::EFormat::BZip2);
+    EXPECT_FALSE(Source.Failed());
+}
+
+TEST(DecompressDataSourceTest, ConcatenatedStreams){
+    CDecompressDataSource GzipSource(std::make_shared<CStringDataSource>(Gzip("first,") + Gzip("second")));
+    EXPECT_EQ(Decompress(GzipSource), "first,second");
+    EXPECT_FALSE(GzipSource.Failed());
+
+    CDecompressDataSource BZip2Source(std::make_shared<CStringDataSource>(BZip2("first,") + BZip2("second")));
+    EXPECT_EQ(Decompress(BZip2Source), "first,second");
+    EXPECT_FALSE(BZip2Source.Failed());
+}
+
+TEST(DecompressDataSourceTest, PlainPassthrough){
+    auto Contents = Text(100000);
+    CDecompressDataSource Source(std::make_shared<CStringDataSource>(Contents), CDecompressDataSource::EFormat::Auto, 1000);
+    char TempCh;
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh, Contents[0]);
+    EXPECT_EQ(Source.Skip(10), 10);
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh, Contents[10]);
+    EXPECT_EQ(Decompress(Source), Contents.substr(11));
+    EXPECT_EQ(Source.Format(), CDecompressDataSource::EFormat::None);
+
+    CDecompressDataSource Empty(std::make_shared<CStringDataSource>(""));
+    EXPECT_TRUE(Empty.End());
+    EXPECT_FALSE(Empty.Get(TempCh));
+    EXPECT_FALSE(Empty.Failed());
+}
+
+TEST(DecompressDataSourceTest, BrokenInput){
+    auto Contents = Text(100000);
+    auto Compressed = Gzip(Contents);
+    CDecompressDataSource Truncated(std::make_shared<CStringDataSource>(Compressed.substr(0, Compressed.size() / 2)));
+    auto Partial = Decompress(Truncated);
+    EXPECT_TRUE(Truncated.Failed());
+    EXPECT_EQ(Partial, Contents.substr(0, Partial.size()));
+
+    Compressed[Compressed.size() / 2] ^= 0x55;
+    Compressed[Compressed.size() / 2 + 1] ^= 0x55;
+    CDecompressDataSource Corrupt(std::make_shared<CStringDataSource>(Compressed));
+    Decompress(Corrupt);
+    EXPECT_TRUE(Corrupt.Failed());
+
+    CDecompressDataSource NotBZip2(std::make_shared<CStringDataSource>("plain text"), CDecompressDataSource::EFormat::BZip2);
+    EXPECT_EQ(Decompress(NotBZip2), "");
+    EXPECT_TRUE(NotBZip2.Failed());
+}
+
+TEST(DecompressDataSourceTest, WrappedReaders){
+    std::ifstream Input("data/davis.osm");
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    auto OSM = Buffer.str();
+
+    CXMLReader Plain(std::make_shared<CStringDataSource>(OSM));
+    CXMLReader Compressed(std::make_shared<CPrefetchDataSource>(std::make_shared<CDecompressDataSource>(std::make_shared<CStringDataSource>(BZip2(OSM)))));
+    SXMLEntity Expected, Entity;
+    std::size_t Count = 0;
+    while(Plain.ReadEntity(Expected)){
+        ASSERT_TRUE(Compressed.ReadEntity(Entity));
+        ASSERT_EQ(Entity.DNameData, Expected.DNameData);
+        Count++;
+    }
+    EXPECT_FALSE(Compressed.ReadEntity(Entity));
+    EXPECT_GT(Count, 50000);
+
+    CDSVReader Reader(std::make_shared<CDecompressDataSource>(std::make_shared<CStringDataSource>(Gzip("a,b\n1,\"x, y\"\n"))), ',');
+    std::vector<std::string> Row;
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_TRUE(Reader.ReadRow(Row));
+    EXPECT_EQ(Row, std::vector<std::string>({"1", "x, y"}));
+    EXPECT_FALSE(Reader.ReadRow(Row));
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "FileDataSink.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+class FileDataSinkTest : public ::testing::Test {
+protected:
+    std::string Filename;
+
+    void SetUp() override {
+        Filename = "filedatasinktest.tmp";
+    }
+
+    void TearDown() override {
+        std::remove(Filename.c_str());
+    }
+
+    std::string ReadFile() {
+        std::ifstream Input(Filename, std::ios::binary);
+        std::stringstream Buffer;
+        Buffer << Input.rdbuf();
+        return Buffer.str();
+    }
+};
+
+TEST_F(FileDataSinkTest, InvalidFileTest){
+    CFileDataSink Sink("does/not/exist.txt");
+
+    EXPECT_FALSE(Sink.Valid());
+    EXPECT_FALSE(Sink.Put('a'));
+    EXPECT_FALSE(Sink.Write(std::vector<char>{'a', 'b'}));
+    EXPECT_FALSE(Sink.Flush());
+}
+
+TEST_F(FileDataSinkTest, PutWriteTest){
+    {
+        CFileDataSink Sink(Filename);
+        EXPECT_TRUE(Sink.Valid());
+        EXPECT_TRUE(Sink.Put('H'));
+        EXPECT_TRUE(Sink.Write(std::vector<char>{'e', 'l', 'l', 'o'}));
+        EXPECT_TRUE(Sink.Flush());
+        EXPECT_EQ(ReadFile(), "Hello");
+        EXPECT_TRUE(Sink.Write(" World", 6));
+    }
+    // the destructor writes out what is left
+    EXPECT_EQ(ReadFile(), "Hello World");
+}
+
+// The smallest buffer is one page, so writes cross many flushes and large
+// blocks go straight to the file
+TEST_F(FileDataSinkTest, AcrossBuffersTest){
+    std::string Expected;
+    {
+        CFileDataSink Sink(Filename, 1);
+        for(int Index = 0; Index < 10000; Index++){
+            char Ch = 'a' + Index % 26;
+            EXPECT_TRUE(Sink.Put(Ch));
+            Expected += Ch;
+        }
+        std::vector<char> Block(50000, 'x');
+        EXPECT_TRUE(Sink.Write(Block));
+        Expected.append(Block.begin(), Block.end());
+        EXPECT_TRUE(Sink.Write("tail", 4));
+        Expected += "tail";
+    }
+    EXPECT_EQ(ReadFile(), Expected);
+}
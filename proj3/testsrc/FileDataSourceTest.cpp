@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "FileDataSource.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+class FileDataSourceTest : public ::testing::Test {
+protected:
+    std::string Filename;
+
+    void SetUp() override {
+        Filename = "filedatasourcetest.tmp";
+    }
+
+    void TearDown() override {
+        std::remove(Filename.c_str());
+    }
+
+    void WriteFile(const std::string &contents) {
+        std::ofstream Output(Filename, std::ios::binary);
+        Output << contents;
+    }
+};
+
+TEST_F(FileDataSourceTest, MissingFileTest){
+    CFileDataSource Source("does/not/exist.txt");
+    char TempCh = 'x';
+    std::vector<char> TempVector;
+
+    EXPECT_FALSE(Source.Valid());
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_FALSE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'x');
+    EXPECT_FALSE(Source.Read(TempVector,4));
+    EXPECT_EQ(Source.Skip(4),0);
+}
+
+TEST_F(FileDataSourceTest, EmptyFileTest){
+    WriteFile("");
+    CFileDataSource Source(Filename);
+    char TempCh;
+
+    EXPECT_TRUE(Source.Valid());
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+}
+
+TEST_F(FileDataSourceTest, GetPeekTest){
+    WriteFile("Bye");
+    CFileDataSource Source(Filename);
+    char TempCh = 'x';
+
+    EXPECT_FALSE(Source.End());
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'y');
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_FALSE(Source.Peek(TempCh));
+}
+
+// The smallest buffer is one page, so reads and skips cross many refills
+TEST_F(FileDataSourceTest, AcrossBuffersTest){
+    std::string Contents;
+    for(int Index = 0; Index < 100000; Index++){
+        Contents += static_cast<char>('a' + Index % 26);
+    }
+    WriteFile(Contents);
+
+    CFileDataSource Source(Filename, 1);
+    std::string Copy;
+    char TempCh;
+    while(Source.Get(TempCh)){
+        Copy += TempCh;
+    }
+    EXPECT_EQ(Copy, Contents);
+
+    CFileDataSource Blocks(Filename, 1);
+    std::vector<char> TempVector;
+    EXPECT_TRUE(Blocks.Read(TempVector, 5000));
+    EXPECT_EQ(std::string(TempVector.begin(), TempVector.end()), Contents.substr(0, 5000));
+    EXPECT_EQ(Blocks.Skip(20000), 20000);
+    EXPECT_TRUE(Blocks.Get(TempCh));
+    EXPECT_EQ(TempCh, Contents[25000]);
+    EXPECT_EQ(Blocks.Skip(3), 3);
+    EXPECT_TRUE(Blocks.Read(TempVector, 1000000));
+    EXPECT_EQ(std::string(TempVector.begin(), TempVector.end()), Contents.substr(25004));
+    EXPECT_TRUE(Blocks.End());
+    EXPECT_EQ(Blocks.Skip(10), 0);
+    EXPECT_FALSE(Blocks.Read(TempVector, 10));
+}
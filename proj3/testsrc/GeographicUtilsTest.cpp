@@ -0,0 +1,29 @@
+#include <gtest/gtest.h>
+#include "GeographicUtils.h"
+#include <cmath>
+
+TEST(GeographicUtils, HaversineDistanceTest){
+    // one degree along the equator or a meridian is 2 pi R / 360
+    double Degree = 2.0 * M_PI * GeographicUtils::EarthRadiusMeters / 360.0;
+    EXPECT_NEAR(GeographicUtils::HaversineDistance({0.0, 0.0}, {0.0, 1.0}), Degree, 1e-6);
+    EXPECT_NEAR(GeographicUtils::HaversineDistance({38.0, -121.0}, {39.0, -121.0}), Degree, 1e-6);
+    EXPECT_NEAR(GeographicUtils::HaversineDistance({0.0, 179.5}, {0.0, -179.5}), Degree, 1e-6);
+    EXPECT_EQ(GeographicUtils::HaversineDistance({38.5, -121.7}, {38.5, -121.7}), 0.0);
+    EXPECT_DOUBLE_EQ(GeographicUtils::HaversineDistance({38.5, -121.7}, {38.6, -121.8}), GeographicUtils::HaversineDistance({38.6, -121.8}, {38.5, -121.7}));
+    EXPECT_NEAR(GeographicUtils::HaversineDistance({90.0, 0.0}, {-90.0, 0.0}), M_PI * GeographicUtils::EarthRadiusMeters, 1e-6);
+}
+
+TEST(GeographicUtils, BoxDistanceTest){
+    CStreetMap::TLocation LowerLeft(38.0, -122.0), UpperRight(39.0, -121.0);
+
+    EXPECT_EQ(GeographicUtils::BoxDistance({38.5, -121.5}, LowerLeft, UpperRight), 0.0);
+    EXPECT_DOUBLE_EQ(GeographicUtils::BoxDistance({40.0, -121.5}, LowerLeft, UpperRight), GeographicUtils::HaversineDistance({40.0, -121.5}, {39.0, -121.5}));
+    EXPECT_DOUBLE_EQ(GeographicUtils::BoxDistance({37.0, -123.0}, LowerLeft, UpperRight), GeographicUtils::HaversineDistance({37.0, -123.0}, {38.0, -122.0}));
+    // east of the box the closest point is slightly poleward of the same latitude
+    CStreetMap::TLocation East(60.0, 0.0);
+    double Distance = GeographicUtils::BoxDistance(East, {50.0, -30.0}, {70.0, -20.0});
+    EXPECT_LT(Distance, GeographicUtils::HaversineDistance(East, {60.0, -20.0}));
+    for(double Latitude = 50.0; Latitude <= 70.0; Latitude += 0.25){
+        EXPECT_LE(Distance, GeographicUtils::HaversineDistance(East, {Latitude, -20.0}) + 1e-6);
+    }
+}
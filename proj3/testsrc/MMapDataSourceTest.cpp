@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "MMapDataSource.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+class MMapDataSourceTest : public ::testing::Test {
+protected:
+    std::string Filename;
+
+    void SetUp() override {
+        Filename = "mmapdatasourcetest.tmp";
+    }
+
+    void TearDown() override {
+        std::remove(Filename.c_str());
+    }
+
+    void WriteFile(const std::string &contents) {
+        std::ofstream Output(Filename, std::ios::binary);
+        Output << contents;
+    }
+};
+
+TEST_F(MMapDataSourceTest, MissingFileTest){
+    CMMapDataSource Source("does/not/exist.txt");
+    char TempCh = 'x';
+    std::vector<char> TempVector;
+
+    EXPECT_FALSE(Source.Valid());
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_FALSE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'x');
+    EXPECT_FALSE(Source.Read(TempVector,4));
+}
+
+TEST_F(MMapDataSourceTest, EmptyFileTest){
+    WriteFile("");
+    CMMapDataSource Source(Filename);
+
+    EXPECT_TRUE(Source.End());
+    EXPECT_EQ(Source.Size(),0);
+}
+
+TEST_F(MMapDataSourceTest, GetPeekTest){
+    WriteFile("Bye");
+    CMMapDataSource Source(Filename);
+    char TempCh = 'x';
+
+    EXPECT_TRUE(Source.Valid());
+    EXPECT_EQ(Source.Size(),3);
+    EXPECT_FALSE(Source.End());
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'B');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'y');
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'e');
+    TempCh = 'x';
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'x');
+}
+
+TEST_F(MMapDataSourceTest, ReadTest){
+    WriteFile("Hello");
+    CMMapDataSource Source(Filename);
+    std::vector<char> TempVector;
+    char TempCh = 'x';
+
+    EXPECT_TRUE(Source.Read(TempVector,4));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"Hell");
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'o');
+    EXPECT_TRUE(Source.Read(TempVector,4));
+    EXPECT_EQ(std::string(TempVector.begin(),TempVector.end()),"o");
+    EXPECT_FALSE(Source.Read(TempVector,4));
+    EXPECT_TRUE(TempVector.empty());
+}
+
+TEST_F(MMapDataSourceTest, ViewTest){
+    WriteFile("Hello World");
+    CMMapDataSource Source(Filename);
+    const char *Data = nullptr;
+    std::size_t Size = 0;
+    char TempCh;
+
+    ASSERT_TRUE(Source.View(Data,Size));
+    EXPECT_EQ(std::string(Data,Size),"Hello World");
+    EXPECT_EQ(Source.Skip(6),6);
+    ASSERT_TRUE(Source.View(Data,Size));
+    EXPECT_EQ(std::string(Data,Size),"World");
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh,'W');
+    EXPECT_EQ(Source.Skip(10),4);
+    EXPECT_TRUE(Source.End());
+    ASSERT_TRUE(Source.View(Data,Size));
+    EXPECT_EQ(Size,0);
+}
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "OSMStream.h"
+#include "OpenStreetMap.h"
+#include "StringDataSource.h"
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <string>
+
+static std::shared_ptr<CXMLReader> OpenReader(const std::string &osm){
+    return std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(osm));
+}
+
+static const std::string StreamOSM =
+    "<?xml version='1.0' encoding='UTF-8'?>\n"
+    "<osm version=\"0.6\">\n"
+    "\t<node id=\"30\" lat=\"38.5\" lon=\"-121.7\" version=\"2\"/>\n"
+    "\t<node id=\"10\" lat=\"38.6\" lon=\"-121.8\">\n"
+    "\t\t<tag k=\"highway\" v=\"traffic_signals\"/>\n"
+    "\t\t<tag k=\"name\" v=\"first\"/>\n"
+    "\t\t<tag k=\"highway\" v=\"stop\"/>\n"
+    "\t</node>\n"
+    "\t<way id=\"200\">\n"
+    "\t\t<nd ref=\"30\"/>\n"
+    "\t\t<nd ref=\"10\"/>\n"
+    "\t\t<tag k=\"highway\" v=\"residential\"/>\n"
+    "\t</way>\n"
+    "\t<relation id=\"5\">\n"
+    "\t\t<member type=\"way\" ref=\"200\" role=\"\"/>\n"
+    "\t\t<tag k=\"type\" v=\"route\"/>\n"
+    "\t</relation>\n"
+    "\t<way id=\"100\">\n"
+    "\t\t<nd ref=\"10\"/>\n"
+    "\t</way>\n"
+    "</osm>\n";
+
+TEST(OSMStream, NextTest){
+    COSMStream Stream(OpenReader(StreamOSM));
+
+    ASSERT_EQ(Stream.Next(), COSMStream::EElement::Node);
+    EXPECT_EQ(Stream.Node().ID(), 30);
+    EXPECT_EQ(Stream.Node().Location(), CStreetMap::TLocation(38.5, -121.7));
+    ASSERT_EQ(Stream.Node().AttributeCount(), 1);
+    EXPECT_EQ(Stream.Node().GetAttribute("version"), "2");
+
+    const CStreetMap::SNode *Scratch = &Stream.Node();
+    ASSERT_EQ(Stream.Next(), COSMStream::EElement::Node);
+    EXPECT_EQ(&Stream.Node(), Scratch);
+    EXPECT_EQ(Stream.Node().ID(), 10);
+    ASSERT_EQ(Stream.Node().AttributeCount(), 2);
+    EXPECT_EQ(Stream.Node().GetAttributeKey(0), "highway");
+    EXPECT_EQ(Stream.Node().GetAttributeKey(1), "name");
+    EXPECT_EQ(Stream.Node().GetAttributeKey(2), "");
+    EXPECT_EQ(Stream.Node().GetAttributeValue(0), "stop");
+    EXPECT_EQ(Stream.Node().GetAttributeValue(1), "first");
+    EXPECT_EQ(Stream.Node().GetAttributeValue(2), "");
+    EXPECT_EQ(Stream.Node().GetAttribute("highway"), "stop");
+    EXPECT_FALSE(Stream.Node().HasAttribute("version"));
+
+    ASSERT_EQ(Stream.Next(), COSMStream::EElement::Way);
+    EXPECT_EQ(Stream.Way().ID(), 200);
+    ASSERT_EQ(Stream.Way().NodeCount(), 2);
+    EXPECT_EQ(Stream.Way().GetNodeID(0), 30);
+    EXPECT_EQ(Stream.Way().GetNodeID(1), 10);
+    EXPECT_TRUE(Stream.Way().GetNodeID(2) == CStreetMap::InvalidNodeID);
+    EXPECT_EQ(Stream.Way().GetAttribute("highway"), "residential");
+    EXPECT_FALSE(Stream.Way().HasAttribute("type"));
+
+    ASSERT_EQ(Stream.Next(), COSMStream::EElement::Way);
+    EXPECT_EQ(Stream.Way().ID(), 100);
+    EXPECT_EQ(Stream.Way().NodeCount(), 1);
+    EXPECT_EQ(Stream.Way().AttributeCount(), 0);
+    EXPECT_EQ(Stream.Next(), COSMStream::EElement::None);
+    EXPECT_EQ(Stream.Next(), COSMStream::EElement::None);
+}
+
+TEST(OSMStream, SkipTest){
+    COSMStream Ways(OpenReader(StreamOSM));
+    ASSERT_TRUE(Ways.NextWay());
+    EXPECT_EQ(Ways.Way().ID(), 200);
+    EXPECT_EQ(Ways.Node().ID(), 10);
+    EXPECT_FALSE(Ways.NextNode());
+
+    COSMStream Nodes(OpenReader(StreamOSM));
+    EXPECT_TRUE(Nodes.NextNode());
+    EXPECT_TRUE(Nodes.NextNode());
+    EXPECT_FALSE(Nodes.NextNode());
+}
+
+// Counts elements and sums IDs, standing in for a streaming statistic
+struct SCountingVisitor : public COSMStream::SVisitor{
+    std::size_t Nodes = 0, Ways = 0, WayNodes = 0;
+    CStreetMap::TNodeID NodeIDSum = 0;
+
+    void Node(const COSMStream::SNode &node) override{
+        Nodes++;
+        NodeIDSum += node.ID();
+    }
+
+    void Way(const COSMStream::SWay &way) override{
+        Ways++;
+        WayNodes += way.NodeCount();
+    }
+};
+
+TEST(OSMStream, VisitTest){
+    COSMStream Stream(OpenReader(StreamOSM));
+    SCountingVisitor Visitor;
+    ASSERT_EQ(Stream.Next(), COSMStream::EElement::Node);
+    EXPECT_TRUE(Stream.Visit(Visitor));
+    EXPECT_EQ(Visitor.Nodes, 1);
+    EXPECT_EQ(Visitor.NodeIDSum, 10);
+    EXPECT_EQ(Visitor.Ways, 2);
+    EXPECT_EQ(Visitor.WayNodes, 3);
+
+    COSMStream Broken(OpenReader("<osm><node id=\"1\" lat=\"1\" lon=\"2\"/><way id=\"2\"></osm>"));
+    SCountingVisitor BrokenVisitor;
+    EXPECT_FALSE(Broken.Visit(BrokenVisitor));
+    EXPECT_EQ(BrokenVisitor.Nodes, 1);
+    EXPECT_EQ(BrokenVisitor.Ways, 0);
+}
+
+TEST(OSMStream, DavisTest){
+    std::ifstream Input("data/davis.osm");
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    auto OSM = Buffer.str();
+
+    COpenStreetMap Map(OpenReader(OSM));
+    COSMStream Stream(OpenReader(OSM));
+    std::size_t NodeIndex = 0, WayIndex = 0;
+    COSMStream::EElement Element;
+    while((Element = Stream.Next()) != COSMStream::EElement::None){
+        if(Element == COSMStream::EElement::Node){
+            auto Node = Map.NodeByIndex(NodeIndex++);
+            ASSERT_NE(Node, nullptr);
+            ASSERT_EQ(Stream.Node().ID(), Node->ID());
+            ASSERT_EQ(Stream.Node().AttributeCount(), Node->AttributeCount());
+        }
+        else{
+            auto Way = Map.WayByIndex(WayIndex++);
+            ASSERT_NE(Way, nullptr);
+            ASSERT_EQ(Stream.Way().ID(), Way->ID());
+            ASSERT_EQ(Stream.Way().NodeCount(), Way->NodeCount());
+            for(std::size_t Index = 0; Index < Way->AttributeCount(); Index++){
+                ASSERT_EQ(Stream.Way().GetAttributeKey(Index), Way->GetAttributeKey(Index));
+            }
+        }
+    }
+    EXPECT_EQ(NodeIndex, Map.NodeCount());
+    EXPECT_EQ(WayIndex, Map.WayCount());
+    EXPECT_GT(WayIndex, 0);
+}
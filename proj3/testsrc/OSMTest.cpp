@@ -0,0 +1,547 @@
+#include <gtest/gtest.h>
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include "StringDataSink.h"
+#include "MMapDataSource.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+
+// Loads an OSM document from a string through the real XML reader
+static std::shared_ptr<COpenStreetMap> LoadMap(const std::string &osm){
+    auto Source = std::make_shared<CStringDataSource>(osm);
+    auto Reader = std::make_shared<CXMLReader>(Source);
+    return std::make_shared<COpenStreetMap>(Reader);
+}
+
+static std::string LoadFile(const std::string &path){
+    std::ifstream Input(path);
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    return Buffer.str();
+}
+
+static const std::string SimpleOSM =
+    "<?xml version='1.0' encoding='UTF-8'?>\n"
+    "<osm version=\"0.6\">\n"
+    "\t<node id=\"30\" lat=\"38.5\" lon=\"-121.7\"/>\n"
+    "\t<node id=\"10\" lat=\"38.6\" lon=\"-121.8\">\n"
+    "\t\t<tag k=\"highway\" v=\"traffic_signals\"/>\n"
+    "\t</node>\n"
+    "\t<node id=\"20\" lat=\"38.7\" lon=\"-121.9\"/>\n"
+    "\t<way id=\"200\">\n"
+    "\t\t<nd ref=\"30\"/>\n"
+    "\t\t<nd ref=\"10\"/>\n"
+    "\t\t<tag k=\"highway\" v=\"residential\"/>\n"
+    "\t</way>\n"
+    "\t<way id=\"100\">\n"
+    "\t\t<nd ref=\"10\"/>\n"
+    "\t\t<nd ref=\"20\"/>\n"
+    "\t</way>\n"
+    "</osm>\n";
+
+TEST(OpenStreetMap, NodeByIDTest){
+    auto Map = LoadMap(SimpleOSM);
+
+    ASSERT_EQ(Map->NodeCount(), 3);
+    for(std::size_t Index = 0; Index < Map->NodeCount(); Index++){
+        auto Node = Map->NodeByIndex(Index);
+        ASSERT_NE(Node, nullptr);
+        auto Found = Map->NodeByID(Node->ID());
+        ASSERT_NE(Found, nullptr);
+        EXPECT_EQ(Found->ID(), Node->ID());
+        EXPECT_EQ(Found->Location(), Node->Location());
+    }
+    auto Node = Map->NodeByID(10);
+    ASSERT_NE(Node, nullptr);
+    EXPECT_EQ(Node->Location(), CStreetMap::TLocation(38.6, -121.8));
+    EXPECT_EQ(Node->GetAttribute("highway"), "traffic_signals");
+    EXPECT_EQ(Map->NodeByID(15), nullptr);
+    EXPECT_EQ(Map->NodeByID(CStreetMap::InvalidNodeID), nullptr);
+}
+
+TEST(OpenStreetMap, WayByIDTest){
+    auto Map = LoadMap(SimpleOSM);
+
+    ASSERT_EQ(Map->WayCount(), 2);
+    auto Way = Map->WayByID(200);
+    ASSERT_NE(Way, nullptr);
+    EXPECT_EQ(Way->ID(), Map->WayByIndex(0)->ID());
+    ASSERT_EQ(Way->NodeCount(), 2);
+    EXPECT_EQ(Way->GetNodeID(0), 30);
+    EXPECT_EQ(Way->GetNodeID(1), 10);
+    ASSERT_NE(Map->WayByID(100), nullptr);
+    EXPECT_EQ(Map->WayByID(100)->ID(), Map->WayByIndex(1)->ID());
+    EXPECT_EQ(Map->WayByID(300), nullptr);
+}
+
+TEST(OpenStreetMap, DuplicateIDTest){
+    auto Map = LoadMap("<osm><node id=\"1\" lat=\"1\" lon=\"2\"/><node id=\"1\" lat=\"3\" lon=\"4\"/></osm>");
+
+    ASSERT_EQ(Map->NodeCount(), 2);
+    ASSERT_NE(Map->NodeByID(1), nullptr);
+    EXPECT_EQ(Map->NodeByID(1)->Location(), CStreetMap::TLocation(1.0, 2.0));
+}
+
+TEST(OpenStreetMap, DavisTest){
+    auto Map = LoadMap(LoadFile("data/davis.osm"));
+
+    EXPECT_EQ(Map->NodeCount(), 10259);
+    EXPECT_EQ(Map->WayCount(), 1644);
+    std::unordered_set<CStreetMap::TNodeID> NodeIDs;
+    for(std::size_t Index = 0; Index < Map->NodeCount(); Index++){
+        NodeIDs.insert(Map->NodeByIndex(Index)->ID());
+    }
+    std::size_t Resolved = 0, Referenced = 0;
+    for(std::size_t Index = 0; Index < Map->WayCount(); Index++){
+        auto Way = Map->WayByIndex(Index);
+        EXPECT_EQ(Map->WayByID(Way->ID())->ID(), Way->ID());
+        for(std::size_t NodeIndex = 0; NodeIndex < Way->NodeCount(); NodeIndex++){
+            auto NodeID = Way->GetNodeID(NodeIndex);
+            auto Node = Map->NodeByID(NodeID);
+            EXPECT_EQ(Node != nullptr, NodeIDs.count(NodeID) != 0);
+            if(Node){
+                EXPECT_EQ(Node->ID(), NodeID);
+                Resolved++;
+            }
+            Referenced++;
+        }
+    }
+    EXPECT_GT(Resolved, 0);
+    EXPECT_LE(Resolved, Referenced);
+}
+
+TEST(OpenStreetMap, NodeAttributesTest){
+    auto Map = LoadMap("<osm><node id=\"5\" lat=\"38.5178523\" lon=\"-121.7712408\" version=\"2\">"
+                       "<tag k=\"name\" v=\"Stop A\"/><tag k=\"highway\" v=\"bus_stop\"/><tag k=\"name\" v=\"Stop B\"/>"
+                       "</node><node id=\"6\" lat=\"0\" lon=\"0\"/></osm>");
+
+    ASSERT_EQ(Map->NodeCount(), 2);
+    auto Node = Map->NodeByIndex(0);
+    EXPECT_EQ(Node->Location(), CStreetMap::TLocation(38.5178523, -121.7712408));
+    ASSERT_EQ(Node->AttributeCount(), 3);
+    EXPECT_EQ(Node->GetAttributeKey(0), "version");
+    EXPECT_EQ(Node->GetAttributeKey(1), "name");
+    EXPECT_EQ(Node->GetAttributeKey(2), "highway");
+    EXPECT_EQ(Node->GetAttributeKey(3), "");
+    EXPECT_TRUE(Node->HasAttribute("highway"));
+    EXPECT_FALSE(Node->HasAttribute("ref"));
+    EXPECT_EQ(Node->GetAttribute("name"), "Stop B");
+    EXPECT_EQ(Node->GetAttribute("ref"), "");
+    auto Untagged = Map->NodeByID(6);
+    ASSERT_NE(Untagged, nullptr);
+    EXPECT_EQ(Untagged->AttributeCount(), 0);
+    EXPECT_FALSE(Untagged->HasAttribute("name"));
+}
+
+TEST(OpenStreetMap, NodeOutlivesMapTest){
+    std::shared_ptr<CStreetMap::SNode> Node;
+    {
+        auto Map = LoadMap(SimpleOSM);
+        Node = Map->NodeByID(10);
+    }
+    ASSERT_NE(Node, nullptr);
+    EXPECT_EQ(Node->ID(), 10);
+    EXPECT_EQ(Node->GetAttribute("highway"), "traffic_signals");
+}
+
+// Source without a contiguous view so snapshots have to be copied in
+class CBlockOnlyDataSource : public CDataSource {
+    private:
+        CStringDataSource DSource;
+    public:
+        CBlockOnlyDataSource(const std::string &str) : DSource(str) {}
+
+        bool End() const noexcept override { return DSource.End(); }
+        bool Get(char &ch) noexcept override { return DSource.Get(ch); }
+        bool Peek(char &ch) noexcept override { return DSource.Peek(ch); }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override { return DSource.Read(buf, count); }
+};
+
+static std::string WriteSnapshot(const COpenStreetMap &map){
+    auto Sink = std::make_shared<CStringDataSink>();
+    EXPECT_TRUE(map.WriteSnapshot(Sink));
+    return Sink->String();
+}
+
+// Compares everything visible through the CStreetMap interface
+static void ExpectSameMap(const CStreetMap &expected, const CStreetMap &actual){
+    ASSERT_EQ(expected.NodeCount(), actual.NodeCount());
+    ASSERT_EQ(expected.WayCount(), actual.WayCount());
+    for(std::size_t Index = 0; Index < expected.NodeCount(); Index++){
+        auto Expected = expected.NodeByIndex(Index);
+        auto Actual = actual.NodeByIndex(Index);
+        ASSERT_EQ(Expected->ID(), Actual->ID());
+        EXPECT_EQ(Expected->Location(), Actual->Location());
+        ASSERT_EQ(Expected->AttributeCount(), Actual->AttributeCount());
+        for(std::size_t AttributeIndex = 0; AttributeIndex < Expected->AttributeCount(); AttributeIndex++){
+            auto Key = Expected->GetAttributeKey(AttributeIndex);
+            EXPECT_EQ(Key, Actual->GetAttributeKey(AttributeIndex));
+            EXPECT_EQ(Expected->GetAttribute(Key), Actual->GetAttribute(Key));
+        }
+        ASSERT_NE(actual.NodeByID(Expected->ID()), nullptr);
+        EXPECT_EQ(expected.NodeByID(Expected->ID())->Location(), actual.NodeByID(Expected->ID())->Location());
+    }
+    for(std::size_t Index = 0; Index < expected.WayCount(); Index++){
+        auto Expected = expected.WayByIndex(Index);
+        auto Actual = actual.WayByIndex(Index);
+        ASSERT_EQ(Expected->ID(), Actual->ID());
+        ASSERT_EQ(Expected->NodeCount(), Actual->NodeCount());
+        for(std::size_t NodeIndex = 0; NodeIndex < Expected->NodeCount(); NodeIndex++){
+            EXPECT_EQ(Expected->GetNodeID(NodeIndex), Actual->GetNodeID(NodeIndex));
+        }
+        ASSERT_EQ(Expected->AttributeCount(), Actual->AttributeCount());
+        for(std::size_t AttributeIndex = 0; AttributeIndex < Expected->AttributeCount(); AttributeIndex++){
+            auto Key = Expected->GetAttributeKey(AttributeIndex);
+            EXPECT_EQ(Key, Actual->GetAttributeKey(AttributeIndex));
+            EXPECT_EQ(Expected->GetAttribute(Key), Actual->GetAttribute(Key));
+        }
+        ASSERT_NE(actual.WayByID(Expected->ID()), nullptr);
+        EXPECT_EQ(actual.WayByID(Expected->ID())->ID(), Expected->ID());
+    }
+}
+
+TEST(OpenStreetMap, SnapshotRoundTripTest){
+    auto Map = LoadMap(LoadFile("data/davis.osm"));
+    auto Snapshot = WriteSnapshot(*Map);
+
+    auto Loaded = COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(Snapshot));
+    ASSERT_NE(Loaded, nullptr);
+    ExpectSameMap(*Map, *Loaded);
+    // writing a loaded snapshot again gives the same bytes
+    EXPECT_EQ(WriteSnapshot(*Loaded), Snapshot);
+}
+
+TEST(OpenStreetMap, SnapshotUnsortedTest){
+    auto Map = LoadMap(SimpleOSM);
+    auto Loaded = COpenStreetMap::LoadSnapshot(std::make_shared<CBlockOnlyDataSource>(WriteSnapshot(*Map)));
+
+    ASSERT_NE(Loaded, nullptr);
+    ExpectSameMap(*Map, *Loaded);
+    ASSERT_NE(Loaded->NodeByID(10), nullptr);
+    EXPECT_EQ(Loaded->NodeByID(10)->GetAttribute("highway"), "traffic_signals");
+    ASSERT_NE(Loaded->WayByID(100), nullptr);
+    EXPECT_EQ(Loaded->WayByID(100)->GetNodeID(1), 20);
+}
+
+TEST(OpenStreetMap, SnapshotMMapTest){
+    std::string Filename = "osmsnapshottest.tmp";
+    auto Map = LoadMap(LoadFile("data/davis.osm"));
+    {
+        std::ofstream Output(Filename, std::ios::binary);
+        Output << WriteSnapshot(*Map);
+    }
+    std::shared_ptr<CStreetMap::SWay> Way;
+    {
+        auto Source = std::make_shared<CMMapDataSource>(Filename);
+        ASSERT_TRUE(Source->Valid());
+        auto Loaded = COpenStreetMap::LoadSnapshot(Source);
+        ASSERT_NE(Loaded, nullptr);
+        ExpectSameMap(*Map, *Loaded);
+        Way = Loaded->WayByIndex(0);
+    }
+    // the mapping stays alive as long as something still points into it
+    std::remove(Filename.c_str());
+    EXPECT_EQ(Way->ID(), Map->WayByIndex(0)->ID());
+    EXPECT_EQ(Way->NodeCount(), Map->WayByIndex(0)->NodeCount());
+}
+
+TEST(OpenStreetMap, SnapshotEmptyTest){
+    auto Map = LoadMap("<osm></osm>");
+    auto Loaded = COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(WriteSnapshot(*Map)));
+
+    ASSERT_NE(Loaded, nullptr);
+    EXPECT_EQ(Loaded->NodeCount(), 0);
+    EXPECT_EQ(Loaded->WayCount(), 0);
+    EXPECT_EQ(Loaded->NodeByID(1), nullptr);
+    EXPECT_EQ(Loaded->WayByID(1), nullptr);
+}
+
+TEST(OpenStreetMap, SnapshotInvalidTest){
+    auto Snapshot = WriteSnapshot(*LoadMap(SimpleOSM));
+
+    EXPECT_EQ(COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>("")), nullptr);
+    EXPECT_EQ(COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(SimpleOSM)), nullptr);
+    EXPECT_EQ(COpenStreetMap::LoadSnapshot(nullptr), nullptr);
+    for(std::size_t Length = 0; Length < Snapshot.length(); Length += 7){
+        EXPECT_EQ(COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(Snapshot.substr(0, Length))), nullptr);
+    }
+    auto Corrupt = Snapshot;
+    Corrupt[8]++;  // unknown version
+    EXPECT_EQ(COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(Corrupt)), nullptr);
+}
+
+// Element sizes of the snapshot columns in file order
+static const std::size_t SnapshotElementSizes[] = {1, 4, 8, 4, 4, 4, 4, 4, 4, 8, 4, 8, 4, 4, 4, 4};
+enum ESnapshotColumn{StringData, StringOffsets, NodeIDs, NodeLatitudes, NodeLongitudes, NodeTagOffsets, NodeTagKeys, NodeTagValues, NodeIDOrder,
+                     WayIDs, WayNodeOffsets, WayNodeIDs, WayTagOffsets, WayTagKeys, WayTagValues, WayIDOrder};
+
+// Overwrites element index of a uint32 column in place, following the snapshot layout
+static std::string PatchSnapshot(std::string snapshot, ESnapshotColumn column, std::size_t index, uint32_t value){
+    std::size_t Offset = 16;
+    for(int Column = 0; Column <= column; Column++){
+        uint64_t Count;
+        std::memcpy(&Count, snapshot.data() + Offset, sizeof(Count));
+        Offset += sizeof(Count);
+        if(Column == column){
+            EXPECT_LT(index, Count);
+            std::memcpy(&snapshot[Offset + index * sizeof(value)], &value, sizeof(value));
+            break;
+        }
+        Offset += Count * SnapshotElementSizes[Column];
+        Offset += (8 - Offset % 8) % 8;
+    }
+    return snapshot;
+}
+
+TEST(OpenStreetMap, SnapshotCorruptIndexTest){
+    auto Snapshot = WriteSnapshot(*LoadMap(SimpleOSM));
+    auto Load = [](const std::string &snapshot){
+        return COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(snapshot));
+    };
+    ASSERT_NE(Load(Snapshot), nullptr);
+    ASSERT_NE(Load(PatchSnapshot(Snapshot, NodeTagKeys, 0, 0)), nullptr);
+
+    // string IDs past the string table
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, NodeTagKeys, 0, 1000)), nullptr);
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, NodeTagValues, 0, 4)), nullptr);
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, WayTagValues, 0, 0xFFFFFFFF)), nullptr);
+    // offsets that step backwards while the first and last entries stay valid
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, StringOffsets, 1, 1000)), nullptr);
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, NodeTagOffsets, 2, 2)), nullptr);
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, WayNodeOffsets, 1, 5)), nullptr);
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, WayTagOffsets, 1, 2)), nullptr);
+    // ID orders pointing past the table or out of order
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, NodeIDOrder, 2, 1000)), nullptr);
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, NodeIDOrder, 0, 0)), nullptr);
+    EXPECT_EQ(Load(PatchSnapshot(Snapshot, WayIDOrder, 1, 2)), nullptr);
+}
+
+static std::shared_ptr<COpenStreetMap> LoadMap(const std::string &osm, const COpenStreetMap::SLoadOptions &options){
+    return std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(osm)), options);
+}
+
+TEST(OpenStreetMap, LoadBoundsTest){
+    COpenStreetMap::SLoadOptions Options;
+    Options.DUseBounds = true;
+    Options.DMinimum = CStreetMap::TLocation(38.45, -121.85);
+    Options.DMaximum = CStreetMap::TLocation(38.65, -121.65);
+    auto Map = LoadMap(SimpleOSM, Options);
+
+    EXPECT_EQ(Map->NodeCount(), 2);
+    EXPECT_NE(Map->NodeByID(30), nullptr);
+    EXPECT_NE(Map->NodeByID(10), nullptr);
+    EXPECT_EQ(Map->NodeByID(20), nullptr);
+    // both ways touch the box, way 100 keeps its reference to the dropped node
+    ASSERT_EQ(Map->WayCount(), 2);
+    ASSERT_NE(Map->WayByID(100), nullptr);
+    EXPECT_EQ(Map->WayByID(100)->GetNodeID(1), 20);
+
+    Options.DMinimum = CStreetMap::TLocation(38.65, -122.0);
+    Options.DMaximum = CStreetMap::TLocation(38.75, -121.85);
+    Map = LoadMap(SimpleOSM, Options);
+    ASSERT_EQ(Map->NodeCount(), 1);
+    EXPECT_EQ(Map->NodeByIndex(0)->ID(), 20);
+    ASSERT_EQ(Map->WayCount(), 1);
+    EXPECT_EQ(Map->WayByIndex(0)->ID(), 100);
+}
+
+TEST(OpenStreetMap, LoadFilterTest){
+    COpenStreetMap::SLoadOptions Options;
+    Options.DNodeFilter = [](const CStreetMap::SNode &node){
+        return node.HasAttribute("highway");
+    };
+    Options.DWayFilter = [](const CStreetMap::SWay &way){
+        return way.NodeCount() > 5;
+    };
+    auto Map = LoadMap(SimpleOSM, Options);
+    ASSERT_EQ(Map->NodeCount(), 1);
+    EXPECT_EQ(Map->NodeByIndex(0)->GetAttribute("highway"), "traffic_signals");
+    EXPECT_EQ(Map->WayCount(), 0);
+}
+
+TEST(OpenStreetMap, LoadReferencedNodesTest){
+    COpenStreetMap::SLoadOptions Options;
+    Options.DWayFilter = [](const CStreetMap::SWay &way){
+        return way.HasAttribute("highway");
+    };
+    Options.DReferencedNodesOnly = true;
+    auto Map = LoadMap(SimpleOSM, Options);
+
+    ASSERT_EQ(Map->WayCount(), 1);
+    EXPECT_EQ(Map->WayByIndex(0)->GetAttribute("highway"), "residential");
+    ASSERT_EQ(Map->NodeCount(), 2);
+    EXPECT_EQ(Map->NodeByIndex(0)->ID(), 30);
+    EXPECT_EQ(Map->NodeByIndex(1)->ID(), 10);
+    EXPECT_EQ(Map->NodeByIndex(0)->AttributeCount(), 0);
+    EXPECT_EQ(Map->NodeByID(10)->GetAttribute("highway"), "traffic_signals");
+    EXPECT_EQ(Map->NodeByID(20), nullptr);
+
+    Options.DWayFilter = [](const CStreetMap::SWay &way){
+        return false;
+    };
+    Map = LoadMap(SimpleOSM, Options);
+    EXPECT_EQ(Map->NodeCount(), 0);
+    EXPECT_EQ(Map->WayCount(), 0);
+    EXPECT_EQ(Map->NodeByID(10), nullptr);
+}
+
+TEST(OpenStreetMap, LoadDavisNamedWaysTest){
+    auto OSM = LoadFile("data/davis.osm");
+    auto Full = LoadMap(OSM);
+    COpenStreetMap::SLoadOptions Options;
+    Options.DWayFilter = [](const CStreetMap::SWay &way){
+        return way.HasAttribute("name");
+    };
+    Options.DReferencedNodesOnly = true;
+    auto Map = LoadMap(OSM, Options);
+
+    ASSERT_GT(Map->WayCount(), 0);
+    EXPECT_LT(Map->WayCount(), Full->WayCount());
+    EXPECT_LT(Map->NodeCount(), Full->NodeCount());
+    std::unordered_set<CStreetMap::TNodeID> Referenced;
+    for(std::size_t Index = 0; Index < Map->WayCount(); Index++){
+        auto Way = Map->WayByIndex(Index);
+        EXPECT_TRUE(Way->HasAttribute("name"));
+        for(std::size_t NodeIndex = 0; NodeIndex < Way->NodeCount(); NodeIndex++){
+            // the extract has ways running past its edge, those nodes are missing either way
+            auto FullNode = Full->NodeByID(Way->GetNodeID(NodeIndex));
+            auto Node = Map->NodeByID(Way->GetNodeID(NodeIndex));
+            ASSERT_EQ(Node == nullptr, FullNode == nullptr);
+            if(!Node){
+                continue;
+            }
+            ASSERT_EQ(Node->Location(), FullNode->Location());
+            ASSERT_EQ(Node->AttributeCount(), FullNode->AttributeCount());
+            for(std::size_t Attribute = 0; Attribute < Node->AttributeCount(); Attribute++){
+                auto Key = FullNode->GetAttributeKey(Attribute);
+                ASSERT_EQ(Node->GetAttribute(Key), FullNode->GetAttribute(Key));
+            }
+            Referenced.insert(Node->ID());
+        }
+    }
+    EXPECT_EQ(Map->NodeCount(), Referenced.size());
+
+    auto Loaded = COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(WriteSnapshot(*Map)));
+    ASSERT_NE(Loaded, nullptr);
+    EXPECT_EQ(Loaded->NodeCount(), Map->NodeCount());
+}
+
+TEST(OpenStreetMap, AttributeOrderTest){
+    // more tags than any small buffer, with keys that would hash in a different order
+    std::string OSM = "<osm><node id=\"1\" lat=\"1\" lon=\"2\">";
+    for(int Index = 40; Index > 0; Index--){
+        OSM += "<tag k=\"key" + std::to_string(Index * 37 % 101) + "\" v=\"" + std::to_string(Index) + "\"/>";
+    }
+    OSM += "<tag k=\"key" + std::to_string(40 * 37 % 101) + "\" v=\"last\"/></node>";
+    OSM += "<way id=\"2\"><nd ref=\"1\"/><tag k=\"b\" v=\"1\"/><tag k=\"a\" v=\"2\"/></way></osm>";
+    auto Map = LoadMap(OSM);
+
+    auto Node = Map->NodeByID(1);
+    ASSERT_NE(Node, nullptr);
+    ASSERT_EQ(Node->AttributeCount(), 40);
+    for(int Index = 40; Index > 0; Index--){
+        std::size_t Position = 40 - Index;
+        EXPECT_EQ(Node->GetAttributeKey(Position), "key" + std::to_string(Index * 37 % 101));
+        EXPECT_EQ(Node->GetAttributeValue(Position), Index == 40 ? "last" : std::to_string(Index));
+        EXPECT_EQ(Node->GetAttribute(Node->GetAttributeKey(Position)), Node->GetAttributeValue(Position));
+    }
+    EXPECT_EQ(Node->GetAttributeValue(40), "");
+
+    auto Way = Map->WayByID(2);
+    ASSERT_NE(Way, nullptr);
+    ASSERT_EQ(Way->AttributeCount(), 2);
+    EXPECT_EQ(Way->GetAttributeKey(0), "b");
+    EXPECT_EQ(Way->GetAttributeValue(0), "1");
+    EXPECT_EQ(Way->GetAttributeKey(1), "a");
+    EXPECT_EQ(Way->GetAttributeValue(1), "2");
+    EXPECT_EQ(Way->GetAttributeValue(2), "");
+}
+
+// Implements only the required members, so GetAttributeValue falls back to the lookup by key
+struct SSingleTagNode : public CStreetMap::SNode{
+    CStreetMap::TNodeID ID() const noexcept override { return 1; }
+    CStreetMap::TLocation Location() const noexcept override { return CStreetMap::TLocation(0.0, 0.0); }
+    std::size_t AttributeCount() const noexcept override { return 1; }
+    std::string GetAttributeKey(std::size_t index) const noexcept override { return index ? "" : "name"; }
+    bool HasAttribute(const std::string &key) const noexcept override { return key == "name"; }
+    std::string GetAttribute(const std::string &key) const noexcept override { return key == "name" ? "value" : ""; }
+};
+
+TEST(OpenStreetMap, AttributeValueDefaultTest){
+    SSingleTagNode Node;
+    const CStreetMap::SNode &Base = Node;
+    EXPECT_EQ(Base.GetAttributeValue(0), "value");
+    EXPECT_EQ(Base.GetAttributeValue(1), "");
+}
+
+TEST(OpenStreetMap, HandleTest){
+    auto Map = LoadMap(SimpleOSM);
+    static_assert(std::is_trivially_copyable<COpenStreetMap::CNodeHandle>::value, "node handles must be trivially copyable");
+    static_assert(std::is_trivially_copyable<COpenStreetMap::CWayHandle>::value, "way handles must be trivially copyable");
+
+    std::size_t Index = 0;
+    for(auto Node : Map->Nodes()){
+        auto Shared = Map->NodeByIndex(Index++);
+        EXPECT_EQ(Node.ID(), Shared->ID());
+        EXPECT_EQ(Node.Location(), Shared->Location());
+        EXPECT_EQ(Node.AttributeCount(), Shared->AttributeCount());
+    }
+    EXPECT_EQ(Index, Map->NodeCount());
+    EXPECT_EQ(Map->Nodes().size(), 3);
+
+    auto Node = Map->NodeHandleByID(10);
+    ASSERT_TRUE(Node);
+    EXPECT_EQ(Node.Index(), 1);
+    EXPECT_EQ(Node.GetAttributeKey(0), "highway");
+    EXPECT_EQ(Node.GetAttributeValue(0), "traffic_signals");
+    EXPECT_TRUE(Node.HasAttribute("highway"));
+    EXPECT_EQ(Node.GetAttribute("highway"), "traffic_signals");
+    EXPECT_FALSE(Map->NodeHandleByID(11));
+    EXPECT_FALSE(Map->NodeHandleByIndex(3));
+
+    Index = 0;
+    for(auto Way : Map->Ways()){
+        auto Shared = Map->WayByIndex(Index++);
+        EXPECT_EQ(Way.ID(), Shared->ID());
+        ASSERT_EQ(Way.NodeCount(), Shared->NodeCount());
+        for(std::size_t NodeIndex = 0; NodeIndex <= Way.NodeCount(); NodeIndex++){
+            EXPECT_EQ(Way.GetNodeID(NodeIndex), Shared->GetNodeID(NodeIndex));
+        }
+    }
+    EXPECT_EQ(Index, Map->WayCount());
+
+    auto Way = Map->WayHandleByID(200);
+    ASSERT_TRUE(Way);
+    EXPECT_EQ(Way.GetAttribute("highway"), "residential");
+    EXPECT_EQ(Way.GetAttributeKey(0), "highway");
+    EXPECT_EQ(Way.GetAttributeValue(0), "residential");
+    EXPECT_FALSE(Way.HasAttribute("name"));
+    EXPECT_EQ(Way.AttributeCount(), 1);
+    EXPECT_FALSE(Map->WayHandleByID(300));
+    EXPECT_FALSE(Map->WayHandleByIndex(2));
+}
+
+TEST(OpenStreetMap, SnapshotHandleTest){
+    auto Map = LoadMap(SimpleOSM);
+    auto Loaded = COpenStreetMap::LoadSnapshot(std::make_shared<CStringDataSource>(WriteSnapshot(*Map)));
+    ASSERT_NE(Loaded, nullptr);
+
+    auto Node = Loaded->NodeHandleByID(20);
+    ASSERT_TRUE(Node);
+    EXPECT_EQ(Node.Location(), Map->NodeByID(20)->Location());
+    auto Way = Loaded->WayHandleByID(100);
+    ASSERT_TRUE(Way);
+    EXPECT_EQ(Way.NodeCount(), 2);
+    EXPECT_EQ(Way.GetNodeID(1), 20);
+
+    auto Empty = LoadMap("<osm></osm>");
+    EXPECT_EQ(Empty->Nodes().begin(), Empty->Nodes().end());
+    EXPECT_EQ(Empty->Ways().size(), 0);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "PrefetchDataSource.h"
+#include "StringDataSource.h"
+#include "DSVReader.h"
+#include "XMLReader.h"
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Source that is slow to produce data, like a disk or a decompressor
+class CSlowDataSource : public CDataSource{
+    private:
+        CStringDataSource DSource;
+    public:
+        CSlowDataSource(const std::string &str) : DSource(str) {}
+
+        bool End() const noexcept override { return DSource.End(); }
+        bool Get(char &ch) noexcept override { return DSource.Get(ch); }
+        bool Peek(char &ch) noexcept override { return DSource.Peek(ch); }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return DSource.Read(buf, count);
+        }
+};
+
+static std::string Letters(std::size_t size){
+    std::string Contents;
+    for(std::size_t Index = 0; Index < size; Index++){
+        Contents += static_cast<char>('a' + Index % 26);
+    }
+    return Contents;
+}
+
+TEST(PrefetchDataSourceTest, EmptySource){
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>(""));
+    char TempCh = 'x';
+    std::vector<char> TempVector;
+
+    EXPECT_TRUE(Source.End());
+    EXPECT_FALSE(Source.Get(TempCh));
+    EXPECT_FALSE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh, 'x');
+    EXPECT_FALSE(Source.Read(TempVector, 4));
+    EXPECT_EQ(Source.Skip(4), 0);
+
+    CPrefetchDataSource Missing(nullptr);
+    EXPECT_TRUE(Missing.End());
+}
+
+TEST(PrefetchDataSourceTest, GetPeek){
+    auto Contents = Letters(10000);
+    CPrefetchDataSource Source(std::make_shared<CSlowDataSource>(Contents), 100, 3);
+    std::string Copy;
+    char TempCh;
+
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh, 'a');
+    while(!Source.End()){
+        EXPECT_TRUE(Source.Peek(TempCh));
+        EXPECT_TRUE(Source.Get(TempCh));
+        Copy += TempCh;
+    }
+    EXPECT_EQ(Copy, Contents);
+    EXPECT_FALSE(Source.Get(TempCh));
+}
+
+TEST(PrefetchDataSourceTest, ReadSkip){
+    auto Contents = Letters(10000);
+    CPrefetchDataSource Source(std::make_shared<CStringDataSource>(Contents), 256, 2);
+    std::vector<char> TempVector;
+    char TempCh;
+
+    // a whole block is handed over, then reads cut across blocks
+    EXPECT_TRUE(Source.Read(TempVector, 256));
+    EXPECT_EQ(std::string(TempVector.begin(), TempVector.end()), Contents.substr(0, 256));
+    EXPECT_TRUE(Source.Read(TempVector, 300));
+    EXPECT_EQ(std::string(TempVector.begin(), TempVector.end()), Contents.substr(256, 300));
+    EXPECT_EQ(Source.Skip(1000), 1000);
+    EXPECT_TRUE(Source.Get(TempCh));
+    EXPECT_EQ(TempCh, Contents[1556]);
+    EXPECT_TRUE(Source.Read(TempVector, 100000));
+    EXPECT_EQ(std::string(TempVector.begin(), TempVector.end()), Contents.substr(1557));
+    EXPECT_TRUE(Source.End());
+    EXPECT_EQ(Source.Skip(10), 0);
+}
+
+TEST(PrefetchDataSourceTest, AbandonedEarly){
+    // the reader thread must stop even though the ring is full and nobody reads
+    auto Source = std::make_unique<CPrefetchDataSource>(std::make_shared<CStringDataSource>(Letters(100000)), 16, 2);
+    char TempCh;
+    EXPECT_TRUE(Source->Get(TempCh));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    Source.reset();
+}
+
+TEST(PrefetchDataSourceTest, WrappedReaders){
+    std::string CSV;
+    for(int Index = 0; Index < 2000; Index++){
+        CSV += std::to_string(Index) + ",\"a, " + std::to_string(Index) + "\"\n";
+    }
+    CDSVReader Reader(std::make_shared<CPrefetchDataSource>(std::make_shared<CSlowDataSource>(CSV), 1000), ',');
+    std::vector<std::string> Row;
+    for(int Index = 0; Index < 2000; Index++){
+        ASSERT_TRUE(Reader.ReadRow(Row));
+        EXPECT_EQ(Row, std::vector<std::string>({std::to_string(Index), "a, " + std::to_string(Index)}));
+    }
+    EXPECT_FALSE(Reader.ReadRow(Row));
+
+    CXMLReader XMLReader(std::make_shared<CPrefetchDataSource>(std::make_shared<CSlowDataSource>("<osm><node id=\"1\"/><node id=\"2\"/></osm>"), 7));
+    SXMLEntity Entity;
+    std::size_t Count = 0;
+    while(XMLReader.ReadEntity(Entity)){
+        Count++;
+    }
+    EXPECT_EQ(Count, 6);
+    EXPECT_TRUE(XMLReader.End());
+}
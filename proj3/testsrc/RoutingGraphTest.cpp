@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "RoutingGraph.h"
+#include "GeographicUtils.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+static std::shared_ptr<COpenStreetMap> LoadMap(const std::string &osm){
+    return std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(osm)));
+}
+
+static std::shared_ptr<COpenStreetMap> LoadDavis(){
+    std::ifstream Input("data/davis.osm");
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    return LoadMap(Buffer.str());
+}
+
+// A square 1-2-3-4 with a one way diagonal 1->3, a reversed one way 4<-3 and
+// a footpath 5 that is not highway tagged
+static const std::string SquareOSM =
+    "<osm>"
+    "<node id=\"1\" lat=\"38.000\" lon=\"-121.000\"/>"
+    "<node id=\"2\" lat=\"38.000\" lon=\"-120.999\"/>"
+    "<node id=\"3\" lat=\"38.001\" lon=\"-120.999\"/>"
+    "<node id=\"4\" lat=\"38.001\" lon=\"-121.000\"/>"
+    "<node id=\"5\" lat=\"38.002\" lon=\"-121.000\"/>"
+    "<way id=\"10\"><nd ref=\"1\"/><nd ref=\"2\"/><nd ref=\"3\"/><tag k=\"highway\" v=\"residential\"/></way>"
+    "<way id=\"11\"><nd ref=\"4\"/><nd ref=\"3\"/><tag k=\"highway\" v=\"residential\"/><tag k=\"oneway\" v=\"-1\"/></way>"
+    "<way id=\"12\"><nd ref=\"4\"/><nd ref=\"1\"/><tag k=\"highway\" v=\"residential\"/></way>"
+    "<way id=\"13\"><nd ref=\"1\"/><nd ref=\"3\"/><tag k=\"highway\" v=\"service\"/><tag k=\"oneway\" v=\"yes\"/></way>"
+    "<way id=\"14\"><nd ref=\"4\"/><nd ref=\"5\"/><tag k=\"building\" v=\"yes\"/></way>"
+    "<way id=\"15\"><nd ref=\"5\"/><nd ref=\"99\"/><nd ref=\"4\"/><tag k=\"highway\" v=\"proposed\"/></way>"
+    "</osm>";
+
+static double Length(const CStreetMap &map, std::initializer_list<CStreetMap::TNodeID> nodes){
+    double Total = 0.0;
+    for(auto It = nodes.begin(); It + 1 != nodes.end(); It++){
+        Total += GeographicUtils::HaversineDistance(map.NodeByID(*It)->Location(), map.NodeByID(*(It + 1))->Location());
+    }
+    return Total;
+}
+
+TEST(RoutingGraph, SquareTest){
+    auto Map = LoadMap(SquareOSM);
+    CRoutingGraph Graph(Map);
+    CRoutingGraph::CWorkspace Workspace;
+    std::vector<CStreetMap::TNodeID> Path;
+
+    EXPECT_EQ(Graph.VertexCount(), 4);
+    EXPECT_EQ(Graph.EdgeCount(), 8);
+    EXPECT_EQ(Graph.VertexByNodeID(5), CRoutingGraph::InvalidVertex);
+    EXPECT_EQ(Graph.NodeIDByVertex(Graph.VertexByNodeID(3)), 3);
+    EXPECT_TRUE(Graph.NodeIDByVertex(100) == CStreetMap::InvalidNodeID);
+
+    // the diagonal is one way, so going back has to follow the sides
+    EXPECT_DOUBLE_EQ(Graph.FindShortestPath(1, 3, Path, Workspace), Length(*Map, {1, 3}));
+    EXPECT_EQ(Path, std::vector<CStreetMap::TNodeID>({1, 3}));
+    EXPECT_DOUBLE_EQ(Graph.FindShortestPath(3, 1, Path, Workspace), Length(*Map, {3, 4, 1}));
+    EXPECT_EQ(Path, std::vector<CStreetMap::TNodeID>({3, 4, 1}));
+    EXPECT_DOUBLE_EQ(Graph.FindShortestPathAStar(3, 1, Path, Workspace), Length(*Map, {3, 4, 1}));
+    EXPECT_EQ(Path, std::vector<CStreetMap::TNodeID>({3, 4, 1}));
+    EXPECT_DOUBLE_EQ(Graph.FindShortestPath(4, 2, Path), Length(*Map, {4, 1, 2}));
+    EXPECT_EQ(Path, std::vector<CStreetMap::TNodeID>({4, 1, 2}));
+
+    EXPECT_EQ(Graph.FindShortestPath(2, 2, Path, Workspace), 0.0);
+    EXPECT_EQ(Path, std::vector<CStreetMap::TNodeID>({2}));
+    EXPECT_EQ(Graph.FindShortestPath(1, 5, Path, Workspace), CRoutingGraph::NoPathExists);
+    EXPECT_TRUE(Path.empty());
+    EXPECT_EQ(Graph.FindShortestPathAStar(99, 1, Path), CRoutingGraph::NoPathExists);
+    EXPECT_TRUE(Path.empty());
+}
+
+TEST(RoutingGraph, UnreachableTest){
+    auto Map = LoadMap("<osm><node id=\"1\" lat=\"0\" lon=\"0\"/><node id=\"2\" lat=\"0\" lon=\"0.001\"/><node id=\"3\" lat=\"0\" lon=\"0.002\"/>"
+                       "<way id=\"1\"><nd ref=\"1\"/><nd ref=\"2\"/><nd ref=\"3\"/><tag k=\"highway\" v=\"primary\"/><tag k=\"junction\" v=\"roundabout\"/></way></osm>");
+    CRoutingGraph Graph(Map);
+    std::vector<CStreetMap::TNodeID> Path;
+
+    EXPECT_EQ(Graph.EdgeCount(), 2);
+    EXPECT_NE(Graph.FindShortestPath(1, 3, Path), CRoutingGraph::NoPathExists);
+    EXPECT_EQ(Path.size(), 3);
+    EXPECT_EQ(Graph.FindShortestPath(3, 1, Path), CRoutingGraph::NoPathExists);
+    EXPECT_EQ(Graph.FindShortestPathAStar(3, 1, Path), CRoutingGraph::NoPathExists);
+}
+
+TEST(RoutingGraph, DavisTest){
+    auto Map = LoadDavis();
+    CRoutingGraph Graph(Map);
+    CRoutingGraph::CWorkspace Workspace;
+    std::vector<CStreetMap::TNodeID> Path, AStarPath;
+
+    ASSERT_GT(Graph.VertexCount(), 0);
+    std::mt19937 Generator(34);
+    std::uniform_int_distribution<CRoutingGraph::TVertex> Distribution(0, Graph.VertexCount() - 1);
+    std::size_t Found = 0;
+    for(int Query = 0; Query < 100; Query++){
+        auto Source = Graph.NodeIDByVertex(Distribution(Generator));
+        auto Destination = Graph.NodeIDByVertex(Distribution(Generator));
+        double Distance = Graph.FindShortestPath(Source, Destination, Path, Workspace);
+        double AStarDistance = Graph.FindShortestPathAStar(Source, Destination, AStarPath, Workspace);
+        if(Distance == CRoutingGraph::NoPathExists){
+            EXPECT_EQ(AStarDistance, CRoutingGraph::NoPathExists);
+            continue;
+        }
+        Found++;
+        EXPECT_NEAR(Distance, AStarDistance, 1e-6);
+        ASSERT_FALSE(Path.empty());
+        EXPECT_EQ(Path.front(), Source);
+        EXPECT_EQ(Path.back(), Destination);
+        EXPECT_EQ(AStarPath.front(), Source);
+        EXPECT_EQ(AStarPath.back(), Destination);
+        // never shorter than the straight line
+        EXPECT_GE(Distance + 1e-6, GeographicUtils::HaversineDistance(Map->NodeByID(Source)->Location(), Map->NodeByID(Destination)->Location()));
+    }
+    EXPECT_GT(Found, 50);
+}
+
+TEST(RoutingGraph, ThreadsTest){
+    auto Map = LoadDavis();
+    CRoutingGraph Graph(Map);
+    std::vector<CStreetMap::TNodeID> Path;
+    auto Source = Graph.NodeIDByVertex(0), Destination = Graph.NodeIDByVertex(Graph.VertexCount() / 2);
+    double Expected = Graph.FindShortestPath(Source, Destination, Path);
+
+    std::vector<double> Results(4);
+    std::vector<std::thread> Threads;
+    for(std::size_t Index = 0; Index < Results.size(); Index++){
+        Threads.emplace_back([&, Index](){
+            std::vector<CStreetMap::TNodeID> ThreadPath;
+            for(int Repeat = 0; Repeat < 10; Repeat++){
+                Results[Index] = Index % 2 ? Graph.FindShortestPath(Source, Destination, ThreadPath) : Graph.FindShortestPathAStar(Source, Destination, ThreadPath);
+            }
+        });
+    }
+    for(auto &Thread : Threads){
+        Thread.join();
+    }
+    for(auto Result : Results){
+        EXPECT_NEAR(Result, Expected, 1e-6);
+    }
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "StreetMapIndex.h"
+#include "GeographicUtils.h"
+#include "OpenStreetMap.h"
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+static std::shared_ptr<COpenStreetMap> LoadMap(const std::string &osm){
+    return std::make_shared<COpenStreetMap>(std::make_shared<CXMLReader>(std::make_shared<CStringDataSource>(osm)));
+}
+
+static std::shared_ptr<COpenStreetMap> LoadDavis(){
+    std::ifstream Input("data/davis.osm");
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    return LoadMap(Buffer.str());
+}
+
+// Random query points in and around the map
+static std::vector<CStreetMap::TLocation> QueryLocations(const CStreetMap &map, std::size_t count){
+    std::mt19937 Generator(34);
+    std::uniform_int_distribution<std::size_t> NodeDistribution(0, map.NodeCount() - 1);
+    std::uniform_real_distribution<double> Offset(-0.02, 0.02);
+    std::vector<CStreetMap::TLocation> Locations;
+    for(std::size_t Index = 0; Index < count; Index++){
+        auto Location = map.NodeByIndex(NodeDistribution(Generator))->Location();
+        Locations.emplace_back(Location.first + Offset(Generator), Location.second + Offset(Generator));
+    }
+    return Locations;
+}
+
+static std::vector<double> Distances(const CStreetMap &map, const CStreetMap::TLocation &location, const std::vector<std::size_t> &indices){
+    std::vector<double> Result;
+    for(auto Index : indices){
+        Result.push_back(GeographicUtils::HaversineDistance(location, map.NodeByIndex(Index)->Location()));
+    }
+    return Result;
+}
+
+TEST(StreetMapIndex, NearestTest){
+    auto Map = LoadDavis();
+    CStreetMapIndex Index(Map);
+
+    ASSERT_EQ(Index.NodeCount(), Map->NodeCount());
+    std::vector<std::size_t> All(Map->NodeCount());
+    for(std::size_t NodeIndex = 0; NodeIndex < All.size(); NodeIndex++){
+        All[NodeIndex] = NodeIndex;
+    }
+    for(auto &Location : QueryLocations(*Map, 50)){
+        auto Expected = Distances(*Map, Location, All);
+        std::sort(Expected.begin(), Expected.end());
+        Expected.resize(8);
+        auto Nearest = Index.Nearest(Location, 8);
+        ASSERT_EQ(Nearest.size(), 8);
+        EXPECT_EQ(Distances(*Map, Location, Nearest), Expected);
+    }
+    auto Node = Map->NodeByIndex(100);
+    auto Nearest = Index.Nearest(Node->Location());
+    ASSERT_EQ(Nearest.size(), 1);
+    EXPECT_EQ(Map->NodeByIndex(Nearest[0])->Location(), Node->Location());
+    EXPECT_TRUE(Index.Nearest(Node->Location(), 0).empty());
+    EXPECT_EQ(Index.Nearest(Node->Location(), Map->NodeCount() + 10).size(), Map->NodeCount());
+}
+
+TEST(StreetMapIndex, RadiusAndBoundsTest){
+    auto Map = LoadDavis();
+    CStreetMapIndex Index(Map, 4);
+
+    for(auto &Location : QueryLocations(*Map, 20)){
+        std::vector<std::size_t> ExpectedRadius, ExpectedBounds;
+        CStreetMap::TLocation LowerLeft(Location.first - 0.005, Location.second - 0.01);
+        CStreetMap::TLocation UpperRight(Location.first + 0.005, Location.second + 0.01);
+        for(std::size_t NodeIndex = 0; NodeIndex < Map->NodeCount(); NodeIndex++){
+            auto NodeLocation = Map->NodeByIndex(NodeIndex)->Location();
+            if(GeographicUtils::HaversineDistance(Location, NodeLocation) <= 500.0){
+                ExpectedRadius.push_back(NodeIndex);
+            }
+            if((LowerLeft.first <= NodeLocation.first) && (NodeLocation.first <= UpperRight.first) && (LowerLeft.second <= NodeLocation.second) && (NodeLocation.second <= UpperRight.second)){
+                ExpectedBounds.push_back(NodeIndex);
+            }
+        }
+        EXPECT_EQ(Index.WithinRadius(Location, 500.0), ExpectedRadius);
+        EXPECT_EQ(Index.WithinBounds(LowerLeft, UpperRight), ExpectedBounds);
+    }
+    EXPECT_TRUE(Index.WithinBounds({1.0, 1.0}, {0.0, 0.0}).empty());
+    EXPECT_TRUE(Index.WithinRadius({0.0, 0.0}, 1000.0).empty());
+}
+
+TEST(StreetMapIndex, NearestBatchTest){
+    auto Map = LoadDavis();
+    CStreetMapIndex Index(Map);
+    auto Locations = QueryLocations(*Map, 200);
+
+    for(std::size_t ThreadCount : {1, 4, 0}){
+        auto Results = Index.NearestBatch(Locations, 3, ThreadCount);
+        ASSERT_EQ(Results.size(), Locations.size());
+        for(std::size_t QueryIndex = 0; QueryIndex < Locations.size(); QueryIndex++){
+            EXPECT_EQ(Results[QueryIndex], Index.Nearest(Locations[QueryIndex], 3));
+        }
+    }
+    EXPECT_TRUE(Index.NearestBatch({}, 3).empty());
+}
+
+TEST(StreetMapIndex, SmallMapTest){
+    CStreetMapIndex Empty(LoadMap("<osm></osm>"));
+    EXPECT_EQ(Empty.NodeCount(), 0);
+    EXPECT_TRUE(Empty.Nearest({0.0, 0.0}, 3).empty());
+    EXPECT_TRUE(Empty.WithinRadius({0.0, 0.0}, 10.0).empty());
+    EXPECT_TRUE(Empty.WithinBounds({-90.0, -180.0}, {90.0, 180.0}).empty());
+
+    CStreetMapIndex Single(LoadMap("<osm><node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/></osm>"));
+    EXPECT_EQ(Single.Nearest({0.0, 0.0}, 3), std::vector<std::size_t>{0});
+    EXPECT_EQ(Single.WithinBounds({-90.0, -180.0}, {90.0, 180.0}), std::vector<std::size_t>{0});
+
+    // ties are broken by index, duplicates included
+    CStreetMapIndex Ties(LoadMap("<osm><node id=\"1\" lat=\"1\" lon=\"1\"/><node id=\"2\" lat=\"0\" lon=\"0\"/>"
+                                 "<node id=\"3\" lat=\"1\" lon=\"1\"/><node id=\"4\" lat=\"-1\" lon=\"-1\"/></osm>"), 2);
+    EXPECT_EQ(Ties.Nearest({1.0, 1.0}, 3), std::vector<std::size_t>({0, 2, 1}));
+    EXPECT_EQ(Ties.WithinRadius({0.0, 0.0}, 200000.0), std::vector<std::size_t>({0, 1, 2, 3}));
+}
@@ -30,3 +30,60 @@ TEST(StringDataSink, WriteTest){
     EXPECT_TRUE(Sink.Write(TempVector2));
     EXPECT_EQ(Sink.String(),"Hello World");   
 }
+
+TEST(StringDataSink, ReserveTest){
+    CStringDataSink Sink;
+    Sink.Reserve(1000);
+    const char *Data = Sink.String().data();
+    for(int Index = 0; Index < 1000; Index++){
+        EXPECT_TRUE(Sink.Put('a' + Index % 26));
+    }
+    // everything fit in the reserved space
+    EXPECT_EQ(Sink.String().data(), Data);
+    EXPECT_EQ(Sink.Size(), 1000);
+    EXPECT_EQ(Sink.String().substr(0, 3), "abc");
+}
+
+TEST(StringDataSink, BulkWriteTest){
+    CStringDataSink Sink;
+    EXPECT_TRUE(Sink.Write("Hello", 5));
+    EXPECT_TRUE(Sink.Write(" World", 6));
+    EXPECT_TRUE(Sink.Write("", 0));
+    EXPECT_EQ(Sink.String(), "Hello World");
+    ASSERT_EQ(Sink.Chunks().size(), 1);
+    EXPECT_EQ(Sink.Chunks()[0], "Hello World");
+}
+
+TEST(StringDataSink, ChunkedTest){
+    CStringDataSink Sink(CStringDataSink::EMode::Chunked, 4);
+    EXPECT_TRUE(Sink.String().empty());
+    EXPECT_TRUE(Sink.Chunks().empty());
+
+    EXPECT_TRUE(Sink.Put('H'));
+    EXPECT_TRUE(Sink.Write(std::vector<char>{'e', 'l', 'l', 'o', ' ', 'W'}));
+    EXPECT_EQ(Sink.String(), "Hello W");
+    EXPECT_TRUE(Sink.Write("orld", 4));
+    EXPECT_EQ(Sink.Size(), 11);
+    EXPECT_EQ(Sink.String(), "Hello World");
+
+    auto Chunks = Sink.Chunks();
+    ASSERT_EQ(Chunks.size(), 3);
+    EXPECT_EQ(Chunks[0], "Hell");
+    EXPECT_EQ(Chunks[1], "o Wo");
+    EXPECT_EQ(Chunks[2], "rld");
+}
+
+TEST(StringDataSink, ChunksDoNotMoveTest){
+    CStringDataSink Sink(CStringDataSink::EMode::Chunked, 1024);
+    Sink.Reserve(1 << 20);
+    std::string Block(1000, 'x');
+    EXPECT_TRUE(Sink.Write(Block.data(), Block.size()));
+    const char *First = Sink.Chunks()[0].data();
+    for(int Index = 0; Index < 1000; Index++){
+        EXPECT_TRUE(Sink.Write(Block.data(), Block.size()));
+    }
+    // filled chunks are never copied again as the output grows
+    EXPECT_EQ(Sink.Chunks()[0].data(), First);
+    EXPECT_EQ(Sink.Size(), 1001000);
+    EXPECT_EQ(Sink.String(), std::string(1001000, 'x'));
+}
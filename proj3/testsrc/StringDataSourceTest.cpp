@@ -81,3 +81,22 @@ TEST(StringDataSource, ReadTest){
     EXPECT_FALSE(Source2.Peek(TempCh));
     EXPECT_EQ(TempCh,'x');
 }
+
+TEST(StringDataSource, ViewTest){
+    CStringDataSource Source("Hello World");
+    const char *Data = nullptr;
+    std::size_t Size = 0;
+    char TempCh = 'x';
+
+    ASSERT_TRUE(Source.View(Data,Size));
+    EXPECT_EQ(std::string(Data,Size),"Hello World");
+    EXPECT_EQ(Source.Skip(6),6);
+    EXPECT_TRUE(Source.Peek(TempCh));
+    EXPECT_EQ(TempCh,'W');
+    ASSERT_TRUE(Source.View(Data,Size));
+    EXPECT_EQ(std::string(Data,Size),"World");
+    EXPECT_EQ(Source.Skip(10),5);
+    EXPECT_TRUE(Source.End());
+    ASSERT_TRUE(Source.View(Data,Size));
+    EXPECT_EQ(Size,0);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "XMLReader.h"
+#include "StringDataSource.h"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+// Every allocation in this binary goes through here so the reader's steady
+// state can be checked, which is why this test has an executable of its own
+static std::atomic<std::size_t> AllocationCount(0);
+
+void *operator new(std::size_t size){
+    AllocationCount++;
+    if(void *Pointer = std::malloc(size ? size : 1)){
+        return Pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept{
+    std::free(pointer);
+}
+
+static std::string LoadFile(const std::string &path){
+    std::ifstream Input(path);
+    std::stringstream Buffer;
+    Buffer << Input.rdbuf();
+    return Buffer.str();
+}
+
+// Counts the events without keeping anything
+class CCountingHandler : public CXMLReader::SHandler{
+    public:
+        std::size_t Events = 0;
+
+        void StartElement(const char *name, const char **attributes) override{
+            Events++;
+        }
+
+        void EndElement(const char *name) override{
+            Events++;
+        }
+};
+
+TEST(XMLAllocationTest, ReadEntitySteadyState){
+    auto OSM = LoadFile("data/davis.osm");
+    for(bool SkipCharacterData : {true, false}){
+        CXMLReader Reader(std::make_shared<CStringDataSource>(OSM));
+        SXMLEntity Entity;
+        std::size_t Entities = 0;
+
+        // warm up the ring slots and expat's buffers first
+        while((Entities < 20000) && Reader.ReadEntity(Entity, SkipCharacterData)){
+            Entities++;
+        }
+        std::size_t Before = AllocationCount;
+        std::size_t Counted = 0;
+        while(Reader.ReadEntity(Entity, SkipCharacterData)){
+            Counted++;
+        }
+        std::size_t Allocations = AllocationCount - Before;
+        EXPECT_GT(Counted, 20000);
+        // only strings too long for the small string buffer can still allocate
+        EXPECT_LT(Allocations, Counted / 100);
+    }
+}
+
+TEST(XMLAllocationTest, ParseSteadyState){
+    auto OSM = LoadFile("data/davis.osm");
+    auto Source = std::make_shared<CStringDataSource>(OSM);
+    CXMLReader Reader(Source);
+    SXMLEntity Entity;
+    CCountingHandler Handler;
+
+    ASSERT_TRUE(Reader.ReadEntity(Entity));
+    std::size_t Before = AllocationCount;
+    EXPECT_TRUE(Reader.Parse(Handler));
+    EXPECT_GT(Handler.Events, 50000);
+    EXPECT_LT(AllocationCount - Before, 16);
+}
@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include "XMLAtomTable.h"
+#include <string>
+
+TEST(XMLAtomTableTest, EmptyTable){
+    CXMLAtomTable Table;
+    EXPECT_EQ(Table.AtomCount(), 0);
+    EXPECT_EQ(Table.Find("node"), SXMLEntity::InvalidAtom);
+    EXPECT_EQ(Table.Name(SXMLEntity::InvalidAtom), "");
+    EXPECT_EQ(Table.Name(1), "");
+}
+
+TEST(XMLAtomTableTest, InternIsStable){
+    CXMLAtomTable Table;
+    auto Node = Table.Intern("node");
+    auto Way = Table.Intern("way");
+    EXPECT_NE(Node, SXMLEntity::InvalidAtom);
+    EXPECT_NE(Node, Way);
+    EXPECT_EQ(Table.Intern("node"), Node);
+    EXPECT_EQ(Table.Find("way"), Way);
+    EXPECT_EQ(Table.AtomCount(), 2);
+
+    // names handed out earlier stay valid while the table grows
+    auto Name = Table.Name(Node);
+    for(int Index = 0; Index < 1000; Index++){
+        Table.Intern("name" + std::to_string(Index));
+    }
+    EXPECT_EQ(Name, "node");
+    EXPECT_EQ(Table.Name(Way), "way");
+    EXPECT_EQ(Table.Find("name999"), Table.Intern("name999"));
+    EXPECT_EQ(Table.AtomCount(), 1002);
+}
+
+TEST(XMLAtomTableTest, EmptyName){
+    CXMLAtomTable Table;
+    auto Empty = Table.Intern("");
+    EXPECT_NE(Empty, SXMLEntity::InvalidAtom);
+    EXPECT_EQ(Table.Name(Empty), "");
+    EXPECT_EQ(Table.Find(""), Empty);
+}
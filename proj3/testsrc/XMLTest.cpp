@@ -2,6 +2,10 @@
 #include "XMLWriter.h"
 #include "XMLEntity.h"
 #include "StringDataSink.h"
+#include "XMLReader.h"
+#include "XMLAtomTable.h"
+#include "StringDataSource.h"
+#include <vector>
 #include <memory>
 #include <string>
 
@@ -158,3 +162,347 @@ TEST_F(XMLWriterTest, AutoClosingTags) {
     
     EXPECT_EQ(DataSink->String(), "<parent><child></child></parent>");
 }
+
+// Sink that records how it was called, optionally failing every write
+class CCountingDataSink : public CDataSink {
+    public:
+        std::string DString;
+        std::size_t DPuts = 0;
+        std::size_t DWrites = 0;
+        bool DFail = false;
+
+        bool Put(const char &ch) noexcept override {
+            DPuts++;
+            DString += ch;
+            return !DFail;
+        }
+
+        bool Write(const std::vector<char> &buf) noexcept override {
+            DWrites++;
+            DString.append(buf.data(), buf.size());
+            return !DFail;
+        }
+};
+
+static SXMLEntity MakeEntity(SXMLEntity::EType type, const std::string &name, const std::vector<SXMLEntity::TAttribute> &attributes = {}) {
+    SXMLEntity Entity;
+    Entity.DType = type;
+    Entity.DNameData = name;
+    Entity.DAttributes = attributes;
+    return Entity;
+}
+
+TEST(XMLWriterBufferTest, WritesInBlocks) {
+    auto Sink = std::make_shared<CCountingDataSink>();
+    std::string Expected;
+    {
+        CXMLWriter Writer(Sink, 64);
+        for (int Index = 0; Index < 100; Index++) {
+            EXPECT_TRUE(Writer.WriteEntity(MakeEntity(SXMLEntity::EType::CompleteElement, "nd", {{"ref", std::to_string(Index)}, {"note", "a<b & 'c'"}})));
+            Expected += "<nd ref=\"" + std::to_string(Index) + "\" note=\"a&lt;b &amp; &apos;c&apos;\"/>";
+        }
+        // nothing is held back by more than one buffer
+        EXPECT_GE(Sink->DString.size() + 128, Expected.size());
+        EXPECT_TRUE(Writer.Flush());
+        EXPECT_EQ(Sink->DString, Expected);
+    }
+    EXPECT_EQ(Sink->DPuts, 0);
+    EXPECT_LT(Sink->DWrites, Expected.size() / 32);
+}
+
+TEST(XMLWriterBufferTest, DestructorWritesBuffer) {
+    auto Sink = std::make_shared<CCountingDataSink>();
+    {
+        CXMLWriter Writer(Sink);
+        EXPECT_TRUE(Writer.WriteEntity(MakeEntity(SXMLEntity::EType::StartElement, "osm")));
+        EXPECT_TRUE(Writer.WriteEntity(MakeEntity(SXMLEntity::EType::CharData, "\"quoted\" text > 1")));
+        EXPECT_EQ(Sink->DString, "");
+    }
+    // the open element is left open, only the buffered output goes out
+    EXPECT_EQ(Sink->DString, "<osm>&quot;quoted&quot; text &gt; 1");
+    EXPECT_EQ(Sink->DWrites, 1);
+}
+
+TEST(XMLWriterBufferTest, FailingSink) {
+    auto Sink = std::make_shared<CCountingDataSink>();
+    Sink->DFail = true;
+    CXMLWriter Writer(Sink, 16);
+    EXPECT_TRUE(Writer.WriteEntity(MakeEntity(SXMLEntity::EType::StartElement, "a")));
+    EXPECT_FALSE(Writer.WriteEntity(MakeEntity(SXMLEntity::EType::CharData, "more than sixteen bytes of text")));
+
+    CXMLWriter Small(Sink);
+    EXPECT_TRUE(Small.WriteEntity(MakeEntity(SXMLEntity::EType::StartElement, "a")));
+    EXPECT_FALSE(Small.Flush());
+}
+
+// Source without a contiguous view so the reader has to go through Read
+class CBlockOnlyDataSource : public CDataSource {
+    private:
+        CStringDataSource DSource;
+    public:
+        CBlockOnlyDataSource(const std::string &str) : DSource(str) {}
+
+        bool End() const noexcept override { return DSource.End(); }
+        bool Get(char &ch) noexcept override { return DSource.Get(ch); }
+        bool Peek(char &ch) noexcept override { return DSource.Peek(ch); }
+        bool Read(std::vector<char> &buf, std::size_t count) noexcept override { return DSource.Read(buf, count); }
+};
+
+static const std::string ReaderDocument =
+    "<osm version=\"0.6\">\n"
+    "  <node id=\"1\" lat=\"38.5\" lon=\"-121.7\"/>\n"
+    "  <way id=\"2\"><nd ref=\"1\"/><tag k=\"name\" v=\"A &amp; B\"/></way>\n"
+    "  <note>Hello World</note>\n"
+    "</osm>\n";
+
+static std::vector<SXMLEntity> ReadAll(CXMLReader &reader, bool skipcdata) {
+    std::vector<SXMLEntity> Entities;
+    SXMLEntity Entity;
+    while (reader.ReadEntity(Entity, skipcdata)) {
+        Entities.push_back(Entity);
+    }
+    return Entities;
+}
+
+static bool SameEntities(const std::vector<SXMLEntity> &left, const std::vector<SXMLEntity> &right) {
+    if (left.size() != right.size()) {
+        return false;
+    }
+    for (std::size_t Index = 0; Index < left.size(); Index++) {
+        if ((left[Index].DType != right[Index].DType) || (left[Index].DNameData != right[Index].DNameData) || (left[Index].DAttributes != right[Index].DAttributes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(XMLReaderTest, ReadElements) {
+    CXMLReader Reader(std::make_shared<CStringDataSource>(ReaderDocument));
+    auto Entities = ReadAll(Reader, true);
+
+    ASSERT_EQ(Entities.size(), 12);
+    EXPECT_EQ(Entities[0].DType, SXMLEntity::EType::StartElement);
+    EXPECT_EQ(Entities[0].DNameData, "osm");
+    EXPECT_EQ(Entities[0].AttributeValue("version"), "0.6");
+    EXPECT_EQ(Entities[1].DNameData, "node");
+    EXPECT_EQ(Entities[1].AttributeValue("lat"), "38.5");
+    EXPECT_EQ(Entities[2].DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entities[2].DNameData, "node");
+    EXPECT_EQ(Entities[6].DNameData, "tag");
+    EXPECT_EQ(Entities[6].AttributeValue("v"), "A & B");
+    EXPECT_EQ(Entities[11].DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entities[11].DNameData, "osm");
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(XMLReaderTest, ReadCharacterData) {
+    CXMLReader Reader(std::make_shared<CStringDataSource>("<note>Hello World</note>"));
+    SXMLEntity Entity;
+
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::CharData);
+    EXPECT_EQ(Entity.DNameData, "Hello World");
+    EXPECT_TRUE(Reader.ReadEntity(Entity));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_FALSE(Reader.ReadEntity(Entity));
+    EXPECT_TRUE(Reader.End());
+}
+
+TEST(XMLReaderTest, ChunkSizes) {
+    CXMLReader Reference(std::make_shared<CStringDataSource>(ReaderDocument));
+    auto Expected = ReadAll(Reference, false);
+
+    for (std::size_t ChunkSize : {1, 3, 7, 64, 4096}) {
+        CXMLReader ViewReader(std::make_shared<CStringDataSource>(ReaderDocument), ChunkSize);
+        EXPECT_TRUE(SameEntities(ReadAll(ViewReader, false), Expected));
+        CXMLReader BlockReader(std::make_shared<CBlockOnlyDataSource>(ReaderDocument), ChunkSize);
+        EXPECT_TRUE(SameEntities(ReadAll(BlockReader, false), Expected));
+    }
+}
+
+TEST(XMLReaderTest, MalformedInput) {
+    CXMLReader Reader(std::make_shared<CBlockOnlyDataSource>("<a><b></a>"));
+    SXMLEntity Entity;
+    int Count = 0;
+
+    // the parse error must stop the reader before the bogus end tag is reported
+    while (Reader.ReadEntity(Entity) && (Count < 8)) {
+        EXPECT_EQ(Entity.DType, SXMLEntity::EType::StartElement);
+        Count++;
+    }
+    EXPECT_LE(Count, 2);
+}
+
+// Rebuilds entities from the handler events so they can be compared to ReadEntity
+class CEntityHandler : public CXMLReader::SHandler {
+    public:
+        std::vector<SXMLEntity> Entities;
+
+        void StartElement(const char *name, const char **attributes) override {
+            SXMLEntity Entity;
+            Entity.DType = SXMLEntity::EType::StartElement;
+            Entity.DNameData = name;
+            for (int Index = 0; attributes[Index]; Index += 2) {
+                Entity.DAttributes.emplace_back(attributes[Index], attributes[Index + 1]);
+            }
+            Entities.push_back(Entity);
+        }
+
+        void EndElement(const char *name) override {
+            SXMLEntity Entity;
+            Entity.DType = SXMLEntity::EType::EndElement;
+            Entity.DNameData = name;
+            Entities.push_back(Entity);
+        }
+
+        void CharacterData(const char *data, std::size_t length) override {
+            // the pieces of one run of text are joined like ReadEntity does
+            if (Entities.empty() || (Entities.back().DType != SXMLEntity::EType::CharData)) {
+                Entities.emplace_back();
+                Entities.back().DType = SXMLEntity::EType::CharData;
+            }
+            Entities.back().DNameData.append(data, length);
+        }
+};
+
+TEST(XMLReaderTest, ParseHandler) {
+    CXMLReader Reference(std::make_shared<CStringDataSource>(ReaderDocument));
+    auto Expected = ReadAll(Reference, false);
+
+    for (std::size_t ChunkSize : {1, 5, 4096}) {
+        CEntityHandler ViewHandler, BlockHandler;
+        CXMLReader ViewReader(std::make_shared<CStringDataSource>(ReaderDocument), ChunkSize);
+        EXPECT_TRUE(ViewReader.Parse(ViewHandler));
+        EXPECT_TRUE(SameEntities(ViewHandler.Entities, Expected));
+        EXPECT_TRUE(ViewReader.End());
+        CXMLReader BlockReader(std::make_shared<CBlockOnlyDataSource>(ReaderDocument), ChunkSize);
+        EXPECT_TRUE(BlockReader.Parse(BlockHandler));
+        EXPECT_TRUE(SameEntities(BlockHandler.Entities, Expected));
+    }
+}
+
+TEST(XMLReaderTest, ParseAfterReadEntity) {
+    CXMLReader Reference(std::make_shared<CStringDataSource>(ReaderDocument));
+    auto Expected = ReadAll(Reference, false);
+
+    // entities the reader already buffered are handed over before the rest
+    for (std::size_t ChunkSize : {1, 4096}) {
+        CXMLReader Reader(std::make_shared<CStringDataSource>(ReaderDocument), ChunkSize);
+        CEntityHandler Handler;
+        SXMLEntity Entity;
+        ASSERT_TRUE(Reader.ReadEntity(Entity));
+        ASSERT_TRUE(Reader.ReadEntity(Entity));
+        EXPECT_TRUE(Reader.Parse(Handler));
+        Handler.Entities.insert(Handler.Entities.begin(), Expected.begin(), Expected.begin() + 2);
+        EXPECT_TRUE(SameEntities(Handler.Entities, Expected));
+        EXPECT_FALSE(Reader.ReadEntity(Entity));
+    }
+}
+
+TEST(XMLReaderTest, ParseMalformed) {
+    CEntityHandler Handler;
+    CXMLReader Reader(std::make_shared<CStringDataSource>("<a><b></a>"));
+    EXPECT_FALSE(Reader.Parse(Handler));
+    EXPECT_LE(Handler.Entities.size(), 2);
+
+    CEntityHandler TruncatedHandler;
+    CXMLReader Truncated(std::make_shared<CStringDataSource>("<a><b></b>"));
+    EXPECT_FALSE(Truncated.Parse(TruncatedHandler));
+    EXPECT_EQ(TruncatedHandler.Entities.size(), 3);
+}
+
+TEST(XMLReaderTest, ElementFilter) {
+    // the way's tag is skipped with the way, the root is entered but not emitted
+    for (std::size_t ChunkSize : {1, 4096}) {
+        CXMLReader Reader(std::make_shared<CStringDataSource>("<osm><node id=\"1\"><tag k=\"a\" v=\"b\"/></node><way id=\"2\"><nd ref=\"1\"/><tag k=\"c\" v=\"d\"/></way><node id=\"3\"/></osm>"), ChunkSize);
+        Reader.SetElementFilter({"node", "tag"});
+        auto Entities = ReadAll(Reader, false);
+
+        ASSERT_EQ(Entities.size(), 6);
+        EXPECT_EQ(Entities[0].DNameData, "node");
+        EXPECT_EQ(Entities[0].AttributeValue("id"), "1");
+        EXPECT_EQ(Entities[1].DNameData, "tag");
+        EXPECT_EQ(Entities[1].AttributeValue("v"), "b");
+        EXPECT_EQ(Entities[2].DType, SXMLEntity::EType::EndElement);
+        EXPECT_EQ(Entities[2].DNameData, "tag");
+        EXPECT_EQ(Entities[3].DType, SXMLEntity::EType::EndElement);
+        EXPECT_EQ(Entities[3].DNameData, "node");
+        EXPECT_EQ(Entities[4].DNameData, "node");
+        EXPECT_EQ(Entities[4].AttributeValue("id"), "3");
+        EXPECT_EQ(Entities[5].DType, SXMLEntity::EType::EndElement);
+        EXPECT_TRUE(Reader.End());
+    }
+}
+
+TEST(XMLReaderTest, ElementFilterCharacterData) {
+    CXMLReader Reader(std::make_shared<CStringDataSource>("<a>x<b>y<c>z</c></b><d>w</d></a>"));
+    Reader.SetElementFilter({"a", "d"});
+    auto Entities = ReadAll(Reader, false);
+
+    ASSERT_EQ(Entities.size(), 6);
+    EXPECT_EQ(Entities[0].DNameData, "a");
+    EXPECT_EQ(Entities[1].DNameData, "x");
+    EXPECT_EQ(Entities[2].DNameData, "d");
+    EXPECT_EQ(Entities[3].DNameData, "w");
+    EXPECT_EQ(Entities[4].DNameData, "d");
+    EXPECT_EQ(Entities[5].DNameData, "a");
+}
+
+TEST(XMLReaderTest, ElementFilterParse) {
+    CXMLReader Reference(std::make_shared<CStringDataSource>(ReaderDocument));
+    Reference.SetElementFilter({"way", "nd", "tag"});
+    auto Expected = ReadAll(Reference, false);
+    std::vector<std::string> Names;
+    for (auto &Entity : Expected) {
+        if (Entity.DType == SXMLEntity::EType::StartElement) {
+            Names.push_back(Entity.DNameData);
+        }
+    }
+    EXPECT_EQ(Names, std::vector<std::string>({"way", "nd", "tag"}));
+
+    CXMLReader Reader(std::make_shared<CStringDataSource>(ReaderDocument));
+    CEntityHandler Handler;
+    Reader.SetElementFilter({"way", "nd", "tag"});
+    EXPECT_TRUE(Reader.Parse(Handler));
+    EXPECT_TRUE(SameEntities(Handler.Entities, Expected));
+
+    // clearing the filter emits everything again
+    CXMLReader Cleared(std::make_shared<CStringDataSource>(ReaderDocument));
+    Cleared.SetElementFilter({"way"});
+    Cleared.SetElementFilter({});
+    EXPECT_EQ(ReadAll(Cleared, true).size(), 12);
+}
+
+TEST(XMLReaderTest, AtomTable) {
+    auto Atoms = std::make_shared<CXMLAtomTable>();
+    auto Node = Atoms->Intern("node");
+    CXMLReader Reader(std::make_shared<CStringDataSource>(ReaderDocument));
+    Reader.SetAtomTable(Atoms);
+    EXPECT_EQ(Reader.AtomTable(), Atoms);
+    SXMLEntity Entity;
+
+    ASSERT_TRUE(Reader.ReadEntity(Entity, true));
+    EXPECT_EQ(Atoms->Name(Entity.DNameAtom), "osm");
+    ASSERT_TRUE(Reader.ReadEntity(Entity, true));
+    EXPECT_EQ(Entity.DNameAtom, Node);
+    ASSERT_EQ(Entity.DAttributeAtoms.size(), Entity.DAttributes.size());
+    for (std::size_t Index = 0; Index < Entity.DAttributes.size(); Index++) {
+        EXPECT_EQ(Atoms->Name(Entity.DAttributeAtoms[Index]), Entity.DAttributes[Index].first);
+    }
+    EXPECT_EQ(Entity.AttributeValue(Atoms->Find("lat")), "38.5");
+    EXPECT_TRUE(Entity.AttributeExists(Atoms->Find("id")));
+    EXPECT_FALSE(Entity.AttributeExists(Atoms->Intern("ref")));
+    ASSERT_TRUE(Reader.ReadEntity(Entity, true));
+    EXPECT_EQ(Entity.DType, SXMLEntity::EType::EndElement);
+    EXPECT_EQ(Entity.DNameAtom, Node);
+
+    // turning the table off leaves the atoms unset
+    Reader.SetAtomTable(nullptr);
+    CXMLReader Plain(std::make_shared<CStringDataSource>(ReaderDocument));
+    for (auto &Entity : ReadAll(Plain, false)) {
+        EXPECT_EQ(Entity.DNameAtom, SXMLEntity::InvalidAtom);
+        EXPECT_TRUE(Entity.DAttributeAtoms.empty());
+    }
+}